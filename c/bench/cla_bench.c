@@ -0,0 +1,213 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include "bp_sdk.h"
+
+#define LATENCY_ROUNDS 10000
+
+static uint64_t received = 0;
+static uint64_t pongs = 0;
+static int echoing = 0;
+
+// Protocol each transport's receiving side is registered under, and where its echoes go
+static char echo_protocols[2][32];
+static const char *echo_dests[2];
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void sleep_us(long usec) {
+    struct timespec ts = { usec / 1000000, (usec % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+// The receiving CLA's context is its transport index; echoes go back through it synchronously
+static int echo_receive(void *data, size_t len, char *source, void *context) {
+    (void)source;
+    __atomic_fetch_add(&received, 1, __ATOMIC_RELAXED);
+    if (!__atomic_load_n(&echoing, __ATOMIC_ACQUIRE)) return 0;
+
+    int index = (int)(intptr_t)context;
+    return bp_cla_send(echo_protocols[index], echo_dests[index], data, len);
+}
+
+static int count_pong(void *data, size_t len, char *source, void *context) {
+    (void)data; (void)len; (void)source; (void)context;
+    __atomic_fetch_add(&pongs, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// Waits until the receiver has gone quiet, so the count is not cut short by in-flight bundles
+static uint64_t settle_received(void) {
+    uint64_t last = (uint64_t)-1;
+    uint64_t current = __atomic_load_n(&received, __ATOMIC_RELAXED);
+    while (current != last) {
+        last = current;
+        sleep_us(100000);
+        current = __atomic_load_n(&received, __ATOMIC_RELAXED);
+    }
+    return current;
+}
+
+static int bench_throughput(const char *protocol, const char *dest, size_t payload_len, int iterations) {
+    char *payload = malloc(payload_len);
+    if (!payload) return 1;
+    memset(payload, 'x', payload_len);
+
+    __atomic_store_n(&received, 0, __ATOMIC_RELAXED);
+    int failures = 0;
+    double start = now_seconds();
+
+    for (int i = 0; i < iterations; i++) {
+        if (bp_cla_send(protocol, dest, payload, payload_len) != BP_SUCCESS) failures++;
+    }
+
+    // Sends only enqueue, so the clock stops once the sender thread has drained the ring
+    bp_cla_queue_stats_t queue;
+    while (bp_cla_queue_stats(protocol, &queue) == BP_SUCCESS && queue.depth > 0) sleep_us(100);
+
+    double elapsed = now_seconds() - start;
+    uint64_t delivered = settle_received();
+
+    printf("%s %6zu bytes: %8d sends in %.3fs = %10.0f sends/s %8.1f MB/s, %llu received, queue high-water %u (%d failed)\n",
+           protocol, payload_len, iterations, elapsed, iterations / elapsed, iterations * payload_len / elapsed / 1e6,
+           (unsigned long long)delivered, queue.high_watermark, failures);
+
+    free(payload);
+    return failures > 0;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+// One bundle in flight at a time: send, wait for the echo, repeat
+static int bench_latency(const char *protocol, const char *dest, size_t payload_len) {
+    char payload[1024];
+    double *rtt = malloc(LATENCY_ROUNDS * sizeof(double));
+    if (!rtt || payload_len > sizeof(payload)) {
+        free(rtt);
+        return 1;
+    }
+    memset(payload, 'l', payload_len);
+
+    __atomic_store_n(&echoing, 1, __ATOMIC_RELEASE);
+    int lost = 0;
+    for (int i = 0; i < LATENCY_ROUNDS; i++) {
+        uint64_t expected = __atomic_load_n(&pongs, __ATOMIC_ACQUIRE) + 1;
+        double start = now_seconds();
+        bp_cla_send(protocol, dest, payload, payload_len);
+
+        while (__atomic_load_n(&pongs, __ATOMIC_ACQUIRE) < expected) {
+            if (now_seconds() - start > 1.0) {
+                lost++;
+                break;
+            }
+            // Yielding rather than spinning keeps the measurement honest on hosts with few cores
+            sched_yield();
+        }
+        rtt[i] = (now_seconds() - start) * 1e6;
+    }
+    __atomic_store_n(&echoing, 0, __ATOMIC_RELEASE);
+
+    qsort(rtt, LATENCY_ROUNDS, sizeof(double), compare_doubles);
+    printf("%s %6zu bytes: round trip p50 %7.1f us, p99 %7.1f us, p99.9 %7.1f us (%d lost)\n",
+           protocol, payload_len, rtt[LATENCY_ROUNDS / 2], rtt[LATENCY_ROUNDS * 99 / 100],
+           rtt[LATENCY_ROUNDS * 999 / 1000], lost);
+
+    free(rtt);
+    return lost > 0;
+}
+
+// The receiver is registered under its own name, unqueued so an echo leaves on its receive thread
+static int run_transport(const char *protocol, bp_cla_t *sender, bp_cla_t *receiver, int index, const char *dest,
+                         int iterations) {
+    snprintf(echo_protocols[index], sizeof(echo_protocols[index]), "%s-echo", protocol);
+    char *echo_protocol = strdup(echo_protocols[index]);
+    if (!echo_protocol) return 1;
+    free(receiver->protocol_name);
+    receiver->protocol_name = echo_protocol;
+    receiver->queue_depth = 0;
+
+    sender->receive_callback = count_pong;
+    receiver->receive_callback = echo_receive;
+    receiver->context = (void*)(intptr_t)index;
+
+    int result = bp_cla_register(sender);
+    if (result == BP_SUCCESS) {
+        result = bp_cla_register(receiver);
+        if (result != BP_SUCCESS) bp_cla_unregister(protocol);
+    }
+    if (result != BP_SUCCESS) {
+        printf("Failed to register %s CLAs: %s\n", protocol, bp_strerror(result));
+        return 1;
+    }
+
+    int failed = 0;
+    failed |= bench_throughput(protocol, dest, 64, iterations);
+    failed |= bench_throughput(protocol, dest, 1024, iterations);
+    failed |= bench_throughput(protocol, dest, 1472, iterations);
+    failed |= bench_latency(protocol, dest, 64);
+    failed |= bench_latency(protocol, dest, 1024);
+
+    bp_cla_unregister(protocol);
+    bp_cla_unregister(echo_protocols[index]);
+    return failed;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--help") == 0) {
+        printf("BP-SDK CLA Benchmark\n");
+        printf("Usage: %s [port] [iterations]\n", argv[0]);
+        printf("\nCompares the built-in UDP CLA over loopback (port and port + 1) with the shared-memory CLA,\n");
+        printf("for throughput and for round-trip latency with one bundle in flight.\n");
+        return 0;
+    }
+
+    uint16_t port = argc > 1 ? (uint16_t)atoi(argv[1]) : 4556;
+    int iterations = argc > 2 ? atoi(argv[2]) : 200000;
+
+    int result = bp_init("ipn:1.1", NULL);
+    if (result != BP_SUCCESS) {
+        printf("Failed to initialize: %s\n", bp_strerror(result));
+        return 1;
+    }
+
+    bp_cla_t *udp_sender, *udp_receiver, *shm_sender, *shm_receiver;
+    if (bp_cla_create_udp("127.0.0.1", port, &udp_sender) != BP_SUCCESS ||
+        bp_cla_create_udp("127.0.0.1", port + 1, &udp_receiver) != BP_SUCCESS) {
+        printf("Failed to create UDP CLAs on ports %u and %u\n", port, port + 1);
+        bp_shutdown();
+        return 1;
+    }
+    if (bp_cla_create_shm("bench-sender", &shm_sender) != BP_SUCCESS ||
+        bp_cla_create_shm("bench-receiver", &shm_receiver) != BP_SUCCESS) {
+        printf("Failed to create shared-memory CLAs\n");
+        bp_shutdown();
+        return 1;
+    }
+
+    char udp_dest[32], udp_reply[32];
+    snprintf(udp_dest, sizeof(udp_dest), "127.0.0.1:%u", port + 1);
+    snprintf(udp_reply, sizeof(udp_reply), "127.0.0.1:%u", port);
+    echo_dests[0] = udp_reply;
+    echo_dests[1] = "bench-sender";
+
+    int failed = 0;
+    failed |= run_transport("udp", udp_sender, udp_receiver, 0, udp_dest, iterations);
+    failed |= run_transport("shm", shm_sender, shm_receiver, 1, "bench-receiver", iterations);
+
+    bp_cla_destroy(udp_sender);
+    bp_cla_destroy(udp_receiver);
+    bp_cla_destroy(shm_sender);
+    bp_cla_destroy(shm_receiver);
+    bp_shutdown();
+    return failed;
+}
\ No newline at end of file
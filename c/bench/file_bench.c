@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bp_sdk.h"
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int create_file(const char *path, size_t size) {
+    FILE *file = fopen(path, "wb");
+    if (!file) return -1;
+
+    char block[65536];
+    memset(block, 'x', sizeof(block));
+    
+    for (size_t written = 0; written < size; ) {
+        size_t chunk = (size - written < sizeof(block)) ? size - written : sizeof(block);
+        if (fwrite(block, 1, chunk, file) != chunk) {
+            fclose(file);
+            return -1;
+        }
+        written += chunk;
+    }
+    
+    return fclose(file);
+}
+
+// The buffered path has to read the whole file into RAM before bp_send() copies it into SDR
+static int send_buffered(const char *source, const char *dest, const char *path, size_t size) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return BP_ERROR_NOT_FOUND;
+
+    char *buffer = malloc(size);
+    if (!buffer) {
+        fclose(file);
+        return BP_ERROR_MEMORY;
+    }
+
+    int result = (fread(buffer, 1, size, file) == size) ? 
+                 bp_send(source, dest, buffer, size, BP_PRIORITY_BULK, BP_CUSTODY_NONE, 3600, NULL) : 
+                 BP_ERROR_STORAGE;
+    
+    free(buffer);
+    fclose(file);
+    return result;
+}
+
+static int bench_size(const char *source, const char *dest, const char *dir, size_t size) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/bp_file_bench_%zu.dat", dir, size);
+    
+    if (create_file(path, size) != 0) {
+        printf("Failed to create %s\n", path);
+        return 1;
+    }
+
+    double start = now_seconds();
+    int buffered = send_buffered(source, dest, path, size);
+    double buffered_time = now_seconds() - start;
+
+    start = now_seconds();
+    int file = bp_send_file(source, dest, path, 0, 0, BP_PRIORITY_BULK, BP_CUSTODY_NONE, 3600, NULL);
+    double file_time = now_seconds() - start;
+
+    printf("%10zu bytes: bp_send %.4fs (%s), bp_send_file %.4fs (%s)\n", size, 
+           buffered_time, bp_strerror(buffered), file_time, bp_strerror(file));
+
+    remove(path);
+    return buffered != BP_SUCCESS || file != BP_SUCCESS;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--help") == 0) {
+        printf("BP-SDK File Send Benchmark\n");
+        printf("Usage: %s [source_eid] [dest_eid] [scratch_dir]\n", argv[0]);
+        printf("\nCompares bp_send() on a file read into RAM against bp_send_file()\n");
+        printf("at 1 MB, 100 MB and 1 GB. Needs a running ION node and ~1 GB of scratch space.\n");
+        return 0;
+    }
+
+    const char *source = argc > 1 ? argv[1] : "ipn:1.1";
+    const char *dest = argc > 2 ? argv[2] : "ipn:2.1";
+    const char *dir = argc > 3 ? argv[3] : "/tmp";
+
+    int result = bp_init(source, NULL);
+    if (result != BP_SUCCESS) {
+        printf("Failed to initialize: %s\n", bp_strerror(result));
+        return 1;
+    }
+
+    const size_t sizes[] = { 1UL << 20, 100UL << 20, 1UL << 30 };
+    int failed = 0;
+    
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        failed |= bench_size(source, dest, dir, sizes[i]);
+    }
+
+    bp_shutdown();
+    return failed;
+}
\ No newline at end of file
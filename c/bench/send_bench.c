@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bp_sdk.h"
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int bench_send(const char *source, const char *dest, size_t payload_len, int iterations) {
+    char *payload = malloc(payload_len);
+    if (!payload) return 1;
+    memset(payload, 'x', payload_len);
+
+    int failures = 0;
+    double start = now_seconds();
+    
+    for (int i = 0; i < iterations; i++) {
+        if (bp_send(source, dest, payload, payload_len, BP_PRIORITY_STANDARD, 
+                    BP_CUSTODY_NONE, 3600, NULL) != BP_SUCCESS) {
+            failures++;
+        }
+    }
+    
+    double elapsed = now_seconds() - start;
+    printf("bp_send %8zu bytes: %8d sends in %.3fs = %10.0f sends/s (%d failed)\n", 
+           payload_len, iterations, elapsed, iterations / elapsed, failures);
+
+    free(payload);
+    return failures > 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--help") == 0) {
+        printf("BP-SDK Send Benchmark\n");
+        printf("Usage: %s [source_eid] [dest_eid] [iterations]\n", argv[0]);
+        printf("\nMeasures bp_send() throughput against a running ION node.\n");
+        return 0;
+    }
+
+    const char *source = argc > 1 ? argv[1] : "ipn:1.1";
+    const char *dest = argc > 2 ? argv[2] : "ipn:2.1";
+    int iterations = argc > 3 ? atoi(argv[3]) : 10000;
+
+    int result = bp_init(source, NULL);
+    if (result != BP_SUCCESS) {
+        printf("Failed to initialize: %s\n", bp_strerror(result));
+        return 1;
+    }
+
+    int failed = 0;
+    failed |= bench_send(source, dest, 64, iterations);
+    failed |= bench_send(source, dest, 1024, iterations);
+    failed |= bench_send(source, dest, 16384, iterations);
+
+    bp_shutdown();
+    return failed;
+}
\ No newline at end of file
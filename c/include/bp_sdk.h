@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <time.h>
 #include <stddef.h>
+#include <sys/uio.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -55,6 +56,65 @@ typedef struct {
     char *report_to_eid;
 } bp_bundle_t;
 
+typedef struct {
+    const char *source_eid;
+    const char *dest_eid;
+    const void *payload;
+    size_t payload_len;
+    bp_priority_t priority;
+    bp_custody_t custody;
+    uint32_t ttl;
+    const char *report_to_eid;
+} bp_send_req_t;
+
+typedef struct {
+    const char *source_eid;
+    bp_timestamp_t creation_time;
+    uint32_t ttl;
+    size_t payload_len;
+} bp_delivery_t;
+
+typedef struct {
+    uint64_t user_data;
+    int result;
+} bp_completion_t;
+
+#define BP_HISTOGRAM_BUCKETS 64
+
+typedef enum {
+    BP_HISTOGRAM_SEND_LATENCY = 0,
+    BP_HISTOGRAM_RECEIVE_LATENCY = 1,
+    BP_HISTOGRAM_PAYLOAD_SIZE = 2,
+    BP_HISTOGRAM_COUNT
+} bp_histogram_id_t;
+
+typedef struct {
+    char *id;
+    uint64_t bundles_sent;
+    uint64_t bundles_received;
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    uint64_t errors;
+} bp_stats_entry_t;
+
+typedef struct {
+    uint64_t timestamp_ms;
+    uint64_t bundles_sent;
+    uint64_t bundles_received;
+    uint64_t bundles_forwarded;
+    uint64_t bundles_delivered;
+    uint64_t bundles_deleted;
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    uint64_t histograms[BP_HISTOGRAM_COUNT][BP_HISTOGRAM_BUCKETS];
+    bp_stats_entry_t *endpoints;
+    int endpoint_count;
+    bp_stats_entry_t *clas;
+    int cla_count;
+} bp_stats_t;
+
+typedef int (*bp_sink_callback_t)(const bp_delivery_t *delivery, const void *chunk, size_t len, void *context);
+
 typedef struct {
     char *endpoint_id;
     void *context;
@@ -62,17 +122,73 @@ typedef struct {
     int (*status_callback)(const char *bundle_id, int status, void *context);
 } bp_endpoint_t;
 
+typedef enum {
+    BP_CLA_QUEUE_BLOCK = 0,
+    BP_CLA_QUEUE_DROP = 1
+} bp_cla_queue_policy_t;
+
+typedef enum {
+    BP_CLA_FRAGMENT = 1 << 0,
+    BP_CLA_PROBE = 1 << 1
+} bp_cla_flags_t;
+
+typedef struct {
+    uint32_t depth;
+    uint32_t capacity;
+    uint32_t high_watermark;
+    uint64_t enqueued;
+    uint64_t dropped;
+    uint64_t send_errors;
+} bp_cla_queue_stats_t;
+
+typedef struct {
+    int loop_threads;
+    int connections_per_peer;
+    int nodelay;
+    int cork;
+} bp_cla_tcp_config_t;
+
+typedef struct {
+    uint32_t pending;
+    uint64_t memory;
+    uint64_t completed;
+    uint64_t expired;
+    uint64_t evicted;
+    uint64_t malformed;
+} bp_cla_reassembly_stats_t;
+
+typedef struct {
+    uint32_t rtt_us;
+    uint64_t goodput;
+    double loss;
+    uint64_t probes_sent;
+    uint64_t probes_lost;
+    int live;
+} bp_cla_path_stats_t;
+
+typedef struct {
+    const struct iovec *iov;
+    int iovcnt;
+    const char *dest;
+    int result;
+} bp_cla_msg_t;
+
 typedef struct {
     char *protocol_name;
     char *local_address;
     char *remote_address;
     uint32_t max_payload_size;
-    uint32_t data_rate;
+    uint32_t data_rate;  // bytes per second; 0 leaves the CLA unpaced
     void *context;
     int (*send_callback)(const void *data, size_t len, const char *dest, void *context);
     int (*receive_callback)(void *data, size_t len, char *source, void *context);
     int (*connect_callback)(const char *remote, void *context);
     int (*disconnect_callback)(const char *remote, void *context);
+    int (*send_iov_callback)(const struct iovec *iov, int iovcnt, const char *dest, void *context);
+    int (*send_batch_callback)(bp_cla_msg_t *msgs, int count, void *context);
+    uint32_t queue_depth;
+    bp_cla_queue_policy_t queue_policy;
+    uint32_t flags;  // bp_cla_flags_t; both ends of a link must agree
 } bp_cla_t;
 
 typedef struct {
@@ -90,8 +206,24 @@ typedef struct {
     int (*compute_route)(const char *dest_eid, bp_route_t **routes, int *route_count, void *context);
     int (*update_contact)(const char *neighbor_eid, time_t start, time_t end, uint32_t rate, void *context);
     int (*update_range)(const char *neighbor_eid, time_t start, time_t end, uint32_t owlt, void *context);
+    int (*compute_route_sized)(const char *dest_eid, uint64_t bundle_size, bp_route_t **routes, int *route_count,
+                               void *context);
 } bp_routing_t;
 
+typedef struct {
+    uint32_t entries;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t invalidations;
+} bp_routing_cache_stats_t;
+
+typedef struct {
+    time_t start;
+    time_t end;
+    uint32_t rate;
+    uint64_t residual;
+} bp_contact_info_t;
+
 typedef struct {
     char *storage_name;
     void *context;
@@ -110,6 +242,12 @@ typedef struct {
     int (*verify)(const void *data, size_t data_len, const void *signature, size_t sig_len, void *context);
 } bp_security_t;
 
+typedef uint32_t bp_cla_handle_t;
+typedef uint32_t bp_routing_handle_t;
+typedef uint32_t bp_security_handle_t;
+
+#define BP_INVALID_HANDLE 0
+
 int bp_init(const char *node_id, const char *config_file);
 int bp_shutdown(void);
 int bp_is_initialized(void);
@@ -118,22 +256,88 @@ int bp_endpoint_create(const char *endpoint_id, bp_endpoint_t **endpoint);
 int bp_endpoint_destroy(bp_endpoint_t *endpoint);
 int bp_endpoint_register(bp_endpoint_t *endpoint);
 int bp_endpoint_unregister(bp_endpoint_t *endpoint);
+int bp_endpoint_get_fd(bp_endpoint_t *endpoint, int *fd);
 
 int bp_send(const char *source_eid, const char *dest_eid, const void *payload, size_t payload_len, 
             bp_priority_t priority, bp_custody_t custody, uint32_t ttl, const char *report_to_eid);
+int bp_send_batch(const bp_send_req_t *reqs, size_t n, int *results);
+int bp_async_start(int queue_depth);
+int bp_async_stop(void);
+int bp_send_async(const bp_send_req_t *req, uint64_t user_data);
+int bp_poll_completions(bp_completion_t *completions, int max, int *count, int timeout_ms);
+int bp_send_file(const char *source_eid, const char *dest_eid, const char *path, size_t offset, size_t length, 
+                 bp_priority_t priority, bp_custody_t custody, uint32_t ttl, const char *report_to_eid);
 int bp_receive(bp_endpoint_t *endpoint, bp_bundle_t **bundle, int timeout_ms);
 int bp_bundle_free(bp_bundle_t *bundle);
+int bp_bundle_pool_stats(uint64_t *hits, uint64_t *misses, uint64_t *oversize);
+
+int bp_receive_view(bp_endpoint_t *endpoint, bp_delivery_t **delivery, int timeout_ms);
+int bp_delivery_read(bp_delivery_t *delivery, void *buffer, size_t len, size_t *bytes_read);
+int bp_delivery_release(bp_delivery_t *delivery);
+int bp_receive_stream(bp_endpoint_t *endpoint, bp_sink_callback_t sink, void *context, 
+                      size_t chunk_size, int timeout_ms);
+
+int bp_dispatcher_start(int worker_count, int queue_depth);
+int bp_dispatcher_stop(void);
 
+int bp_cla_create_tcp(const char *local_addr, uint16_t local_port, bp_cla_t **cla);
+int bp_cla_create_tcp_ex(const char *local_addr, uint16_t local_port, const bp_cla_tcp_config_t *config, bp_cla_t **cla);
+int bp_cla_create_udp(const char *local_addr, uint16_t local_port, bp_cla_t **cla);
+int bp_cla_create_shm(const char *name, bp_cla_t **cla);
+int bp_cla_start(bp_cla_t *cla);  // receives on a built-in CLA without registering it; set receive_callback first
+int bp_cla_destroy(bp_cla_t *cla);
 int bp_cla_register(bp_cla_t *cla);
 int bp_cla_unregister(const char *protocol_name);
 int bp_cla_send(const char *protocol_name, const char *dest_addr, const void *data, size_t len);
 int bp_cla_list(char ***protocol_names, int *count);
+int bp_cla_register_h(bp_cla_t *cla, bp_cla_handle_t *handle);
+int bp_cla_unregister_h(bp_cla_handle_t handle);
+int bp_cla_lookup(const char *protocol_name, bp_cla_handle_t *handle);
+int bp_cla_send_h(bp_cla_handle_t handle, const char *dest_addr, const void *data, size_t len);
+int bp_cla_sendv(const char *protocol_name, const char *dest_addr, const struct iovec *iov, int iovcnt);
+int bp_cla_sendv_h(bp_cla_handle_t handle, const char *dest_addr, const struct iovec *iov, int iovcnt);
+int bp_cla_sendv_priority(const char *protocol_name, const char *dest_addr, const struct iovec *iov, int iovcnt,
+                          bp_priority_t priority);
+int bp_cla_queue_stats(const char *protocol_name, bp_cla_queue_stats_t *stats);
+int bp_cla_handle_bundle_receive(bp_cla_t *cla, const void *data, size_t len, const char *source_eid);
+int bp_cla_set_rate(const char *protocol_name, uint32_t data_rate);
+int bp_cla_set_burst(const char *protocol_name, bp_priority_t priority, uint32_t burst_bytes);
+int bp_cla_set_reassembly_limits(size_t memory_limit, uint32_t timeout_ms);
+int bp_cla_reassembly_stats(bp_cla_reassembly_stats_t *stats);
+int bp_cla_bond_add(const char *neighbor, const char *protocol_name, const char *dest_addr);
+int bp_cla_bond_remove(const char *neighbor, const char *protocol_name);
+int bp_cla_bond_send(const char *neighbor, const void *data, size_t len);
+int bp_cla_bond_sendv(const char *neighbor, const struct iovec *iov, int iovcnt);
+int bp_cla_probe_start(uint32_t interval_ms);  // probes bond members only, see bp_cla_bond_add()
+int bp_cla_probe_stop(void);
+int bp_cla_select(const char *dest, char **protocol_name, char **dest_addr);
+int bp_cla_path_stats(const char *dest, const char *protocol_name, bp_cla_path_stats_t *stats);
 
 int bp_routing_register(bp_routing_t *routing);
 int bp_routing_unregister(const char *algorithm_name);
 int bp_routing_compute(const char *dest_eid, bp_route_t **routes, int *route_count);
+int bp_routing_compute_sized(const char *dest_eid, uint64_t bundle_size, bp_route_t **routes, int *route_count);
 int bp_routing_update_contact(const char *neighbor_eid, time_t start, time_t end, uint32_t rate);
 int bp_routing_update_range(const char *neighbor_eid, time_t start, time_t end, uint32_t owlt);
+int bp_routing_register_h(bp_routing_t *routing, bp_routing_handle_t *handle);
+int bp_routing_unregister_h(bp_routing_handle_t handle);
+int bp_routing_lookup(const char *algorithm_name, bp_routing_handle_t *handle);
+int bp_routing_compute_h(bp_routing_handle_t handle, const char *dest_eid, bp_route_t **routes, int *route_count);
+int bp_routing_cache_stats(bp_routing_cache_stats_t *stats);
+int bp_routing_cache_invalidate(const char *neighbor_eid);
+int bp_routing_create_cgr(bp_routing_t **routing);
+int bp_routing_create_static(bp_routing_t **routing);
+int bp_routing_destroy(bp_routing_t *routing);
+int bp_route_create(const char *dest_eid, const char *next_hop, uint32_t cost, 
+                   float confidence, time_t valid_until, bp_route_t **route);
+int bp_route_destroy(bp_route_t *route);
+int bp_route_list_destroy(bp_route_t *routes, int count);
+int bp_contact_plan_add_contact(const char *from_eid, const char *to_eid, time_t start, time_t end, uint32_t rate);
+int bp_contact_plan_add_range(const char *from_eid, const char *to_eid, time_t start, time_t end, uint32_t owlt);
+int bp_contact_plan_query(const char *from_eid, const char *to_eid, time_t t0, time_t t1,
+                          bp_contact_info_t **contacts, int *count);
+int bp_contact_plan_next(const char *from_eid, const char *to_eid, time_t after, bp_contact_info_t *contact);
+int bp_contact_plan_consume(const char *neighbor_eid, time_t when, uint64_t bytes);
 
 int bp_storage_register(bp_storage_t *storage);
 int bp_storage_unregister(const char *storage_name);
@@ -148,6 +352,13 @@ int bp_security_encrypt(const void *plain, size_t plain_len, void **cipher, size
 int bp_security_decrypt(const void *cipher, size_t cipher_len, void **plain, size_t *plain_len);
 int bp_security_sign(const void *data, size_t data_len, void **signature, size_t *sig_len);
 int bp_security_verify(const void *data, size_t data_len, const void *signature, size_t sig_len);
+int bp_security_register_h(bp_security_t *security, bp_security_handle_t *handle);
+int bp_security_unregister_h(bp_security_handle_t handle);
+int bp_security_lookup(const char *security_name, bp_security_handle_t *handle);
+int bp_security_encrypt_h(bp_security_handle_t handle, const void *plain, size_t plain_len, void **cipher, size_t *cipher_len);
+int bp_security_decrypt_h(bp_security_handle_t handle, const void *cipher, size_t cipher_len, void **plain, size_t *plain_len);
+int bp_security_sign_h(bp_security_handle_t handle, const void *data, size_t data_len, void **signature, size_t *sig_len);
+int bp_security_verify_h(bp_security_handle_t handle, const void *data, size_t data_len, const void *signature, size_t sig_len);
 
 int bp_admin_add_plan(const char *dest_eid, uint32_t nominal_rate);
 int bp_admin_remove_plan(const char *dest_eid);
@@ -161,7 +372,14 @@ int bp_stats_get_bundles_received(uint64_t *count);
 int bp_stats_get_bundles_forwarded(uint64_t *count);
 int bp_stats_get_bundles_delivered(uint64_t *count);
 int bp_stats_get_bundles_deleted(uint64_t *count);
+int bp_stats_get_bytes_sent(uint64_t *count);
+int bp_stats_get_bytes_received(uint64_t *count);
+int bp_stats_get_histogram(bp_histogram_id_t histogram, uint64_t buckets[BP_HISTOGRAM_BUCKETS]);
 int bp_stats_reset(void);
+int bp_stats_snapshot(bp_stats_t *stats);
+int bp_stats_snapshot_free(bp_stats_t *stats);
+int bp_stats_serialize(const bp_stats_t *stats, void *buffer, size_t len, size_t *written);
+int bp_stats_deserialize(const void *buffer, size_t len, bp_stats_t *stats);
 
 const char *bp_strerror(bp_result_t result);
 
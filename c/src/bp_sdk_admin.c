@@ -40,6 +40,46 @@ int bp_admin_remove_plan(const char *dest_eid) {
     return admin_wrapper(removePlan, dest_eid);
 }
 
+static int contact_matches(Sdr sdr, Object elt, uvast toNode, time_t start, time_t end) {
+    IonContact contact;
+    sdr_read(sdr, (char*)&contact, sdr_list_data(sdr, elt), sizeof(IonContact));
+    return contact.toNode == toNode && contact.fromTime == start && contact.toTime == end;
+}
+
+static int range_matches(Sdr sdr, Object elt, uvast toNode, time_t start, time_t end) {
+    IonRange range;
+    sdr_read(sdr, (char*)&range, sdr_list_data(sdr, elt), sizeof(IonRange));
+    return range.toNode == toNode && range.fromTime == start && range.toTime == end;
+}
+
+// The contact plan keeps the list element of everything added here, so removal is a lookup;
+// entries loaded some other way, e.g. by ionadmin, are still found by scanning the list
+static Object find_listed(Sdr sdr, Object list, bp_contact_plan_kind_t kind, uvast toNode, time_t start, time_t end,
+                          int (*matches)(Sdr, Object, uvast, time_t, time_t)) {
+    uint64_t local_node;
+    bp_contact_plan_entry_t entry;
+    if (bp_contact_plan_node_of(NULL, &local_node) &&
+        bp_contact_plan_lookup(kind, local_node, toNode, start, &entry) == BP_SUCCESS &&
+        entry.ref && sdr_list_list(sdr, (Object)entry.ref) == list && matches(sdr, (Object)entry.ref, toNode, start, end)) {
+        return (Object)entry.ref;
+    }
+
+    for (Object elt = sdr_list_first(sdr, list); elt; elt = sdr_list_next(sdr, elt)) {
+        if (matches(sdr, elt, toNode, start, end)) return elt;
+    }
+    return 0;
+}
+
+// Mirrors a committed change into the contact plan; a value of 0 drops the entry
+static void record_listed(bp_contact_plan_kind_t kind, const char *neighbor_eid, uvast toNode, time_t start, time_t end,
+                          uint32_t value, Object elt) {
+    uint64_t local_node;
+    if (bp_contact_plan_node_of(NULL, &local_node)) {
+        bp_contact_plan_update(kind, local_node, toNode, start, end, value, elt);
+    }
+    bp_route_cache_invalidate(neighbor_eid);
+}
+
 int bp_admin_add_contact(const char *neighbor_eid, time_t start, time_t end, uint32_t rate) {
     if (!neighbor_eid || start >= end || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
@@ -79,9 +119,11 @@ int bp_admin_add_contact(const char *neighbor_eid, time_t start, time_t end, uin
 
     IonDB iondb;
     sdr_read(sdr, (char*)&iondb, iondbObj, sizeof(IonDB));
-    sdr_list_insert_last(sdr, iondb.regions[0].contacts, contactObj);
+    Object elt = sdr_list_insert_last(sdr, iondb.regions[0].contacts, contactObj);
     
-    return (sdr_end_xn(sdr) < 0) ? BP_ERROR_PROTOCOL : BP_SUCCESS;
+    if (sdr_end_xn(sdr) < 0) return BP_ERROR_PROTOCOL;
+    record_listed(BP_CONTACT_PLAN_CONTACT, neighbor_eid, toNode, start, end, rate, elt);
+    return BP_SUCCESS;
 }
 
 int bp_admin_remove_contact(const char *neighbor_eid, time_t start, time_t end) {
@@ -107,22 +149,16 @@ int bp_admin_remove_contact(const char *neighbor_eid, time_t start, time_t end)
     IonDB iondb;
     sdr_read(sdr, (char*)&iondb, iondbObj, sizeof(IonDB));
     
-    Object elt = sdr_list_first(sdr, iondb.regions[0].contacts);
-    while (elt) {
+    Object elt = find_listed(sdr, iondb.regions[0].contacts, BP_CONTACT_PLAN_CONTACT, toNode, start, end, contact_matches);
+    if (elt) {
         Object contactObj = sdr_list_data(sdr, elt);
-        IonContact contact;
-        sdr_read(sdr, (char*)&contact, contactObj, sizeof(IonContact));
-        
-        if (contact.toNode == toNode && contact.fromTime == start && contact.toTime == end) {
-            sdr_list_delete(sdr, elt, NULL, NULL);
-            sdr_free(sdr, contactObj);
-            break;
-        }
-        
-        elt = sdr_list_next(sdr, elt);
+        sdr_list_delete(sdr, elt, NULL, NULL);
+        sdr_free(sdr, contactObj);
     }
     
-    return (sdr_end_xn(sdr) < 0) ? BP_ERROR_PROTOCOL : BP_SUCCESS;
+    if (sdr_end_xn(sdr) < 0) return BP_ERROR_PROTOCOL;
+    record_listed(BP_CONTACT_PLAN_CONTACT, neighbor_eid, toNode, start, end, 0, 0);
+    return BP_SUCCESS;
 }
 
 int bp_admin_add_range(const char *neighbor_eid, time_t start, time_t end, uint32_t owlt) {
@@ -162,9 +198,11 @@ int bp_admin_add_range(const char *neighbor_eid, time_t start, time_t end, uint3
 
     IonDB iondb;
     sdr_read(sdr, (char*)&iondb, iondbObj, sizeof(IonDB));
-    sdr_list_insert_last(sdr, iondb.ranges, rangeObj);
+    Object elt = sdr_list_insert_last(sdr, iondb.ranges, rangeObj);
     
-    return (sdr_end_xn(sdr) < 0) ? BP_ERROR_PROTOCOL : BP_SUCCESS;
+    if (sdr_end_xn(sdr) < 0) return BP_ERROR_PROTOCOL;
+    record_listed(BP_CONTACT_PLAN_RANGE, neighbor_eid, toNode, start, end, owlt, elt);
+    return BP_SUCCESS;
 }
 
 int bp_admin_remove_range(const char *neighbor_eid, time_t start, time_t end) {
@@ -190,48 +228,16 @@ int bp_admin_remove_range(const char *neighbor_eid, time_t start, time_t end) {
     IonDB iondb;
     sdr_read(sdr, (char*)&iondb, iondbObj, sizeof(IonDB));
     
-    Object elt = sdr_list_first(sdr, iondb.ranges);
-    while (elt) {
+    Object elt = find_listed(sdr, iondb.ranges, BP_CONTACT_PLAN_RANGE, toNode, start, end, range_matches);
+    if (elt) {
         Object rangeObj = sdr_list_data(sdr, elt);
-        IonRange range;
-        sdr_read(sdr, (char*)&range, rangeObj, sizeof(IonRange));
-        
-        if (range.toNode == toNode && range.fromTime == start && range.toTime == end) {
-            sdr_list_delete(sdr, elt, NULL, NULL);
-            sdr_free(sdr, rangeObj);
-            break;
-        }
-        
-        elt = sdr_list_next(sdr, elt);
+        sdr_list_delete(sdr, elt, NULL, NULL);
+        sdr_free(sdr, rangeObj);
     }
     
-    return (sdr_end_xn(sdr) < 0) ? BP_ERROR_PROTOCOL : BP_SUCCESS;
-}
-
-int bp_stats_get_bundles_sent(uint64_t *count) {
-    return (!count || !g_bp_context.initialized) ? 
-           (!g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS) : 
-           (*count = 0, BP_SUCCESS);
-}
-
-int bp_stats_get_bundles_received(uint64_t *count) {
-    return bp_stats_get_bundles_sent(count);
-}
-
-int bp_stats_get_bundles_forwarded(uint64_t *count) {
-    return bp_stats_get_bundles_sent(count);
-}
-
-int bp_stats_get_bundles_delivered(uint64_t *count) {
-    return bp_stats_get_bundles_sent(count);
-}
-
-int bp_stats_get_bundles_deleted(uint64_t *count) {
-    return bp_stats_get_bundles_sent(count);
-}
-
-int bp_stats_reset(void) {
-    return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_SUCCESS;
+    if (sdr_end_xn(sdr) < 0) return BP_ERROR_PROTOCOL;
+    record_listed(BP_CONTACT_PLAN_RANGE, neighbor_eid, toNode, start, end, 0, 0);
+    return BP_SUCCESS;
 }
 
 int bp_admin_add_scheme(const char *scheme_name, const char *forwarder_cmd, const char *admin_cmd) {
@@ -0,0 +1,237 @@
+#include "bp_sdk_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#define ASYNC_BATCH_MAX 64
+
+typedef struct {
+    bp_send_req_t req;
+    uint64_t user_data;
+} async_submission_t;
+
+// Submissions and completions are rings of the same depth. A slot stays reserved from
+// bp_send_async() until its completion is reaped, so the completion ring can never overflow.
+// The completion ring outlives bp_async_stop() until everything on it has been reaped.
+static struct {
+    int running;
+    int stopping;
+    pthread_mutex_t lock;
+    pthread_once_t once;
+    pthread_cond_t submitted;
+    pthread_cond_t completed;
+    pthread_t thread;
+    int depth;
+    int reserved;
+    async_submission_t *sq;
+    int sq_head;
+    int sq_count;
+    bp_completion_t *cq;
+    int cq_head;
+    int cq_count;
+} g_async = { .lock = PTHREAD_MUTEX_INITIALIZER, .once = PTHREAD_ONCE_INIT };
+
+static void *submitter_main(void *arg) {
+    (void)arg;
+    bp_send_req_t reqs[ASYNC_BATCH_MAX];
+    uint64_t user_data[ASYNC_BATCH_MAX];
+    int results[ASYNC_BATCH_MAX];
+
+    pthread_mutex_lock(&g_async.lock);
+    for (;;) {
+        while (g_async.sq_count == 0 && !g_async.stopping) {
+            pthread_cond_wait(&g_async.submitted, &g_async.lock);
+        }
+        // Stopping still drains what was already submitted
+        if (g_async.sq_count == 0) break;
+
+        int n = g_async.sq_count < ASYNC_BATCH_MAX ? g_async.sq_count : ASYNC_BATCH_MAX;
+        for (int i = 0; i < n; i++) {
+            async_submission_t *sub = &g_async.sq[(g_async.sq_head + i) % g_async.depth];
+            reqs[i] = sub->req;
+            user_data[i] = sub->user_data;
+        }
+        g_async.sq_head = (g_async.sq_head + n) % g_async.depth;
+        g_async.sq_count -= n;
+        pthread_mutex_unlock(&g_async.lock);
+
+        bp_send_batch(reqs, n, results);
+
+        pthread_mutex_lock(&g_async.lock);
+        for (int i = 0; i < n; i++) {
+            bp_completion_t *completion = &g_async.cq[(g_async.cq_head + g_async.cq_count) % g_async.depth];
+            completion->user_data = user_data[i];
+            completion->result = results[i];
+            g_async.cq_count++;
+        }
+        pthread_cond_broadcast(&g_async.completed);
+    }
+    pthread_mutex_unlock(&g_async.lock);
+    return NULL;
+}
+
+// The condition variables outlive start/stop cycles so a poller woken by bp_async_stop() never races their destruction
+static void init_conds(void) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_async.submitted, NULL);
+    pthread_cond_init(&g_async.completed, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+int bp_async_start(int queue_depth) {
+    if (queue_depth <= 0 || !g_bp_context.initialized)
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    pthread_once(&g_async.once, init_conds);
+
+    pthread_mutex_lock(&g_async.lock);
+    if (g_async.running || g_async.cq) {
+        pthread_mutex_unlock(&g_async.lock);
+        return BP_ERROR_DUPLICATE;
+    }
+
+    g_async.sq = calloc(queue_depth, sizeof(async_submission_t));
+    g_async.cq = calloc(queue_depth, sizeof(bp_completion_t));
+    if (!g_async.sq || !g_async.cq) {
+        free(g_async.sq);
+        free(g_async.cq);
+        g_async.sq = NULL;
+        g_async.cq = NULL;
+        pthread_mutex_unlock(&g_async.lock);
+        return BP_ERROR_MEMORY;
+    }
+
+    g_async.depth = queue_depth;
+    g_async.reserved = 0;
+    g_async.sq_head = g_async.sq_count = 0;
+    g_async.cq_head = g_async.cq_count = 0;
+    g_async.stopping = 0;
+
+    if (pthread_create(&g_async.thread, NULL, submitter_main, NULL) != 0) {
+        free(g_async.sq);
+        free(g_async.cq);
+        g_async.sq = NULL;
+        g_async.cq = NULL;
+        pthread_mutex_unlock(&g_async.lock);
+        return BP_ERROR_MEMORY;
+    }
+
+    g_async.running = 1;
+    pthread_mutex_unlock(&g_async.lock);
+    return BP_SUCCESS;
+}
+
+// Caller holds the lock
+static void free_completions(void) {
+    free(g_async.cq);
+    g_async.cq = NULL;
+    g_async.cq_head = g_async.cq_count = 0;
+    g_async.reserved = 0;
+}
+
+int bp_async_stop(void) {
+    pthread_mutex_lock(&g_async.lock);
+    if (!g_async.running || g_async.stopping) {
+        pthread_mutex_unlock(&g_async.lock);
+        return BP_ERROR_NOT_INITIALIZED;
+    }
+    g_async.stopping = 1;
+    pthread_cond_broadcast(&g_async.submitted);
+    pthread_cond_broadcast(&g_async.completed);
+    pthread_mutex_unlock(&g_async.lock);
+
+    pthread_join(g_async.thread, NULL);
+
+    // Completions nobody reaped yet stay for bp_poll_completions(), which frees the ring once it is empty
+    pthread_mutex_lock(&g_async.lock);
+    free(g_async.sq);
+    g_async.sq = NULL;
+    g_async.sq_count = 0;
+    g_async.running = 0;
+    if (g_async.cq_count == 0) free_completions();
+    pthread_cond_broadcast(&g_async.completed);
+    pthread_mutex_unlock(&g_async.lock);
+    return BP_SUCCESS;
+}
+
+void bp_async_clear(void) {
+    pthread_mutex_lock(&g_async.lock);
+    if (!g_async.running) free_completions();
+    pthread_mutex_unlock(&g_async.lock);
+}
+
+// The request's strings and payload are not copied and must stay valid until the completion is reaped
+int bp_send_async(const bp_send_req_t *req, uint64_t user_data) {
+    if (!req || !req->source_eid || !req->dest_eid || !req->payload || req->payload_len == 0 ||
+        !g_bp_context.initialized)
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    pthread_mutex_lock(&g_async.lock);
+    if (!g_async.running || g_async.stopping) {
+        pthread_mutex_unlock(&g_async.lock);
+        return BP_ERROR_NOT_INITIALIZED;
+    }
+
+    // Never blocks: a full ring is reported so the caller can reap completions and retry
+    if (g_async.reserved == g_async.depth) {
+        pthread_mutex_unlock(&g_async.lock);
+        return BP_ERROR_TIMEOUT;
+    }
+
+    async_submission_t *sub = &g_async.sq[(g_async.sq_head + g_async.sq_count) % g_async.depth];
+    sub->req = *req;
+    sub->user_data = user_data;
+    g_async.sq_count++;
+    g_async.reserved++;
+
+    pthread_cond_signal(&g_async.submitted);
+    pthread_mutex_unlock(&g_async.lock);
+    return BP_SUCCESS;
+}
+
+// timeout_ms of 0 returns immediately, a negative value waits until at least one completion arrives
+int bp_poll_completions(bp_completion_t *completions, int max, int *count, int timeout_ms) {
+    if (!completions || max <= 0 || !count || !g_bp_context.initialized)
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    *count = 0;
+
+    struct timespec deadline;
+    if (timeout_ms > 0) bp_deadline_after_ms(&deadline, timeout_ms);
+
+    pthread_mutex_lock(&g_async.lock);
+    if (!g_async.running && g_async.cq_count == 0) {
+        pthread_mutex_unlock(&g_async.lock);
+        return BP_ERROR_NOT_INITIALIZED;
+    }
+
+    int result = BP_SUCCESS;
+    while (g_async.cq_count == 0 && result == BP_SUCCESS) {
+        if (timeout_ms == 0 || !g_async.running || g_async.stopping) {
+            result = BP_ERROR_TIMEOUT;
+        } else if (timeout_ms > 0) {
+            if (pthread_cond_timedwait(&g_async.completed, &g_async.lock, &deadline) == ETIMEDOUT) {
+                result = BP_ERROR_TIMEOUT;
+            }
+        } else {
+            pthread_cond_wait(&g_async.completed, &g_async.lock);
+        }
+    }
+
+    int n = g_async.cq_count < max ? g_async.cq_count : max;
+    for (int i = 0; i < n; i++) {
+        completions[i] = g_async.cq[(g_async.cq_head + i) % g_async.depth];
+    }
+    g_async.cq_head = (g_async.cq_head + n) % g_async.depth;
+    g_async.cq_count -= n;
+    g_async.reserved -= n;
+    *count = n;
+    if (!g_async.running && g_async.cq_count == 0) free_completions();
+
+    pthread_mutex_unlock(&g_async.lock);
+    return n > 0 ? BP_SUCCESS : result;
+}
\ No newline at end of file
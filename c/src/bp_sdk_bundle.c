@@ -0,0 +1,205 @@
+#include "bp_sdk_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define POOL_BLOCK_SIZE 2048
+#define POOL_THREAD_CACHE_MAX 64
+#define POOL_TRANSFER_BATCH 32
+
+// Header, source EID and small payloads share one block; free blocks are chained through next
+typedef struct pool_block {
+    bp_bundle_t bundle;
+    struct pool_block *next;
+} pool_block_t;
+
+#define POOL_ALIGN(n) (((n) + 15) & ~(size_t)15)
+#define POOL_EID_OFFSET POOL_ALIGN(sizeof(pool_block_t))
+#define POOL_EID_CAPACITY (POOL_BLOCK_SIZE - POOL_EID_OFFSET)
+
+typedef struct {
+    pool_block_t *free_list;
+    int count;
+} thread_cache_t;
+
+static __thread thread_cache_t t_cache;
+static __thread int t_cache_registered;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_once_t once;
+    pthread_key_t key;
+    pool_block_t *free_list;
+    int count;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t oversize;
+} g_pool = { .lock = PTHREAD_MUTEX_INITIALIZER, .once = PTHREAD_ONCE_INIT };
+
+static void give_back(pool_block_t *head, pool_block_t *tail, int count) {
+    pthread_mutex_lock(&g_pool.lock);
+    tail->next = g_pool.free_list;
+    g_pool.free_list = head;
+    g_pool.count += count;
+    pthread_mutex_unlock(&g_pool.lock);
+}
+
+static void thread_cache_release(void *arg) {
+    (void)arg;
+    if (!t_cache.free_list) return;
+
+    pool_block_t *tail = t_cache.free_list;
+    while (tail->next) tail = tail->next;
+    give_back(t_cache.free_list, tail, t_cache.count);
+    t_cache.free_list = NULL;
+    t_cache.count = 0;
+}
+
+static void pool_init_key(void) {
+    pthread_key_create(&g_pool.key, thread_cache_release);
+}
+
+// The key only exists so a thread's cache goes back to the shared list when the thread exits
+static void thread_cache_register(void) {
+    pthread_once(&g_pool.once, pool_init_key);
+    pthread_setspecific(g_pool.key, &t_cache);
+    t_cache_registered = 1;
+}
+
+static pool_block_t *thread_cache_refill(void) {
+    pthread_mutex_lock(&g_pool.lock);
+    for (int i = 0; i < POOL_TRANSFER_BATCH && g_pool.free_list; i++) {
+        pool_block_t *block = g_pool.free_list;
+        g_pool.free_list = block->next;
+        g_pool.count--;
+        block->next = t_cache.free_list;
+        t_cache.free_list = block;
+        t_cache.count++;
+    }
+    pthread_mutex_unlock(&g_pool.lock);
+    return t_cache.free_list;
+}
+
+static pool_block_t *pool_take(void) {
+    if (!t_cache_registered) thread_cache_register();
+
+    pool_block_t *block = t_cache.free_list ? t_cache.free_list : thread_cache_refill();
+    if (block) {
+        t_cache.free_list = block->next;
+        t_cache.count--;
+        __atomic_fetch_add(&g_pool.hits, 1, __ATOMIC_RELAXED);
+        return block;
+    }
+
+    block = malloc(POOL_BLOCK_SIZE);
+    if (block) __atomic_fetch_add(&g_pool.misses, 1, __ATOMIC_RELAXED);
+    return block;
+}
+
+// Without a source EID in the block a pooled bundle could not be recognised when freed
+static bp_bundle_t *heap_alloc(size_t eid_len, size_t payload_len) {
+    bp_bundle_t *bundle = calloc(1, sizeof(bp_bundle_t));
+    if (!bundle) return NULL;
+
+    if (eid_len > 0) bundle->source_eid = malloc(eid_len);
+    if (payload_len > 0) bundle->payload = malloc(payload_len);
+    if ((eid_len > 0 && !bundle->source_eid) || (payload_len > 0 && !bundle->payload)) {
+        bp_bundle_free(bundle);
+        return NULL;
+    }
+    bundle->payload_len = payload_len;
+    return bundle;
+}
+
+bp_bundle_t *bp_bundle_alloc(size_t eid_len, size_t payload_len) {
+    if (eid_len == 0 || eid_len > POOL_EID_CAPACITY) return heap_alloc(eid_len, payload_len);
+
+    pool_block_t *block = pool_take();
+    if (!block) return NULL;
+
+    bp_bundle_t *bundle = &block->bundle;
+    memset(bundle, 0, sizeof(bp_bundle_t));
+    bundle->source_eid = (char*)block + POOL_EID_OFFSET;
+
+    // Payloads too big for the rest of the block get their own allocation
+    size_t payload_offset = POOL_ALIGN(POOL_EID_OFFSET + eid_len);
+    if (payload_len > 0 && payload_offset + payload_len <= POOL_BLOCK_SIZE) {
+        bundle->payload = (char*)block + payload_offset;
+    } else if (payload_len > 0) {
+        __atomic_fetch_add(&g_pool.oversize, 1, __ATOMIC_RELAXED);
+        bundle->payload = malloc(payload_len);
+        if (!bundle->payload) {
+            free(block);
+            return NULL;
+        }
+    }
+    bundle->payload_len = payload_len;
+    return bundle;
+}
+
+static void pool_release(pool_block_t *block) {
+    if (!t_cache_registered) thread_cache_register();
+
+    block->next = t_cache.free_list;
+    t_cache.free_list = block;
+    t_cache.count++;
+
+    if (t_cache.count <= POOL_THREAD_CACHE_MAX) return;
+
+    // Hand a batch to the shared list so blocks freed on one thread can be reused on another
+    pool_block_t *head = t_cache.free_list;
+    pool_block_t *tail = head;
+    for (int i = 1; i < POOL_TRANSFER_BATCH; i++) tail = tail->next;
+
+    t_cache.free_list = tail->next;
+    t_cache.count -= POOL_TRANSFER_BATCH;
+    give_back(head, tail, POOL_TRANSFER_BATCH);
+}
+
+static int in_block(const pool_block_t *block, const void *pointer) {
+    uintptr_t address = (uintptr_t)pointer;
+    return address >= (uintptr_t)block && address < (uintptr_t)block + POOL_BLOCK_SIZE;
+}
+
+int bp_bundle_free(bp_bundle_t *bundle) {
+    if (!bundle) return BP_ERROR_INVALID_ARGS;
+
+    // Only a pooled bundle has its source EID right behind the header; a caller-built bundle's
+    // strings are separate allocations, so this never reads outside the caller's struct
+    pool_block_t *block = (pool_block_t*)bundle;
+    int pooled = bundle->source_eid == (char*)block + POOL_EID_OFFSET;
+
+    free(bundle->eid);
+    free(bundle->dest_eid);
+    free(bundle->report_to_eid);
+    if (!pooled || !in_block(block, bundle->payload)) free(bundle->payload);
+
+    if (pooled) {
+        pool_release(block);
+    } else {
+        free(bundle->source_eid);
+        free(bundle);
+    }
+    return BP_SUCCESS;
+}
+
+void bp_bundle_pool_trim(void) {
+    pthread_mutex_lock(&g_pool.lock);
+    while (g_pool.free_list) {
+        pool_block_t *next = g_pool.free_list->next;
+        free(g_pool.free_list);
+        g_pool.free_list = next;
+    }
+    g_pool.count = 0;
+    pthread_mutex_unlock(&g_pool.lock);
+}
+
+int bp_bundle_pool_stats(uint64_t *hits, uint64_t *misses, uint64_t *oversize) {
+    if (!hits || !misses) return BP_ERROR_INVALID_ARGS;
+
+    *hits = __atomic_load_n(&g_pool.hits, __ATOMIC_RELAXED);
+    *misses = __atomic_load_n(&g_pool.misses, __ATOMIC_RELAXED);
+    if (oversize) *oversize = __atomic_load_n(&g_pool.oversize, __ATOMIC_RELAXED);
+    return BP_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,207 @@
+#include "bp_sdk_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+extern bp_context_t g_bp_context;
+
+#define CGR_MAX_ROUTES 3
+
+typedef struct {
+    time_t arrival;
+    uint32_t node;
+} heap_item_t;
+
+typedef struct {
+    heap_item_t *items;
+    uint32_t count;
+    uint32_t capacity;
+} heap_t;
+
+static int heap_push(heap_t *heap, time_t arrival, uint32_t node) {
+    if (heap->count == heap->capacity) {
+        uint32_t capacity = heap->capacity ? heap->capacity * 2 : 64;
+        heap_item_t *items = realloc(heap->items, capacity * sizeof(heap_item_t));
+        if (!items) return 0;
+        heap->items = items;
+        heap->capacity = capacity;
+    }
+
+    uint32_t i = heap->count++;
+    while (i > 0 && heap->items[(i - 1) / 2].arrival > arrival) {
+        heap->items[i] = heap->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap->items[i].arrival = arrival;
+    heap->items[i].node = node;
+    return 1;
+}
+
+static heap_item_t heap_pop(heap_t *heap) {
+    heap_item_t top = heap->items[0];
+    heap_item_t last = heap->items[--heap->count];
+
+    uint32_t i = 0;
+    for (;;) {
+        uint32_t child = 2 * i + 1;
+        if (child >= heap->count) break;
+        if (child + 1 < heap->count && heap->items[child + 1].arrival < heap->items[child].arrival) child++;
+        if (heap->items[child].arrival >= last.arrival) break;
+        heap->items[i] = heap->items[child];
+        i = child;
+    }
+    if (heap->count > 0) heap->items[i] = last;
+    return top;
+}
+
+typedef struct {
+    time_t *arrival;
+    const bp_contact_plan_entry_t **via;
+    uint8_t *settled;
+    uint8_t *excluded;
+    heap_t heap;
+} search_t;
+
+// Earliest-arrival Dijkstra over nodes, which is exact because contacts are FIFO: reaching a
+// node sooner never makes a later departure impossible. Each link contributes its earliest
+// departure still open on arrival with residual volume for the bundle. via[n] is the contact that reached n.
+static int search(search_t *s, uint32_t local, uint32_t dest, time_t now, uint64_t bundle_size) {
+    uint32_t node_count = bp_contact_plan_node_count();
+    for (uint32_t n = 0; n < node_count; n++) {
+        s->arrival[n] = (time_t)-1;
+        s->via[n] = NULL;
+        s->settled[n] = 0;
+    }
+    s->heap.count = 0;
+    s->arrival[local] = now;
+    if (!heap_push(&s->heap, now, local)) return BP_ERROR_MEMORY;
+
+    uint32_t local_first;
+    bp_contact_plan_links(local, &local_first);
+
+    while (s->heap.count > 0) {
+        heap_item_t item = heap_pop(&s->heap);
+        uint32_t u = item.node;
+        if (s->settled[u] || item.arrival != s->arrival[u]) continue;
+        s->settled[u] = 1;
+        if (u == dest) return BP_SUCCESS;
+
+        uint32_t first, last = bp_contact_plan_links(u, &first);
+        for (uint32_t l = first; l < last; l++) {
+            uint32_t to = bp_contact_plan_link_to(l);
+            if (s->settled[to] || (u == local && s->excluded[l - local_first])) continue;
+
+            const bp_contact_plan_entry_t *c = bp_contact_plan_link_next(l, item.arrival, bundle_size);
+            if (!c) continue;
+
+            time_t depart = item.arrival > c->start ? item.arrival : c->start;
+            time_t arrival = depart + bp_contact_plan_owlt(u, to, depart);
+            if (s->arrival[to] == (time_t)-1 || arrival < s->arrival[to]) {
+                s->arrival[to] = arrival;
+                s->via[to] = c;
+                if (!heap_push(&s->heap, arrival, to)) return BP_ERROR_MEMORY;
+            }
+        }
+    }
+    return BP_ERROR_NOT_FOUND;
+}
+
+static int make_route(const search_t *s, uint32_t local, uint32_t dest, const char *dest_eid, time_t now,
+                      bp_route_t *route, uint32_t *first_hop) {
+    const bp_contact_plan_entry_t *first = NULL;
+    time_t valid_until = 0;
+    for (uint32_t n = dest; n != local; n = first->from) {
+        first = s->via[n];
+        if (valid_until == 0 || first->end < valid_until) valid_until = first->end;
+    }
+
+    char next_hop[32];
+    snprintf(next_hop, sizeof(next_hop), "ipn:%llu.0", (unsigned long long)bp_contact_plan_node_id(first->to));
+    memset(route, 0, sizeof(bp_route_t));
+    route->dest_eid = strdup(dest_eid);
+    route->next_hop = strdup(next_hop);
+    if (!route->dest_eid || !route->next_hop) {
+        free(route->dest_eid);
+        free(route->next_hop);
+        return BP_ERROR_MEMORY;
+    }
+
+    // Cost is the delivery latency in seconds; the route lasts as long as its shortest contact
+    route->cost = (uint32_t)(s->arrival[dest] - now);
+    route->confidence = 1.0f;
+    route->valid_until = valid_until;
+    *first_hop = first->to;
+    return BP_SUCCESS;
+}
+
+// Up to CGR_MAX_ROUTES routes over the shared contact plan, each through a different neighbor and
+// each over contacts with room left for bundle_size bytes
+static int cgr_compute_sized(const char *dest_eid, uint64_t bundle_size, bp_route_t **routes, int *route_count,
+                             void *context) {
+    (void)context;
+    uint64_t local_id, dest_id;
+    *routes = NULL;
+    *route_count = 0;
+    if (!bp_contact_plan_node_of(NULL, &local_id) || !bp_contact_plan_node_of(dest_eid, &dest_id)) return -1;
+
+    if (bp_contact_plan_read_lock() != BP_SUCCESS) return -1;
+    int64_t local = bp_contact_plan_node_index(local_id);
+    int64_t dest = bp_contact_plan_node_index(dest_id);
+    if (local < 0 || dest < 0 || local == dest) {
+        bp_contact_plan_unlock();
+        return 0;
+    }
+
+    uint32_t node_count = bp_contact_plan_node_count();
+    uint32_t local_first, local_last = bp_contact_plan_links((uint32_t)local, &local_first);
+    search_t s = {
+        .arrival = malloc(node_count * sizeof(time_t)),
+        .via = malloc(node_count * sizeof(bp_contact_plan_entry_t*)),
+        .settled = malloc(node_count),
+        .excluded = calloc(local_last > local_first ? local_last - local_first : 1, 1),
+    };
+    bp_route_t *found = malloc(CGR_MAX_ROUTES * sizeof(bp_route_t));
+    int result = s.arrival && s.via && s.settled && s.excluded && found ? BP_SUCCESS : BP_ERROR_MEMORY;
+
+    time_t now = time(NULL);
+    int count = 0;
+    while (result == BP_SUCCESS && count < CGR_MAX_ROUTES) {
+        if (search(&s, (uint32_t)local, (uint32_t)dest, now, bundle_size) != BP_SUCCESS) break;
+
+        uint32_t first_hop;
+        result = make_route(&s, (uint32_t)local, (uint32_t)dest, dest_eid, now, &found[count], &first_hop);
+        if (result != BP_SUCCESS) break;
+        count++;
+
+        for (uint32_t l = local_first; l < local_last; l++) {
+            if (bp_contact_plan_link_to(l) == first_hop) s.excluded[l - local_first] = 1;
+        }
+    }
+    bp_contact_plan_unlock();
+
+    free(s.arrival);
+    free(s.via);
+    free(s.settled);
+    free(s.excluded);
+    free(s.heap.items);
+
+    if (result != BP_SUCCESS || count == 0) {
+        if (count > 0) bp_route_list_destroy(found, count); else free(found);
+        return result == BP_SUCCESS ? 0 : -1;
+    }
+    *routes = found;
+    *route_count = count;
+    return 0;
+}
+
+static int cgr_compute(const char *dest_eid, bp_route_t **routes, int *route_count, void *context) {
+    return cgr_compute_sized(dest_eid, 0, routes, route_count, context);
+}
+
+// Fills in the callbacks of a routing created by bp_routing_create_cgr(). Contacts reach the
+// plan through bp_routing_update_contact(), the admin functions and bp_contact_plan_add_contact().
+void bp_cgr_init(bp_routing_t *routing) {
+    routing->compute_route = cgr_compute;
+    routing->compute_route_sized = cgr_compute_sized;
+}
\ No newline at end of file
@@ -3,131 +3,486 @@
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
+#include <limits.h>
 
 extern bp_context_t g_bp_context;
 
-static bp_cla_t *find_cla(const char *protocol_name) {
-    if (!protocol_name) return NULL;
-    
-    for (int i = 0; i < g_bp_context.clas.count; i++) {
-        if (strcmp(g_bp_context.clas.clas[i]->protocol_name, protocol_name) == 0) {
-            return g_bp_context.clas.clas[i];
-        }
+#define CLA_COALESCE_STACK 1024
+
+// receive_callback is optional: bp_cla_handle_bundle_receive() only counts bundles a CLA without one hands it
+static int validate_cla(bp_cla_t *cla) {
+    return cla && cla->protocol_name && (cla->send_callback || cla->send_iov_callback);
+}
+
+static size_t iov_length(const struct iovec *iov, int iovcnt) {
+    size_t len = 0;
+    for (int i = 0; i < iovcnt; i++) len += iov[i].iov_len;
+    return len;
+}
+
+// Registry item for a CLA: the caller's bp_cla_t plus what the SDK keeps alongside it. Senders
+// pin it with a reference so pacing and send callbacks run outside the RCU read section.
+typedef struct bp_cla_entry {
+    bp_cla_t *cla;
+    void *impl;
+    bp_stats_entity_t *stats;
+    bp_cla_sender_t *sender;
+    bp_cla_pacer_t *pacer;
+    int refs;
+    int removed;
+} cla_entry_t;
+
+// Unregistering waits here for the last reference to a removed entry to go
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t released;
+} g_cla_refs = { .lock = PTHREAD_MUTEX_INITIALIZER, .released = PTHREAD_COND_INITIALIZER };
+
+static __thread int t_refs_held;
+
+const char *bp_cla_entry_name(const void *item) {
+    return ((const cla_entry_t*)item)->cla->protocol_name;
+}
+
+static void free_entry(cla_entry_t *entry) {
+    if (!entry) return;
+    if (entry->sender) bp_cla_sender_destroy(entry->sender);
+    bp_cla_pacer_destroy(entry->pacer);
+    free(entry);
+}
+
+// Only valid inside the RCU read section the entry was found in
+static cla_entry_t *entry_get(cla_entry_t *entry) {
+    if (entry) {
+        __atomic_add_fetch(&entry->refs, 1, __ATOMIC_SEQ_CST);
+        t_refs_held++;
     }
-    return NULL;
+    return entry;
 }
 
-static int validate_cla(bp_cla_t *cla) {
-    return cla && cla->protocol_name && cla->send_callback && cla->receive_callback;
+void bp_cla_release(bp_cla_entry_t *entry) {
+    if (!entry) return;
+
+    t_refs_held--;
+    if (__atomic_sub_fetch(&entry->refs, 1, __ATOMIC_SEQ_CST) == 0 &&
+        __atomic_load_n(&entry->removed, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&g_cla_refs.lock);
+        pthread_cond_broadcast(&g_cla_refs.released);
+        pthread_mutex_unlock(&g_cla_refs.lock);
+    }
+}
+
+bp_cla_entry_t *bp_cla_acquire(const char *protocol_name) {
+    bp_rcu_read_lock();
+    cla_entry_t *entry = entry_get(bp_registry_find(&g_bp_context.clas, bp_registry_read(&g_bp_context.clas),
+                                                    protocol_name, NULL));
+    bp_rcu_read_unlock();
+    return entry;
+}
+
+// Called after the grace period, so no new reference can be taken; waits out the ones still held
+static void retire_entry(cla_entry_t *entry) {
+    if (!entry) return;
+
+    __atomic_store_n(&entry->removed, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_lock(&g_cla_refs.lock);
+    while (__atomic_load_n(&entry->refs, __ATOMIC_SEQ_CST) > 0) {
+        pthread_cond_wait(&g_cla_refs.released, &g_cla_refs.lock);
+    }
+    pthread_mutex_unlock(&g_cla_refs.lock);
+    free_entry(entry);
 }
 
 int bp_cla_register(bp_cla_t *cla) {
-    if (!validate_cla(cla) || !g_bp_context.initialized) 
+    return bp_cla_register_h(cla, NULL);
+}
+
+int bp_cla_register_h(bp_cla_t *cla, bp_cla_handle_t *handle) {
+    if (!validate_cla(cla) || (int)cla->queue_policy < 0 || cla->queue_policy > BP_CLA_QUEUE_DROP ||
+        !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    pthread_mutex_lock(&g_bp_context.mutex);
-    
-    if (find_cla(cla->protocol_name)) {
-        pthread_mutex_unlock(&g_bp_context.mutex);
-        return BP_ERROR_DUPLICATE;
+    // A built-in CLA starts receiving here, once the caller has set receive_callback and context
+    int result = bp_cla_start(cla);
+    if (result != BP_SUCCESS && result != BP_ERROR_NOT_FOUND) return result;
+
+    cla_entry_t *entry = malloc(sizeof(cla_entry_t));
+    if (!entry) return BP_ERROR_MEMORY;
+
+    entry->cla = cla;
+    entry->impl = bp_cla_get_impl(cla);
+    entry->stats = bp_stats_entity(BP_STATS_CLA, cla->protocol_name);
+    entry->sender = NULL;
+    entry->pacer = NULL;
+    entry->refs = 0;
+    entry->removed = 0;
+
+    result = bp_cla_pacer_create(cla->data_rate, cla->max_payload_size, &entry->pacer);
+    if (result != BP_SUCCESS) {
+        free(entry);
+        return result;
     }
 
-    int result = ensure_capacity((void***)&g_bp_context.clas.clas, 
-                               &g_bp_context.clas.capacity, 
-                               g_bp_context.clas.count, 
-                               sizeof(bp_cla_t*));
-    
-    if (result == BP_SUCCESS) {
-        g_bp_context.clas.clas[g_bp_context.clas.count++] = cla;
+    // A queue depth of 0 keeps sends synchronous on the caller's thread
+    if (cla->queue_depth > 0) {
+        result = bp_cla_sender_create(cla, entry->impl, entry->stats, entry->pacer, &entry->sender);
+        if (result != BP_SUCCESS) {
+            free_entry(entry);
+            return result;
+        }
     }
-    
-    pthread_mutex_unlock(&g_bp_context.mutex);
+
+    result = bp_registry_add(&g_bp_context.clas, entry, handle);
+    if (result != BP_SUCCESS) free_entry(entry);
     return result;
 }
 
+// Returns once no sender is still inside the CLA's callbacks; queued bundles are sent first. A thread
+// that is itself sending through a CLA, such as a send callback, gets BP_ERROR_PROTOCOL instead of
+// waiting on itself.
 int bp_cla_unregister(const char *protocol_name) {
     if (!protocol_name || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+    if (t_refs_held > 0) return BP_ERROR_PROTOCOL;
+
+    void *removed = NULL;
+    int result = bp_registry_remove(&g_bp_context.clas, protocol_name, NULL, &removed);
+    retire_entry(removed);
+    return result;
+}
+
+int bp_cla_unregister_h(bp_cla_handle_t handle) {
+    if (handle == BP_INVALID_HANDLE || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+    if (t_refs_held > 0) return BP_ERROR_PROTOCOL;
+
+    void *removed = NULL;
+    int result = bp_registry_remove_handle(&g_bp_context.clas, handle, &removed);
+    retire_entry(removed);
+    return result;
+}
+
+void bp_cla_unregister_all(void) {
+    for (;;) {
+        bp_rcu_read_lock();
+        const bp_snapshot_t *snapshot = bp_registry_read(&g_bp_context.clas);
+        cla_entry_t *entry = snapshot->count > 0 ? snapshot->items[0] : NULL;
+        bp_rcu_read_unlock();
+        if (!entry) break;
+
+        void *removed = NULL;
+        bp_registry_remove(&g_bp_context.clas, NULL, entry, &removed);
+        retire_entry(removed);
+    }
+}
+
+int bp_cla_lookup(const char *protocol_name, bp_cla_handle_t *handle) {
+    if (!protocol_name || !handle || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    pthread_mutex_lock(&g_bp_context.mutex);
+    bp_rcu_read_lock();
+    cla_entry_t *entry = bp_registry_find(&g_bp_context.clas, bp_registry_read(&g_bp_context.clas), protocol_name, handle);
+    bp_rcu_read_unlock();
     
-    for (int i = 0; i < g_bp_context.clas.count; i++) {
-        if (strcmp(g_bp_context.clas.clas[i]->protocol_name, protocol_name) == 0) {
-            memmove(&g_bp_context.clas.clas[i], 
-                   &g_bp_context.clas.clas[i + 1], 
-                   (g_bp_context.clas.count - i - 1) * sizeof(bp_cla_t*));
-            g_bp_context.clas.count--;
-            pthread_mutex_unlock(&g_bp_context.mutex);
-            return BP_SUCCESS;
+    return entry ? BP_SUCCESS : BP_ERROR_NOT_FOUND;
+}
+
+// CLAs without send_iov_callback get the vector coalesced into one buffer for send_callback
+static int deliver_coalesced(bp_cla_t *cla, void *context, const struct iovec *iov, int iovcnt, size_t len,
+                             const char *dest_addr) {
+    if (iovcnt == 1) return cla->send_callback(iov[0].iov_base, len, dest_addr, context);
+
+    char stack[CLA_COALESCE_STACK];
+    char *buffer = len <= sizeof(stack) ? stack : malloc(len);
+    if (!buffer) return -1;
+
+    // iovcnt is at least 2 here; copying the first element outside the loop lets GCC see the
+    // buffer written before send_callback reads it
+    memcpy(buffer, iov[0].iov_base, iov[0].iov_len);
+    size_t offset = iov[0].iov_len;
+    for (int i = 1; i < iovcnt; i++) {
+        memcpy(buffer + offset, iov[i].iov_base, iov[i].iov_len);
+        offset += iov[i].iov_len;
+    }
+
+    int result = cla->send_callback(buffer, len, dest_addr, context);
+    if (buffer != stack) free(buffer);
+    return result;
+}
+
+static int deliver_one(bp_cla_t *cla, void *context, const struct iovec *iov, int iovcnt, size_t len,
+                       const char *dest_addr) {
+    return cla->send_iov_callback ? 
+           cla->send_iov_callback(iov, iovcnt, dest_addr, context) : 
+           deliver_coalesced(cla, context, iov, iovcnt, len, dest_addr);
+}
+
+static int account(bp_stats_entity_t *stats, int result, size_t len) {
+    if (result != 0) {
+        bp_stats_add(BP_STAT_DELETED, 1);
+        bp_stats_entity_add(stats, BP_ENTITY_ERRORS, 1);
+        return BP_ERROR_PROTOCOL;
+    }
+
+    bp_stats_add(BP_STAT_FORWARDED, 1);
+    bp_stats_entity_add(stats, BP_ENTITY_SENT, 1);
+    bp_stats_entity_add(stats, BP_ENTITY_BYTES_SENT, len);
+    return BP_SUCCESS;
+}
+
+int bp_cla_deliver(bp_cla_t *cla, void *impl, bp_stats_entity_t *stats, const struct iovec *iov, int iovcnt,
+                   const char *dest_addr) {
+    size_t len = iov_length(iov, iovcnt);
+    return account(stats, deliver_one(cla, impl ? impl : cla->context, iov, iovcnt, len, dest_addr), len);
+}
+
+// Hands several bundles to send_batch_callback at once when the CLA has one; returns how many failed
+int bp_cla_deliver_batch(bp_cla_t *cla, void *impl, bp_stats_entity_t *stats, bp_cla_msg_t *msgs, int count) {
+    void *context = impl ? impl : cla->context;
+    if (cla->send_batch_callback && count > 1) {
+        for (int i = 0; i < count; i++) msgs[i].result = 0;
+        if (cla->send_batch_callback(msgs, count, context) != 0) {
+            for (int i = 0; i < count; i++) msgs[i].result = -1;
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            msgs[i].result = deliver_one(cla, context, msgs[i].iov, msgs[i].iovcnt, 
+                                                  iov_length(msgs[i].iov, msgs[i].iovcnt), msgs[i].dest);
         }
     }
-    
-    pthread_mutex_unlock(&g_bp_context.mutex);
-    return BP_ERROR_NOT_FOUND;
+
+    int failed = 0;
+    for (int i = 0; i < count; i++) {
+        if (account(stats, msgs[i].result, iov_length(msgs[i].iov, msgs[i].iovcnt)) != BP_SUCCESS) failed++;
+    }
+    return failed;
+}
+
+typedef struct {
+    cla_entry_t *entry;
+    const char *dest_addr;
+    bp_priority_t priority;
+} send_target_t;
+
+// Queued CLAs only copy the bundle into their ring here and are paced on the sender thread;
+// send failures there show up in the CLA's error counters. Synchronous CLAs are paced on the caller's thread.
+static int send_unit(const struct iovec *iov, int iovcnt, void *arg) {
+    send_target_t *target = (send_target_t*)arg;
+    cla_entry_t *entry = target->entry;
+
+    if (entry->sender) return bp_cla_sender_enqueue(entry->sender, iov, iovcnt, target->dest_addr, target->priority);
+    bp_cla_pacer_wait(entry->pacer, iov_length(iov, iovcnt), target->priority);
+    return bp_cla_deliver(entry->cla, entry->impl, entry->stats, iov, iovcnt, target->dest_addr);
+}
+
+// Caller holds a reference to entry. On a CLA with BP_CLA_FRAGMENT, bundles over its max_payload_size
+// go out as fragments, which the receiving SDK reassembles in bp_cla_handle_bundle_receive(); other
+// CLAs get every bundle whole.
+static int cla_send(cla_entry_t *entry, const char *dest_addr, const struct iovec *iov, int iovcnt,
+                    bp_priority_t priority) {
+    if (!entry) return BP_ERROR_NOT_FOUND;
+
+    send_target_t target = { entry, dest_addr, priority };
+    size_t len = iov_length(iov, iovcnt);
+    uint32_t max_payload = entry->cla->max_payload_size;
+    if (!(entry->cla->flags & BP_CLA_FRAGMENT) || max_payload == 0 || len <= max_payload)
+        return send_unit(iov, iovcnt, &target);
+    return bp_cla_fragment(iov, iovcnt, len, max_payload, send_unit, &target);
+}
+
+int bp_cla_validate_iov(const struct iovec *iov, int iovcnt) {
+    if (!iov || iovcnt <= 0 || iovcnt > IOV_MAX) return 0;
+
+    for (int i = 0; i < iovcnt; i++) {
+        if (!iov[i].iov_base && iov[i].iov_len > 0) return 0;
+    }
+    return iov_length(iov, iovcnt) > 0;
+}
+
+static int validate_priority(bp_priority_t priority) {
+    return (int)priority >= BP_PRIORITY_BULK && priority <= BP_PRIORITY_EXPEDITED;
+}
+
+bp_cla_t *bp_cla_entry_cla(bp_cla_entry_t *entry) {
+    return entry->cla;
+}
+
+// When a bundle of len bytes handed over now would be on the wire: queued bytes and pacer debt drain
+// at data_rate first. An unpaced CLA counts as the fastest link there can be.
+uint64_t bp_cla_entry_eta_ns(bp_cla_entry_t *entry, size_t len, bp_priority_t priority) {
+    uint32_t rate;
+    uint64_t backlog;
+    bp_cla_pacer_state(entry->pacer, priority, &rate, &backlog);
+    if (entry->sender) backlog += bp_cla_sender_backlog(entry->sender);
+    if (rate == 0) rate = UINT32_MAX;
+    return (uint64_t)((double)(backlog + len) * 1e9 / rate);
+}
+
+int bp_cla_entry_send(bp_cla_entry_t *entry, const char *dest_addr, const struct iovec *iov, int iovcnt,
+                      bp_priority_t priority) {
+    return cla_send(entry, dest_addr, iov, iovcnt, priority);
 }
 
 int bp_cla_send(const char *protocol_name, const char *dest_addr, const void *data, size_t len) {
     if (!protocol_name || !dest_addr || !data || len == 0 || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    pthread_mutex_lock(&g_bp_context.mutex);
-    bp_cla_t *cla = find_cla(protocol_name);
+    struct iovec iov = { .iov_base = (void*)data, .iov_len = len };
+    return bp_cla_sendv(protocol_name, dest_addr, &iov, 1);
+}
+
+int bp_cla_send_h(bp_cla_handle_t handle, const char *dest_addr, const void *data, size_t len) {
+    if (!dest_addr || !data || len == 0 || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    struct iovec iov = { .iov_base = (void*)data, .iov_len = len };
+    return bp_cla_sendv_h(handle, dest_addr, &iov, 1);
+}
+
+int bp_cla_sendv(const char *protocol_name, const char *dest_addr, const struct iovec *iov, int iovcnt) {
+    return bp_cla_sendv_priority(protocol_name, dest_addr, iov, iovcnt, BP_PRIORITY_STANDARD);
+}
+
+int bp_cla_sendv_priority(const char *protocol_name, const char *dest_addr, const struct iovec *iov, int iovcnt,
+                          bp_priority_t priority) {
+    if (!protocol_name || !dest_addr || !bp_cla_validate_iov(iov, iovcnt) || !validate_priority(priority) ||
+        !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    cla_entry_t *entry = bp_cla_acquire(protocol_name);
+    int result = cla_send(entry, dest_addr, iov, iovcnt, priority);
+    bp_cla_release(entry);
     
-    if (!cla) {
-        pthread_mutex_unlock(&g_bp_context.mutex);
-        return BP_ERROR_NOT_FOUND;
+    return result;
+}
+
+int bp_cla_sendv_h(bp_cla_handle_t handle, const char *dest_addr, const struct iovec *iov, int iovcnt) {
+    if (!dest_addr || !bp_cla_validate_iov(iov, iovcnt) || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    bp_rcu_read_lock();
+    cla_entry_t *entry = entry_get(bp_registry_get(bp_registry_read(&g_bp_context.clas), handle));
+    bp_rcu_read_unlock();
+
+    int result = cla_send(entry, dest_addr, iov, iovcnt, BP_PRIORITY_STANDARD);
+    bp_cla_release(entry);
+    
+    return result;
+}
+
+int bp_cla_queue_stats(const char *protocol_name, bp_cla_queue_stats_t *stats) {
+    if (!protocol_name || !stats || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    memset(stats, 0, sizeof(bp_cla_queue_stats_t));
+
+    bp_rcu_read_lock();
+    cla_entry_t *entry = bp_registry_find(&g_bp_context.clas, bp_registry_read(&g_bp_context.clas), protocol_name, NULL);
+    if (entry && entry->sender) bp_cla_sender_stats(entry->sender, stats);
+    bp_rcu_read_unlock();
+    
+    return entry ? BP_SUCCESS : BP_ERROR_NOT_FOUND;
+}
+
+// Takes effect on the next bundle, including ones already queued; data_rate is in bytes per second
+int bp_cla_set_rate(const char *protocol_name, uint32_t data_rate) {
+    if (!protocol_name || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    bp_rcu_read_lock();
+    cla_entry_t *entry = bp_registry_find(&g_bp_context.clas, bp_registry_read(&g_bp_context.clas), protocol_name, NULL);
+    if (entry) {
+        bp_cla_pacer_set_rate(entry->pacer, data_rate);
+        entry->cla->data_rate = data_rate;
     }
+    bp_rcu_read_unlock();
+    
+    return entry ? BP_SUCCESS : BP_ERROR_NOT_FOUND;
+}
+
+// A burst of 0 restores the default for that priority
+int bp_cla_set_burst(const char *protocol_name, bp_priority_t priority, uint32_t burst_bytes) {
+    if (!protocol_name || !validate_priority(priority) || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    int result = cla->send_callback(data, len, dest_addr, cla->context);
-    pthread_mutex_unlock(&g_bp_context.mutex);
+    bp_rcu_read_lock();
+    cla_entry_t *entry = bp_registry_find(&g_bp_context.clas, bp_registry_read(&g_bp_context.clas), protocol_name, NULL);
+    if (entry) bp_cla_pacer_set_burst(entry->pacer, priority, burst_bytes);
+    bp_rcu_read_unlock();
     
-    return (result == 0) ? BP_SUCCESS : BP_ERROR_PROTOCOL;
+    return entry ? BP_SUCCESS : BP_ERROR_NOT_FOUND;
 }
 
 int bp_cla_list(char ***protocol_names, int *count) {
     if (!protocol_names || !count || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    pthread_mutex_lock(&g_bp_context.mutex);
+    bp_rcu_read_lock();
+    const bp_snapshot_t *snapshot = bp_registry_read(&g_bp_context.clas);
     
-    *count = g_bp_context.clas.count;
+    *count = snapshot->count;
     if (*count == 0) {
         *protocol_names = NULL;
-        pthread_mutex_unlock(&g_bp_context.mutex);
+        bp_rcu_read_unlock();
         return BP_SUCCESS;
     }
 
     *protocol_names = malloc(*count * sizeof(char*));
     if (!*protocol_names) {
-        pthread_mutex_unlock(&g_bp_context.mutex);
+        bp_rcu_read_unlock();
         return BP_ERROR_MEMORY;
     }
 
     for (int i = 0; i < *count; i++) {
-        (*protocol_names)[i] = strdup(g_bp_context.clas.clas[i]->protocol_name);
+        (*protocol_names)[i] = strdup(bp_cla_entry_name(snapshot->items[i]));
         if (!(*protocol_names)[i]) {
             // Cleanup on failure
             for (int j = 0; j < i; j++) free((*protocol_names)[j]);
             free(*protocol_names);
-            pthread_mutex_unlock(&g_bp_context.mutex);
+            bp_rcu_read_unlock();
             return BP_ERROR_MEMORY;
         }
     }
 
-    pthread_mutex_unlock(&g_bp_context.mutex);
+    bp_rcu_read_unlock();
     return BP_SUCCESS;
 }
 
-static bp_cla_t *create_cla_base(const char *protocol, const char *addr, uint16_t port, 
-                                uint32_t max_payload, uint32_t rate) {
-    bp_cla_t *cla = malloc(sizeof(bp_cla_t));
-    if (!cla) return NULL;
+// Built-in CLAs are allocated inside a container that also owns their transport state, which their
+// send callbacks get in place of the caller's context
+typedef struct cla_container {
+    bp_cla_t cla;
+    void *impl;
+    int (*start)(void *impl);
+    void (*release)(void *impl);
+    int started;
+    struct cla_container *next;
+} cla_container_t;
+
+// Live containers, so any bp_cla_t can be told apart from a caller's own without looking past it
+static struct {
+    pthread_mutex_t lock;
+    cla_container_t *head;
+} g_containers = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+// Caller holds g_containers.lock
+static cla_container_t *container_find(bp_cla_t *cla) {
+    cla_container_t *container = g_containers.head;
+    while (container && &container->cla != cla) container = container->next;
+    return container;
+}
+
+bp_cla_t *bp_cla_create_base(const char *protocol, const char *addr, uint16_t port, 
+                             uint32_t max_payload, uint32_t rate) {
+    cla_container_t *container = malloc(sizeof(cla_container_t));
+    if (!container) return NULL;
 
-    memset(cla, 0, sizeof(bp_cla_t));
+    memset(container, 0, sizeof(cla_container_t));
+    bp_cla_t *cla = &container->cla;
     
     cla->protocol_name = strdup(protocol);
     if (!cla->protocol_name) {
-        free(cla);
+        free(container);
         return NULL;
     }
 
@@ -136,36 +491,67 @@ static bp_cla_t *create_cla_base(const char *protocol, const char *addr, uint16_
     cla->local_address = strdup(addr_str);
     if (!cla->local_address) {
         free(cla->protocol_name);
-        free(cla);
+        free(container);
         return NULL;
     }
 
     cla->max_payload_size = max_payload;
     cla->data_rate = rate;
+
+    pthread_mutex_lock(&g_containers.lock);
+    container->next = g_containers.head;
+    g_containers.head = container;
+    pthread_mutex_unlock(&g_containers.lock);
     return cla;
 }
 
-int bp_cla_create_tcp(const char *local_addr, uint16_t local_port, bp_cla_t **cla) {
-    if (!local_addr || !cla) return BP_ERROR_INVALID_ARGS;
-    
-    *cla = create_cla_base("tcp", local_addr, local_port, 65536, 1000000);
-    return *cla ? BP_SUCCESS : BP_ERROR_MEMORY;
+void bp_cla_set_impl(bp_cla_t *cla, void *impl, int (*start)(void *impl), void (*release)(void *impl)) {
+    cla_container_t *container = (cla_container_t*)cla;
+    container->impl = impl;
+    container->start = start;
+    container->release = release;
 }
 
-int bp_cla_create_udp(const char *local_addr, uint16_t local_port, bp_cla_t **cla) {
-    if (!local_addr || !cla) return BP_ERROR_INVALID_ARGS;
-    
-    *cla = create_cla_base("udp", local_addr, local_port, 1472, 1000000);
-    return *cla ? BP_SUCCESS : BP_ERROR_MEMORY;
+void *bp_cla_get_impl(bp_cla_t *cla) {
+    pthread_mutex_lock(&g_containers.lock);
+    cla_container_t *container = container_find(cla);
+    void *impl = container ? container->impl : NULL;
+    pthread_mutex_unlock(&g_containers.lock);
+    return impl;
+}
+
+// Receive threads only start once the caller is done setting receive_callback and context
+int bp_cla_start(bp_cla_t *cla) {
+    if (!cla) return BP_ERROR_INVALID_ARGS;
+
+    pthread_mutex_lock(&g_containers.lock);
+    cla_container_t *container = container_find(cla);
+    int result = container ? BP_SUCCESS : BP_ERROR_NOT_FOUND;
+    if (container && !container->started && container->start) {
+        result = container->start(container->impl);
+        container->started = result == BP_SUCCESS;
+    }
+    pthread_mutex_unlock(&g_containers.lock);
+    return result;
 }
 
+// Only for CLAs from bp_cla_create_*(); a registered CLA must be unregistered first
 int bp_cla_destroy(bp_cla_t *cla) {
     if (!cla) return BP_ERROR_INVALID_ARGS;
 
+    pthread_mutex_lock(&g_containers.lock);
+    cla_container_t **link = &g_containers.head;
+    while (*link && &(*link)->cla != cla) link = &(*link)->next;
+    if (*link) *link = (*link)->next;
+    pthread_mutex_unlock(&g_containers.lock);
+
+    cla_container_t *container = (cla_container_t*)cla;
+    if (container->release) container->release(container->impl);
+
     free(cla->protocol_name);
     free(cla->local_address);
     free(cla->remote_address);
-    free(cla);
+    free(container);
     return BP_SUCCESS;
 }
 
@@ -173,7 +559,30 @@ int bp_cla_handle_bundle_receive(bp_cla_t *cla, const void *data, size_t len, co
     if (!cla || !data || len == 0 || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    return cla->receive_callback ? 
-           cla->receive_callback((void*)data, len, (char*)source_eid, cla->context) : 
-           BP_SUCCESS;
+    // Only CLAs that opted in carry SDK framing; anything else is payload, whatever its first bytes.
+    // Fragments are held until their bundle is complete and only then counted and handed on.
+    void *bundle = NULL;
+    if ((cla->flags & BP_CLA_FRAGMENT) && bp_cla_is_fragment(data, len)) {
+        int result = bp_cla_reassemble(source_eid ? source_eid : "", data, len, &bundle, &len);
+        if (result != BP_SUCCESS || !bundle) return result;
+        data = bundle;
+    }
+
+    // Probes are answered or measured here and never reach receive_callback
+    if ((cla->flags & BP_CLA_PROBE) && bp_cla_is_probe(data, len)) {
+        int result = bp_cla_probe_receive(cla, data, len, source_eid);
+        free(bundle);
+        return result;
+    }
+
+    bp_stats_entity_t *stats = bp_stats_entity(BP_STATS_CLA, cla->protocol_name);
+    bp_stats_add(BP_STAT_RECEIVED, 1);
+    bp_stats_entity_add(stats, BP_ENTITY_RECEIVED, 1);
+    bp_stats_entity_add(stats, BP_ENTITY_BYTES_RECEIVED, len);
+
+    int result = cla->receive_callback ? 
+                 cla->receive_callback((void*)data, len, (char*)source_eid, cla->context) : 
+                 BP_SUCCESS;
+    free(bundle);
+    return result;
 } 
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include "bp_sdk_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+extern bp_context_t g_bp_context;
+
+#define BOND_MAX_MEMBERS 16
+#define BOND_ADDR_STACK 512
+
+typedef struct {
+    char *protocol_name;
+    char *dest_addr;
+} bond_member_t;
+
+// Registry item for a neighbor: immutable once published, so an update builds a new bond and
+// swaps it in with bp_registry_replace()
+typedef struct {
+    char *neighbor;
+    unsigned next;
+    int count;
+    bond_member_t members[];
+} cla_bond_t;
+
+// Serializes read-modify-write of a bond; senders only take the RCU read lock
+static pthread_mutex_t g_bond_lock = PTHREAD_MUTEX_INITIALIZER;
+
+const char *bp_cla_bond_name(const void *item) {
+    return ((const cla_bond_t*)item)->neighbor;
+}
+
+static void free_bond(cla_bond_t *bond) {
+    if (!bond) return;
+    for (int i = 0; i < bond->count; i++) {
+        free(bond->members[i].protocol_name);
+        free(bond->members[i].dest_addr);
+    }
+    free(bond->neighbor);
+    free(bond);
+}
+
+// Copies old's members except the one for skip_protocol, leaving room for one more
+static cla_bond_t *copy_bond(const char *neighbor, const cla_bond_t *old, const char *skip_protocol) {
+    int capacity = (old ? old->count : 0) + 1;
+    cla_bond_t *bond = calloc(1, sizeof(cla_bond_t) + capacity * sizeof(bond_member_t));
+    if (!bond) return NULL;
+
+    bond->neighbor = strdup(neighbor);
+    if (!bond->neighbor) {
+        free(bond);
+        return NULL;
+    }
+
+    for (int i = 0; old && i < old->count; i++) {
+        if (skip_protocol && strcmp(old->members[i].protocol_name, skip_protocol) == 0) continue;
+
+        bond_member_t *member = &bond->members[bond->count];
+        member->protocol_name = strdup(old->members[i].protocol_name);
+        member->dest_addr = strdup(old->members[i].dest_addr);
+        bond->count++;
+        if (!member->protocol_name || !member->dest_addr) {
+            free_bond(bond);
+            return NULL;
+        }
+    }
+    return bond;
+}
+
+static int publish_bond(cla_bond_t *old, cla_bond_t *bond) {
+    void *removed = NULL;
+    int result = old ? bp_registry_replace(&g_bp_context.bonds, old, bond, &removed) :
+                       bp_registry_add(&g_bp_context.bonds, bond, NULL);
+    if (result != BP_SUCCESS) {
+        free_bond(bond);
+        return result;
+    }
+    free_bond(removed);
+    return BP_SUCCESS;
+}
+
+// Adding a protocol the bond already has just moves it to the new destination address
+int bp_cla_bond_add(const char *neighbor, const char *protocol_name, const char *dest_addr) {
+    if (!neighbor || !protocol_name || !dest_addr || !g_bp_context.initialized)
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    pthread_mutex_lock(&g_bond_lock);
+    cla_bond_t *old = bp_registry_find(&g_bp_context.bonds, bp_registry_read(&g_bp_context.bonds), neighbor, NULL);
+    cla_bond_t *bond = copy_bond(neighbor, old, protocol_name);
+    if (!bond || bond->count >= BOND_MAX_MEMBERS) {
+        int result = bond ? BP_ERROR_INVALID_ARGS : BP_ERROR_MEMORY;
+        free_bond(bond);
+        pthread_mutex_unlock(&g_bond_lock);
+        return result;
+    }
+
+    bond_member_t *member = &bond->members[bond->count];
+    member->protocol_name = strdup(protocol_name);
+    member->dest_addr = strdup(dest_addr);
+    bond->count++;
+    if (!member->protocol_name || !member->dest_addr) {
+        free_bond(bond);
+        pthread_mutex_unlock(&g_bond_lock);
+        return BP_ERROR_MEMORY;
+    }
+
+    int result = publish_bond(old, bond);
+    pthread_mutex_unlock(&g_bond_lock);
+    return result;
+}
+
+// Removing the last member removes the bond
+int bp_cla_bond_remove(const char *neighbor, const char *protocol_name) {
+    if (!neighbor || !protocol_name || !g_bp_context.initialized)
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    pthread_mutex_lock(&g_bond_lock);
+    cla_bond_t *old = bp_registry_find(&g_bp_context.bonds, bp_registry_read(&g_bp_context.bonds), neighbor, NULL);
+    cla_bond_t *bond = old ? copy_bond(neighbor, old, protocol_name) : NULL;
+
+    int result;
+    if (!old) {
+        result = BP_ERROR_NOT_FOUND;
+    } else if (!bond) {
+        result = BP_ERROR_MEMORY;
+    } else if (bond->count == old->count) {
+        free_bond(bond);
+        result = BP_ERROR_NOT_FOUND;
+    } else if (bond->count == 0) {
+        free_bond(bond);
+        void *removed = NULL;
+        result = bp_registry_remove(&g_bp_context.bonds, NULL, old, &removed);
+        free_bond(removed);
+    } else {
+        result = publish_bond(old, bond);
+    }
+
+    pthread_mutex_unlock(&g_bond_lock);
+    return result;
+}
+
+void bp_cla_bond_remove_all(void) {
+    pthread_mutex_lock(&g_bond_lock);
+    for (;;) {
+        const bp_snapshot_t *snapshot = bp_registry_read(&g_bp_context.bonds);
+        if (!snapshot || snapshot->count == 0) break;
+
+        void *removed = NULL;
+        bp_registry_remove(&g_bp_context.bonds, NULL, snapshot->items[0], &removed);
+        free_bond(removed);
+    }
+    pthread_mutex_unlock(&g_bond_lock);
+}
+
+// What a send needs from a bond once it leaves the RCU read section: pinned CLA entries and
+// copies of the destination addresses
+typedef struct {
+    int count;
+    unsigned start;
+    bp_cla_entry_t *entries[BOND_MAX_MEMBERS];
+    const char *dest_addrs[BOND_MAX_MEMBERS];
+    char stack[BOND_ADDR_STACK];
+    char *addrs;
+} bond_route_t;
+
+static void route_release(bond_route_t *route) {
+    for (int i = 0; i < route->count; i++) bp_cla_release(route->entries[i]);
+    if (route->addrs != route->stack) free(route->addrs);
+}
+
+// Caller holds the RCU read lock
+static int route_pin(cla_bond_t *bond, bond_route_t *route) {
+    size_t total = 0;
+    for (int i = 0; i < bond->count; i++) total += strlen(bond->members[i].dest_addr) + 1;
+
+    route->count = 0;
+    route->addrs = total <= sizeof(route->stack) ? route->stack : malloc(total);
+    if (!route->addrs) return BP_ERROR_MEMORY;
+
+    char *next = route->addrs;
+    for (int i = 0; i < bond->count; i++) {
+        size_t len = strlen(bond->members[i].dest_addr) + 1;
+        memcpy(next, bond->members[i].dest_addr, len);
+        route->dest_addrs[i] = next;
+        route->entries[i] = bp_cla_acquire(bond->members[i].protocol_name);
+        next += len;
+    }
+    route->count = bond->count;
+    route->start = __atomic_fetch_add(&bond->next, 1, __ATOMIC_RELAXED);
+    return BP_SUCCESS;
+}
+
+// Earliest estimated completion wins, which weights members by data_rate and by what they already
+// have queued; the scan starts at a rotating member so equal links share the load. A member whose
+// send fails is skipped and the next best is tried.
+static int bond_send(bond_route_t *route, const struct iovec *iov, int iovcnt, size_t len) {
+    bp_cla_entry_t *entries[BOND_MAX_MEMBERS];
+    memcpy(entries, route->entries, route->count * sizeof(bp_cla_entry_t*));
+    int result = BP_ERROR_NOT_FOUND;
+
+    for (int attempt = 0; attempt < route->count; attempt++) {
+        int best = -1;
+        uint64_t best_eta = UINT64_MAX;
+        for (int n = 0; n < route->count; n++) {
+            int i = (int)((route->start + n) % route->count);
+            if (!entries[i]) continue;
+
+            uint64_t eta = bp_cla_entry_eta_ns(entries[i], len, BP_PRIORITY_STANDARD);
+            if (best < 0 || eta < best_eta) {
+                best = i;
+                best_eta = eta;
+            }
+        }
+        if (best < 0) break;
+
+        result = bp_cla_entry_send(entries[best], route->dest_addrs[best], iov, iovcnt, BP_PRIORITY_STANDARD);
+        if (result == BP_SUCCESS) break;
+        entries[best] = NULL;
+    }
+    return result;
+}
+
+int bp_cla_bond_send(const char *neighbor, const void *data, size_t len) {
+    if (!neighbor || !data || len == 0 || !g_bp_context.initialized)
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    struct iovec iov = { .iov_base = (void*)data, .iov_len = len };
+    return bp_cla_bond_sendv(neighbor, &iov, 1);
+}
+
+int bp_cla_bond_sendv(const char *neighbor, const struct iovec *iov, int iovcnt) {
+    if (!neighbor || !bp_cla_validate_iov(iov, iovcnt) || !g_bp_context.initialized)
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    size_t len = 0;
+    for (int i = 0; i < iovcnt; i++) len += iov[i].iov_len;
+
+    bond_route_t route;
+    bp_rcu_read_lock();
+    cla_bond_t *bond = bp_registry_find(&g_bp_context.bonds, bp_registry_read(&g_bp_context.bonds), neighbor, NULL);
+    int result = bond ? route_pin(bond, &route) : BP_ERROR_NOT_FOUND;
+    bp_rcu_read_unlock();
+    if (result != BP_SUCCESS) return result;
+
+    result = bond_send(&route, iov, iovcnt, len);
+    route_release(&route);
+    return result;
+}
+
+// Caller holds the RCU read lock
+void bp_cla_bond_foreach(bp_cla_bond_visit_t visit, void *arg) {
+    const bp_snapshot_t *snapshot = bp_registry_read(&g_bp_context.bonds);
+    for (int i = 0; snapshot && i < snapshot->count; i++) {
+        const cla_bond_t *bond = snapshot->items[i];
+        for (int m = 0; m < bond->count; m++) {
+            visit(bond->neighbor, bond->members[m].protocol_name, bond->members[m].dest_addr, arg);
+        }
+    }
+}
\ No newline at end of file
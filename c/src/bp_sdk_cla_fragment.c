@@ -0,0 +1,329 @@
+#include "bp_sdk_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+
+#define FRAGMENT_HEADER 28
+#define REASSEMBLY_BUCKETS 1024
+#define REASSEMBLY_DEFAULT_MEMORY (64u * 1024 * 1024)
+#define REASSEMBLY_DEFAULT_TIMEOUT_MS 30000
+
+static const uint8_t fragment_magic[4] = { 0xBF, 'F', 'R', 'G' };
+
+// Fragment header, big-endian: magic, creation msec (8), creation count (4), total length (4),
+// offset (4), stride (4). Every fragment but the last carries exactly stride bytes, so a fragment's
+// index is offset / stride and reassembly tracks arrivals in a bitmap.
+typedef struct partial {
+    struct partial *hash_next;
+    struct partial *older;
+    struct partial *newer;
+    uint64_t hash;
+    uint64_t msec;
+    uint32_t count;
+    uint32_t total;
+    uint32_t stride;
+    uint32_t fragments;
+    uint32_t received;
+    uint64_t deadline_ns;
+    uint8_t *seen;
+    char *data;
+    char source[];
+} partial_t;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_once_t once;
+    partial_t *buckets[REASSEMBLY_BUCKETS];
+    partial_t *oldest;
+    partial_t *newest;
+    size_t memory;
+    size_t memory_limit;
+    uint32_t timeout_ms;
+    uint32_t pending;
+    uint32_t next_count;
+    uint64_t completed;
+    uint64_t expired;
+    uint64_t evicted;
+    uint64_t malformed;
+} g_reassembly = { .lock = PTHREAD_MUTEX_INITIALIZER, .once = PTHREAD_ONCE_INIT,
+                   .memory_limit = REASSEMBLY_DEFAULT_MEMORY, .timeout_ms = REASSEMBLY_DEFAULT_TIMEOUT_MS };
+
+static void put_be32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24); p[1] = (uint8_t)(v >> 16); p[2] = (uint8_t)(v >> 8); p[3] = (uint8_t)v;
+}
+
+static uint32_t get_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// Seeded per process so two senders on one host do not start from the same creation count
+static void seed_count(void) {
+    g_reassembly.next_count = (uint32_t)(bp_stats_now_ns() ^ ((uint64_t)getpid() << 16));
+}
+
+static void next_timestamp(uint64_t *msec, uint32_t *count) {
+    pthread_once(&g_reassembly.once, seed_count);
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    *msec = (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+    *count = __atomic_fetch_add(&g_reassembly.next_count, 1, __ATOMIC_RELAXED);
+}
+
+// Slices the bundle into fragments of at most max_payload bytes, header included, and hands each to emit
+int bp_cla_fragment(const struct iovec *iov, int iovcnt, size_t len, uint32_t max_payload,
+                    bp_cla_fragment_fn emit, void *arg) {
+    if (max_payload <= FRAGMENT_HEADER || len > UINT32_MAX) return BP_ERROR_INVALID_ARGS;
+
+    struct iovec *frag = malloc((iovcnt + 1) * sizeof(struct iovec));
+    if (!frag) return BP_ERROR_MEMORY;
+
+    uint8_t header[FRAGMENT_HEADER];
+    uint64_t msec;
+    uint32_t count;
+    uint32_t stride = max_payload - FRAGMENT_HEADER;
+    next_timestamp(&msec, &count);
+
+    memcpy(header, fragment_magic, 4);
+    put_be32(header + 4, (uint32_t)(msec >> 32));
+    put_be32(header + 8, (uint32_t)msec);
+    put_be32(header + 12, count);
+    put_be32(header + 16, (uint32_t)len);
+    put_be32(header + 24, stride);
+    frag[0].iov_base = header;
+    frag[0].iov_len = FRAGMENT_HEADER;
+
+    // (index, skip) is where the next fragment starts within the caller's vector
+    int index = 0;
+    size_t skip = 0;
+    int result = BP_SUCCESS;
+
+    for (size_t offset = 0; offset < len && result == BP_SUCCESS; offset += stride) {
+        put_be32(header + 20, (uint32_t)offset);
+
+        size_t want = len - offset < stride ? len - offset : stride;
+        int n = 1;
+        while (want > 0) {
+            size_t avail = iov[index].iov_len - skip;
+            size_t take = avail < want ? avail : want;
+            if (take > 0) {
+                frag[n].iov_base = (char*)iov[index].iov_base + skip;
+                frag[n].iov_len = take;
+                n++;
+            }
+            want -= take;
+            skip += take;
+            if (skip == iov[index].iov_len) {
+                index++;
+                skip = 0;
+            }
+        }
+
+        result = emit(frag, n, arg);
+    }
+
+    free(frag);
+    return result;
+}
+
+int bp_cla_is_fragment(const void *data, size_t len) {
+    return len > FRAGMENT_HEADER && memcmp(data, fragment_magic, 4) == 0;
+}
+
+// Keyed on the peer's host only: a TCP peer may spread one bundle over pooled connections
+// whose ephemeral ports differ
+static size_t host_length(const char *source) {
+    const char *colon = strrchr(source, ':');
+    const char *bracket = strrchr(source, ']');
+    if (!colon || (bracket && colon < bracket)) return strlen(source);
+    return (size_t)(colon - source);
+}
+
+static uint64_t partial_hash(const char *source, size_t host_len, uint64_t msec, uint32_t count) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < host_len; i++) {
+        hash ^= (uint8_t)source[i];
+        hash *= 1099511628211ULL;
+    }
+    hash ^= msec;
+    hash *= 1099511628211ULL;
+    hash ^= count;
+    hash *= 1099511628211ULL;
+    return hash;
+}
+
+static void unlink_partial(partial_t *p) {
+    partial_t **link = &g_reassembly.buckets[p->hash % REASSEMBLY_BUCKETS];
+    while (*link != p) link = &(*link)->hash_next;
+    *link = p->hash_next;
+
+    if (p->older) p->older->newer = p->newer; else g_reassembly.oldest = p->newer;
+    if (p->newer) p->newer->older = p->older; else g_reassembly.newest = p->older;
+
+    g_reassembly.memory -= p->total;
+    g_reassembly.pending--;
+}
+
+static void free_partial(partial_t *p) {
+    free(p->data);
+    free(p->seen);
+    free(p);
+}
+
+static void drop_oldest(uint64_t *counter) {
+    partial_t *p = g_reassembly.oldest;
+    unlink_partial(p);
+    free_partial(p);
+    (*counter)++;
+    bp_stats_add(BP_STAT_DELETED, 1);
+}
+
+static partial_t *find_partial(uint64_t hash, const char *source, size_t host_len, uint64_t msec, uint32_t count) {
+    for (partial_t *p = g_reassembly.buckets[hash % REASSEMBLY_BUCKETS]; p; p = p->hash_next) {
+        if (p->hash == hash && p->msec == msec && p->count == count &&
+            strlen(p->source) == host_len && memcmp(p->source, source, host_len) == 0) return p;
+    }
+    return NULL;
+}
+
+// Oldest partial bundles make room for new ones; a bundle bigger than the whole budget is refused
+static partial_t *new_partial(uint64_t hash, const char *source, size_t host_len, uint64_t msec, uint32_t count,
+                              uint32_t total, uint32_t stride, uint64_t now) {
+    if (total > g_reassembly.memory_limit) return NULL;
+    while (g_reassembly.oldest && g_reassembly.memory + total > g_reassembly.memory_limit) {
+        drop_oldest(&g_reassembly.evicted);
+    }
+
+    partial_t *p = malloc(sizeof(partial_t) + host_len + 1);
+    if (!p) return NULL;
+    memset(p, 0, sizeof(partial_t));
+
+    p->fragments = (uint32_t)(((uint64_t)total + stride - 1) / stride);
+    p->data = malloc(total);
+    p->seen = calloc((p->fragments + 7) / 8, 1);
+    if (!p->data || !p->seen) {
+        free_partial(p);
+        return NULL;
+    }
+
+    memcpy(p->source, source, host_len);
+    p->source[host_len] = '\0';
+    p->hash = hash;
+    p->msec = msec;
+    p->count = count;
+    p->total = total;
+    p->stride = stride;
+    p->deadline_ns = now + (uint64_t)g_reassembly.timeout_ms * 1000000ULL;
+
+    size_t bucket = hash % REASSEMBLY_BUCKETS;
+    p->hash_next = g_reassembly.buckets[bucket];
+    g_reassembly.buckets[bucket] = p;
+    p->older = g_reassembly.newest;
+    if (g_reassembly.newest) g_reassembly.newest->newer = p; else g_reassembly.oldest = p;
+    g_reassembly.newest = p;
+
+    g_reassembly.memory += total;
+    g_reassembly.pending++;
+    return p;
+}
+
+// On BP_SUCCESS *bundle is the reassembled bundle once its last fragment is in (the caller frees it), NULL before then
+int bp_cla_reassemble(const char *source, const void *data, size_t len, void **bundle, size_t *bundle_len) {
+    const uint8_t *header = (const uint8_t*)data;
+    uint64_t msec = ((uint64_t)get_be32(header + 4) << 32) | get_be32(header + 8);
+    uint32_t count = get_be32(header + 12);
+    uint32_t total = get_be32(header + 16);
+    uint32_t offset = get_be32(header + 20);
+    uint32_t stride = get_be32(header + 24);
+    size_t payload = len - FRAGMENT_HEADER;
+
+    *bundle = NULL;
+    pthread_mutex_lock(&g_reassembly.lock);
+
+    if (stride == 0 || offset >= total || offset % stride != 0 ||
+        payload != (total - offset < stride ? total - offset : stride)) {
+        g_reassembly.malformed++;
+        pthread_mutex_unlock(&g_reassembly.lock);
+        return BP_ERROR_PROTOCOL;
+    }
+
+    uint64_t now = bp_stats_now_ns();
+    while (g_reassembly.oldest && g_reassembly.oldest->deadline_ns <= now) drop_oldest(&g_reassembly.expired);
+
+    size_t host_len = host_length(source);
+    uint64_t hash = partial_hash(source, host_len, msec, count);
+    partial_t *p = find_partial(hash, source, host_len, msec, count);
+    if (!p) {
+        p = new_partial(hash, source, host_len, msec, count, total, stride, now);
+        if (!p) {
+            pthread_mutex_unlock(&g_reassembly.lock);
+            return BP_ERROR_MEMORY;
+        }
+    } else if (p->total != total || p->stride != stride) {
+        g_reassembly.malformed++;
+        pthread_mutex_unlock(&g_reassembly.lock);
+        return BP_ERROR_PROTOCOL;
+    }
+
+    // Duplicates are ignored; fragments may arrive in any order
+    uint32_t index = offset / stride;
+    uint8_t bit = (uint8_t)(1u << (index & 7));
+    if (!(p->seen[index >> 3] & bit)) {
+        p->seen[index >> 3] |= bit;
+        memcpy(p->data + offset, header + FRAGMENT_HEADER, payload);
+        p->received++;
+    }
+
+    if (p->received == p->fragments) {
+        unlink_partial(p);
+        g_reassembly.completed++;
+        *bundle = p->data;
+        *bundle_len = p->total;
+        p->data = NULL;
+        free_partial(p);
+    }
+
+    pthread_mutex_unlock(&g_reassembly.lock);
+    return BP_SUCCESS;
+}
+
+void bp_cla_reassembly_clear(void) {
+    pthread_mutex_lock(&g_reassembly.lock);
+    while (g_reassembly.oldest) {
+        partial_t *p = g_reassembly.oldest;
+        unlink_partial(p);
+        free_partial(p);
+    }
+    pthread_mutex_unlock(&g_reassembly.lock);
+}
+
+// Tightening the budget evicts right away; a new timeout applies to bundles started afterwards
+int bp_cla_set_reassembly_limits(size_t memory_limit, uint32_t timeout_ms) {
+    if (memory_limit == 0 || timeout_ms == 0) return BP_ERROR_INVALID_ARGS;
+
+    pthread_mutex_lock(&g_reassembly.lock);
+    g_reassembly.memory_limit = memory_limit;
+    g_reassembly.timeout_ms = timeout_ms;
+    while (g_reassembly.oldest && g_reassembly.memory > g_reassembly.memory_limit) {
+        drop_oldest(&g_reassembly.evicted);
+    }
+    pthread_mutex_unlock(&g_reassembly.lock);
+    return BP_SUCCESS;
+}
+
+int bp_cla_reassembly_stats(bp_cla_reassembly_stats_t *stats) {
+    if (!stats) return BP_ERROR_INVALID_ARGS;
+
+    pthread_mutex_lock(&g_reassembly.lock);
+    stats->pending = g_reassembly.pending;
+    stats->memory = g_reassembly.memory;
+    stats->completed = g_reassembly.completed;
+    stats->expired = g_reassembly.expired;
+    stats->evicted = g_reassembly.evicted;
+    stats->malformed = g_reassembly.malformed;
+    pthread_mutex_unlock(&g_reassembly.lock);
+    return BP_SUCCESS;
+}
\ No newline at end of file
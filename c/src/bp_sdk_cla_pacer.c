@@ -0,0 +1,141 @@
+#include "bp_sdk_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+
+#define PACER_PRIORITIES 3
+#define PACER_DEFAULT_BURST_MS 10
+#define PACER_SPIN_NS 50000
+
+// Token bucket in bytes, refilled at data_rate bytes per second. A bundle of priority p may
+// start once the bucket holds at least (depth - burst[p]) tokens and then takes its full length,
+// possibly driving the bucket negative, so the long-run rate never exceeds data_rate while
+// higher priorities keep the headroom to burst past lower ones.
+struct bp_cla_pacer {
+    pthread_mutex_t lock;
+    uint32_t rate;
+    uint32_t max_payload;
+    uint32_t configured[PACER_PRIORITIES];
+    double burst[PACER_PRIORITIES];
+    double depth;
+    double tokens;
+    uint64_t last_ns;
+};
+
+// Unconfigured priorities get a multiple of PACER_DEFAULT_BURST_MS worth of data, and never less than one full payload
+static void apply_bursts(bp_cla_pacer_t *pacer) {
+    double base = (double)pacer->rate * PACER_DEFAULT_BURST_MS / 1000.0;
+    if (base < pacer->max_payload) base = pacer->max_payload;
+
+    const double scale[PACER_PRIORITIES] = { 0.5, 1.0, 2.0 };
+    pacer->depth = 0;
+    for (int p = 0; p < PACER_PRIORITIES; p++) {
+        pacer->burst[p] = pacer->configured[p] ? pacer->configured[p] : base * scale[p];
+        if (pacer->burst[p] > pacer->depth) pacer->depth = pacer->burst[p];
+    }
+    if (pacer->tokens > pacer->depth) pacer->tokens = pacer->depth;
+}
+
+static void refill(bp_cla_pacer_t *pacer, uint64_t now) {
+    if (now > pacer->last_ns) {
+        pacer->tokens += (double)(now - pacer->last_ns) * pacer->rate / 1e9;
+        if (pacer->tokens > pacer->depth) pacer->tokens = pacer->depth;
+    }
+    pacer->last_ns = now;
+}
+
+int bp_cla_pacer_create(uint32_t data_rate, uint32_t max_payload, bp_cla_pacer_t **pacer) {
+    bp_cla_pacer_t *p = malloc(sizeof(bp_cla_pacer_t));
+    if (!p) return BP_ERROR_MEMORY;
+    memset(p, 0, sizeof(bp_cla_pacer_t));
+
+    if (pthread_mutex_init(&p->lock, NULL) != 0) {
+        free(p);
+        return BP_ERROR_MEMORY;
+    }
+
+    p->rate = data_rate;
+    p->max_payload = max_payload;
+    apply_bursts(p);
+    p->tokens = p->depth;
+    p->last_ns = bp_stats_now_ns();
+
+    *pacer = p;
+    return BP_SUCCESS;
+}
+
+void bp_cla_pacer_destroy(bp_cla_pacer_t *pacer) {
+    if (!pacer) return;
+    pthread_mutex_destroy(&pacer->lock);
+    free(pacer);
+}
+
+// The bucket is settled at the old rate first, so the change applies from this instant on
+void bp_cla_pacer_set_rate(bp_cla_pacer_t *pacer, uint32_t data_rate) {
+    pthread_mutex_lock(&pacer->lock);
+    refill(pacer, bp_stats_now_ns());
+    pacer->rate = data_rate;
+    apply_bursts(pacer);
+    pthread_mutex_unlock(&pacer->lock);
+}
+
+void bp_cla_pacer_set_burst(bp_cla_pacer_t *pacer, bp_priority_t priority, uint32_t burst_bytes) {
+    pthread_mutex_lock(&pacer->lock);
+    refill(pacer, bp_stats_now_ns());
+    pacer->configured[priority] = burst_bytes;
+    apply_bursts(pacer);
+    pthread_mutex_unlock(&pacer->lock);
+}
+
+// backlog is how many bytes must drain before a bundle of this priority may start
+void bp_cla_pacer_state(bp_cla_pacer_t *pacer, bp_priority_t priority, uint32_t *data_rate, uint64_t *backlog) {
+    pthread_mutex_lock(&pacer->lock);
+    refill(pacer, bp_stats_now_ns());
+    double deficit = pacer->depth - pacer->burst[priority] - pacer->tokens;
+    *data_rate = pacer->rate;
+    *backlog = pacer->rate > 0 && deficit > 0 ? (uint64_t)deficit : 0;
+    pthread_mutex_unlock(&pacer->lock);
+}
+
+// Returns 0 once the bundle's tokens are taken, otherwise how many nanoseconds until it may go
+uint64_t bp_cla_pacer_take(bp_cla_pacer_t *pacer, size_t len, bp_priority_t priority) {
+    pthread_mutex_lock(&pacer->lock);
+    if (pacer->rate == 0) {
+        pthread_mutex_unlock(&pacer->lock);
+        return 0;
+    }
+
+    refill(pacer, bp_stats_now_ns());
+    double threshold = pacer->depth - pacer->burst[priority];
+    if (pacer->tokens >= threshold) {
+        pacer->tokens -= (double)len;
+        pthread_mutex_unlock(&pacer->lock);
+        return 0;
+    }
+
+    uint64_t wait_ns = (uint64_t)((threshold - pacer->tokens) * 1e9 / pacer->rate) + 1;
+    pthread_mutex_unlock(&pacer->lock);
+    return wait_ns;
+}
+
+// Sleeps most of the wait and yields through the last PACER_SPIN_NS, since timer slack alone
+// would overshoot microsecond-scale gaps
+static void sleep_until(uint64_t deadline_ns) {
+    uint64_t now = bp_stats_now_ns();
+    if (deadline_ns > now + PACER_SPIN_NS) {
+        uint64_t wake_ns = deadline_ns - PACER_SPIN_NS;
+        struct timespec ts = { (time_t)(wake_ns / 1000000000ULL), (long)(wake_ns % 1000000000ULL) };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {}
+    }
+    while (bp_stats_now_ns() < deadline_ns) sched_yield();
+}
+
+void bp_cla_pacer_wait(bp_cla_pacer_t *pacer, size_t len, bp_priority_t priority) {
+    uint64_t wait_ns;
+    while ((wait_ns = bp_cla_pacer_take(pacer, len, priority)) > 0) {
+        sleep_until(bp_stats_now_ns() + wait_ns);
+    }
+}
\ No newline at end of file
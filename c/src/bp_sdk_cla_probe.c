@@ -0,0 +1,435 @@
+#include "bp_sdk_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+extern bp_context_t g_bp_context;
+
+#define PROBE_HEADER 20
+#define PROBE_TRAIL_BYTES 1200
+#define PROBE_MAX_REPLY 255
+#define PROBE_ALPHA 0.25
+#define PROBE_DEAD_MISSES 3
+#define PROBE_REFERENCE_BYTES 16384
+
+static const uint8_t probe_magic[4] = { 0xBF, 'P', 'R', 'B' };
+
+// Probe header, big-endian: magic, type ('Q' or 'A'), part, reply_to length (2), sequence (4),
+// sender's clock (8), then reply_to. Each round sends a small lead probe and a trail padded to
+// PROBE_TRAIL_BYTES down every path; the peer answers both at once with bare headers. The lead's
+// answer gives RTT and loss, and the gap until the trail's answer how fast the path moves bytes.
+typedef struct probe_path {
+    struct probe_path *next;
+    char *neighbor;
+    char *protocol_name;
+    char *dest_addr;
+    uint32_t seq;
+    uint32_t data_rate;
+    int awaiting_lead;
+    int awaiting_trail;
+    uint64_t lead_ns;
+    int answered;
+    int misses;
+    int seen;
+    double srtt_ns;
+    double goodput;
+    double loss;
+    uint64_t sent;
+    uint64_t lost;
+} probe_path_t;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_once_t once;
+    pthread_cond_t wake;
+    pthread_t thread;
+    int running;
+    int stopping;
+    uint32_t interval_ms;
+    uint32_t next_seq;
+    probe_path_t *paths;
+} g_probe = { .lock = PTHREAD_MUTEX_INITIALIZER, .once = PTHREAD_ONCE_INIT };
+
+static void put_be16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8); p[1] = (uint8_t)v;
+}
+
+static void put_be32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24); p[1] = (uint8_t)(v >> 16); p[2] = (uint8_t)(v >> 8); p[3] = (uint8_t)v;
+}
+
+static void put_be64(uint8_t *p, uint64_t v) {
+    put_be32(p, (uint32_t)(v >> 32));
+    put_be32(p + 4, (uint32_t)v);
+}
+
+static uint16_t get_be16(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t get_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint64_t get_be64(const uint8_t *p) {
+    return ((uint64_t)get_be32(p) << 32) | get_be32(p + 4);
+}
+
+static double ewma(double average, double sample) {
+    return average + PROBE_ALPHA * (sample - average);
+}
+
+int bp_cla_is_probe(const void *data, size_t len) {
+    return len >= PROBE_HEADER && memcmp(data, probe_magic, 4) == 0;
+}
+
+static void free_path(probe_path_t *path) {
+    free(path->neighbor);
+    free(path->protocol_name);
+    free(path->dest_addr);
+    free(path);
+}
+
+static probe_path_t *find_path(const char *neighbor, const char *protocol_name, const char *dest_addr) {
+    for (probe_path_t *path = g_probe.paths; path; path = path->next) {
+        if (strcmp(path->neighbor, neighbor) == 0 && strcmp(path->protocol_name, protocol_name) == 0 &&
+            (!dest_addr || strcmp(path->dest_addr, dest_addr) == 0)) return path;
+    }
+    return NULL;
+}
+
+static int path_live(const probe_path_t *path) {
+    return path->answered && path->misses < PROBE_DEAD_MISSES;
+}
+
+// Expected seconds to deliver a reference bundle, inflated by the share that would be lost
+static double path_score(const probe_path_t *path) {
+    double seconds = path->srtt_ns / 2e9;
+    if (path->goodput > 0) seconds += PROBE_REFERENCE_BYTES / path->goodput;
+    double loss = path->loss < 0.99 ? path->loss : 0.99;
+    return seconds / (1.0 - loss);
+}
+
+// Runs under g_probe.lock inside the RCU read section of a round. Members whose CLA has not set
+// BP_CLA_PROBE are left alone, since their peer would take a probe for payload.
+static void visit_member(const char *neighbor, const char *protocol_name, const char *dest_addr, void *arg) {
+    (void)arg;
+    bp_cla_entry_t *entry = bp_cla_acquire(protocol_name);
+    int probing = !entry || (bp_cla_entry_cla(entry)->flags & BP_CLA_PROBE);
+    bp_cla_release(entry);
+    if (!probing) return;
+
+    probe_path_t *path = find_path(neighbor, protocol_name, dest_addr);
+    if (!path) {
+        path = calloc(1, sizeof(probe_path_t));
+        if (!path) return;
+        path->neighbor = strdup(neighbor);
+        path->protocol_name = strdup(protocol_name);
+        path->dest_addr = strdup(dest_addr);
+        if (!path->neighbor || !path->protocol_name || !path->dest_addr) {
+            free_path(path);
+            return;
+        }
+        path->next = g_probe.paths;
+        g_probe.paths = path;
+    }
+    path->seen = 1;
+}
+
+static void send_probe(bp_cla_entry_t *entry, const probe_path_t *path, uint8_t part) {
+    uint8_t packet[PROBE_HEADER + PROBE_MAX_REPLY + PROBE_TRAIL_BYTES];
+    const char *reply_to = bp_cla_entry_cla(entry)->local_address;
+    size_t reply_len = reply_to ? strlen(reply_to) : 0;
+    if (reply_len > PROBE_MAX_REPLY) reply_len = 0;
+
+    size_t len = PROBE_HEADER + reply_len;
+    if (part == 1 && len < PROBE_TRAIL_BYTES) len = PROBE_TRAIL_BYTES;
+    memset(packet, 0, len);
+
+    memcpy(packet, probe_magic, 4);
+    packet[4] = 'Q';
+    packet[5] = part;
+    put_be16(packet + 6, (uint16_t)reply_len);
+    put_be32(packet + 8, path->seq);
+    put_be64(packet + 12, bp_stats_now_ns());
+    memcpy(packet + PROBE_HEADER, reply_to, reply_len);
+
+    // Expedited, so a probe sees the path's queue and pacer without waiting behind bulk traffic
+    struct iovec iov = { .iov_base = packet, .iov_len = len };
+    bp_cla_entry_send(entry, path->dest_addr, &iov, 1, BP_PRIORITY_EXPEDITED);
+}
+
+// A lead still unanswered when the next round starts counts as lost. Paths follow the bonds:
+// members added since the last round start being probed, removed ones are dropped. Only this
+// thread frees paths, so it can send from them after releasing the lock.
+static void probe_round(void) {
+    pthread_mutex_lock(&g_probe.lock);
+    for (probe_path_t *path = g_probe.paths; path; path = path->next) {
+        if (path->awaiting_lead) {
+            path->loss = ewma(path->loss, 1.0);
+            path->misses++;
+            path->lost++;
+        }
+        path->awaiting_lead = path->awaiting_trail = 0;
+        path->seen = 0;
+    }
+
+    bp_rcu_read_lock();
+    bp_cla_bond_foreach(visit_member, NULL);
+    bp_rcu_read_unlock();
+
+    int count = 0;
+    for (probe_path_t **link = &g_probe.paths; *link;) {
+        probe_path_t *path = *link;
+        if (!path->seen) {
+            *link = path->next;
+            free_path(path);
+            continue;
+        }
+        path->seq = ++g_probe.next_seq;
+        path->awaiting_lead = path->awaiting_trail = 1;
+        path->lead_ns = 0;
+        path->sent++;
+        count++;
+        link = &path->next;
+    }
+
+    probe_path_t **round = count > 0 ? malloc(count * sizeof(probe_path_t*)) : NULL;
+    int n = 0;
+    for (probe_path_t *path = g_probe.paths; round && path; path = path->next) round[n++] = path;
+    pthread_mutex_unlock(&g_probe.lock);
+
+    // Unregistered CLAs are skipped, so their paths go dead after PROBE_DEAD_MISSES rounds
+    for (int i = 0; i < n; i++) {
+        bp_cla_entry_t *entry = bp_cla_acquire(round[i]->protocol_name);
+        if (!entry) continue;
+
+        __atomic_store_n(&round[i]->data_rate, bp_cla_entry_cla(entry)->data_rate, __ATOMIC_RELAXED);
+        send_probe(entry, round[i], 0);
+        send_probe(entry, round[i], 1);
+        bp_cla_release(entry);
+    }
+    free(round);
+}
+
+static void *prober_main(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_probe.lock);
+    while (!g_probe.stopping) {
+        pthread_mutex_unlock(&g_probe.lock);
+        probe_round();
+        pthread_mutex_lock(&g_probe.lock);
+
+        struct timespec deadline;
+        bp_deadline_after_ms(&deadline, (int)g_probe.interval_ms);
+        while (!g_probe.stopping && pthread_cond_timedwait(&g_probe.wake, &g_probe.lock, &deadline) != ETIMEDOUT) {}
+    }
+    pthread_mutex_unlock(&g_probe.lock);
+    return NULL;
+}
+
+typedef struct {
+    const char *protocol_name;
+    const char *dest_addr;
+    int found;
+} peer_match_t;
+
+static void match_member(const char *neighbor, const char *protocol_name, const char *dest_addr, void *arg) {
+    (void)neighbor;
+    peer_match_t *match = arg;
+    if (strcmp(protocol_name, match->protocol_name) == 0 && strcmp(dest_addr, match->dest_addr) == 0) match->found = 1;
+}
+
+static int known_peer(const char *protocol_name, const char *dest_addr) {
+    peer_match_t match = { protocol_name, dest_addr, 0 };
+    bp_rcu_read_lock();
+    bp_cla_bond_foreach(match_member, &match);
+    bp_rcu_read_unlock();
+    return match.found;
+}
+
+// Answers go to where the probe came from. The prober's reply_to, with an unspecified host filled
+// in from the source, is only followed when it names a bond member on this CLA, so a forged probe
+// cannot aim answers at an arbitrary host.
+static void reply_address(const bp_cla_t *cla, const char *reply_to, const char *source, char *out, size_t len) {
+    const char *colon = strrchr(reply_to, ':');
+    const char *source_colon = source ? strrchr(source, ':') : NULL;
+    if (colon && source_colon && (strncmp(reply_to, "0.0.0.0:", 8) == 0 || strncmp(reply_to, "[::]:", 5) == 0)) {
+        snprintf(out, len, "%.*s%s", (int)(source_colon - source), source, colon);
+    } else {
+        snprintf(out, len, "%s", reply_to);
+    }
+
+    if (!out[0] || !known_peer(cla->protocol_name, out)) snprintf(out, len, "%s", source ? source : "");
+}
+
+static void handle_answer(const uint8_t *packet) {
+    uint8_t part = packet[5];
+    uint32_t seq = get_be32(packet + 8);
+    uint64_t sent_ns = get_be64(packet + 12);
+    uint64_t now = bp_stats_now_ns();
+
+    pthread_mutex_lock(&g_probe.lock);
+    probe_path_t *path = g_probe.paths;
+    while (path && path->seq != seq) path = path->next;
+
+    if (path && part == 0 && path->awaiting_lead && now >= sent_ns) {
+        double rtt = (double)(now - sent_ns);
+        path->srtt_ns = path->answered ? ewma(path->srtt_ns, rtt) : rtt;
+        path->loss = ewma(path->loss, 0.0);
+        path->misses = 0;
+        path->answered = 1;
+        path->awaiting_lead = 0;
+        path->lead_ns = now;
+    } else if (path && part == 1 && path->awaiting_trail) {
+        // Without the lead's answer first there is no gap to measure
+        path->awaiting_trail = 0;
+        if (path->lead_ns && now > path->lead_ns) {
+            double goodput = PROBE_TRAIL_BYTES * 1e9 / (double)(now - path->lead_ns);
+            uint32_t rate = __atomic_load_n(&path->data_rate, __ATOMIC_RELAXED);
+            if (rate > 0 && goodput > rate) goodput = rate;
+            path->goodput = path->goodput > 0 ? ewma(path->goodput, goodput) : goodput;
+        }
+    }
+    pthread_mutex_unlock(&g_probe.lock);
+}
+
+// Called from bp_cla_handle_bundle_receive() on the CLA's receive path
+int bp_cla_probe_receive(bp_cla_t *cla, const void *data, size_t len, const char *source) {
+    const uint8_t *packet = data;
+    size_t reply_len = get_be16(packet + 6);
+    if (len < PROBE_HEADER + reply_len || reply_len > PROBE_MAX_REPLY) return BP_ERROR_PROTOCOL;
+
+    if (packet[4] == 'A') {
+        handle_answer(packet);
+        return BP_SUCCESS;
+    }
+    if (packet[4] != 'Q') return BP_ERROR_PROTOCOL;
+
+    char reply_to[PROBE_MAX_REPLY + 1];
+    memcpy(reply_to, packet + PROBE_HEADER, reply_len);
+    reply_to[reply_len] = '\0';
+
+    char dest[PROBE_MAX_REPLY + 1];
+    reply_address(cla, reply_to, source, dest, sizeof(dest));
+    if (!dest[0]) return BP_ERROR_PROTOCOL;
+
+    // Answered straight through the CLA, bypassing its queue, so the answer adds no delay of its own
+    uint8_t answer[PROBE_HEADER];
+    memcpy(answer, packet, PROBE_HEADER);
+    answer[4] = 'A';
+    put_be16(answer + 6, 0);
+    struct iovec iov = { .iov_base = answer, .iov_len = sizeof(answer) };
+    return bp_cla_deliver(cla, bp_cla_get_impl(cla), NULL, &iov, 1, dest);
+}
+
+static void init_cond(void) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_probe.wake, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+// Probes every bond member on a BP_CLA_PROBE CLA once per interval; peers answer from their own receive path.
+// Only bonded paths are probed: a CLA that is registered but in no bond gets no measurements.
+int bp_cla_probe_start(uint32_t interval_ms) {
+    if (interval_ms == 0 || interval_ms > INT32_MAX || !g_bp_context.initialized)
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    pthread_once(&g_probe.once, init_cond);
+
+    pthread_mutex_lock(&g_probe.lock);
+    if (g_probe.running) {
+        pthread_mutex_unlock(&g_probe.lock);
+        return BP_ERROR_DUPLICATE;
+    }
+
+    g_probe.interval_ms = interval_ms;
+    g_probe.stopping = 0;
+    if (pthread_create(&g_probe.thread, NULL, prober_main, NULL) != 0) {
+        pthread_mutex_unlock(&g_probe.lock);
+        return BP_ERROR_MEMORY;
+    }
+
+    g_probe.running = 1;
+    pthread_mutex_unlock(&g_probe.lock);
+    return BP_SUCCESS;
+}
+
+// Measurements are discarded, so a restarted prober learns every path afresh
+int bp_cla_probe_stop(void) {
+    pthread_mutex_lock(&g_probe.lock);
+    if (!g_probe.running || g_probe.stopping) {
+        pthread_mutex_unlock(&g_probe.lock);
+        return BP_ERROR_NOT_INITIALIZED;
+    }
+    g_probe.stopping = 1;
+    pthread_cond_broadcast(&g_probe.wake);
+    pthread_mutex_unlock(&g_probe.lock);
+
+    pthread_join(g_probe.thread, NULL);
+
+    pthread_mutex_lock(&g_probe.lock);
+    while (g_probe.paths) {
+        probe_path_t *path = g_probe.paths;
+        g_probe.paths = path->next;
+        free_path(path);
+    }
+    g_probe.running = 0;
+    pthread_mutex_unlock(&g_probe.lock);
+    return BP_SUCCESS;
+}
+
+// Picks the live path to dest with the lowest expected delivery time; the caller frees both strings
+int bp_cla_select(const char *dest, char **protocol_name, char **dest_addr) {
+    if (!dest || !protocol_name || !dest_addr || !g_bp_context.initialized)
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    pthread_mutex_lock(&g_probe.lock);
+    const probe_path_t *best = NULL;
+    double best_score = 0;
+    for (const probe_path_t *path = g_probe.paths; path; path = path->next) {
+        if (strcmp(path->neighbor, dest) != 0 || !path_live(path)) continue;
+
+        double score = path_score(path);
+        if (!best || score < best_score) {
+            best = path;
+            best_score = score;
+        }
+    }
+
+    int result = BP_ERROR_NOT_FOUND;
+    if (best) {
+        *protocol_name = strdup(best->protocol_name);
+        *dest_addr = strdup(best->dest_addr);
+        result = *protocol_name && *dest_addr ? BP_SUCCESS : BP_ERROR_MEMORY;
+        if (result != BP_SUCCESS) {
+            free(*protocol_name);
+            free(*dest_addr);
+        }
+    }
+    pthread_mutex_unlock(&g_probe.lock);
+    return result;
+}
+
+int bp_cla_path_stats(const char *dest, const char *protocol_name, bp_cla_path_stats_t *stats) {
+    if (!dest || !protocol_name || !stats || !g_bp_context.initialized)
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    pthread_mutex_lock(&g_probe.lock);
+    const probe_path_t *path = find_path(dest, protocol_name, NULL);
+    if (path) {
+        stats->rtt_us = (uint32_t)(path->srtt_ns / 1000);
+        stats->goodput = (uint64_t)path->goodput;
+        stats->loss = path->loss;
+        stats->probes_sent = path->sent;
+        stats->probes_lost = path->lost;
+        stats->live = path_live(path);
+    }
+    pthread_mutex_unlock(&g_probe.lock);
+
+    return path ? BP_SUCCESS : BP_ERROR_NOT_FOUND;
+}
\ No newline at end of file
@@ -0,0 +1,325 @@
+#include "bp_sdk_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define SENDER_SPIN 64
+#define SENDER_BATCH 64
+#define SENDER_IDLE_WAIT_MS 100
+
+typedef struct {
+    size_t len;
+    bp_priority_t priority;
+    char *dest;
+    char data[];
+} outbound_t;
+
+// Bounded MPMC ring (Vyukov) used with a single consumer. Each cell's sequence number says
+// whether it is free for the producer claiming position pos (seq == pos) or holds an item
+// ready for the consumer at pos (seq == pos + 1).
+typedef struct {
+    size_t seq;
+    outbound_t *item;
+} ring_cell_t;
+
+struct bp_cla_sender {
+    size_t enqueue_pos __attribute__((aligned(BP_CACHE_LINE)));
+    size_t dequeue_pos __attribute__((aligned(BP_CACHE_LINE)));
+    int sleeping;
+    int blocked;
+    int stopping;
+    uint64_t enqueued __attribute__((aligned(BP_CACHE_LINE)));
+    uint64_t dropped;
+    uint64_t send_errors;
+    uint64_t queued_bytes;
+    uint32_t high_watermark;
+    ring_cell_t *cells;
+    size_t mask;
+    uint32_t capacity;
+    bp_cla_queue_policy_t policy;
+    bp_cla_t *cla;
+    void *impl;
+    bp_stats_entity_t *stats;
+    bp_cla_pacer_t *pacer;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    pthread_t thread;
+};
+
+static int ring_push(bp_cla_sender_t *s, outbound_t *item) {
+    size_t pos = __atomic_load_n(&s->enqueue_pos, __ATOMIC_RELAXED);
+    for (;;) {
+        ring_cell_t *cell = &s->cells[pos & s->mask];
+        size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&s->enqueue_pos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                cell->item = item;
+                __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+                return 1;
+            }
+        } else if (diff < 0) {
+            return 0;
+        } else {
+            pos = __atomic_load_n(&s->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Only the sender thread pops, so no CAS is needed on dequeue_pos
+static outbound_t *ring_pop(bp_cla_sender_t *s) {
+    size_t pos = s->dequeue_pos;
+    ring_cell_t *cell = &s->cells[pos & s->mask];
+    if (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) != pos + 1) return NULL;
+
+    outbound_t *item = cell->item;
+    __atomic_store_n(&cell->seq, pos + s->mask + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&s->dequeue_pos, pos + 1, __ATOMIC_RELEASE);
+    return item;
+}
+
+static uint32_t ring_depth(bp_cla_sender_t *s) {
+    size_t tail = __atomic_load_n(&s->dequeue_pos, __ATOMIC_ACQUIRE);
+    size_t head = __atomic_load_n(&s->enqueue_pos, __ATOMIC_ACQUIRE);
+    return head > tail ? (uint32_t)(head - tail) : 0;
+}
+
+static void note_depth(bp_cla_sender_t *s) {
+    uint32_t depth = ring_depth(s);
+    uint32_t seen = __atomic_load_n(&s->high_watermark, __ATOMIC_RELAXED);
+    while (depth > seen &&
+           !__atomic_compare_exchange_n(&s->high_watermark, &seen, depth, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+// Sleep/wake handshake: each side publishes its flag before re-checking the ring, so either
+// the waiter sees the new state or the other side sees the flag and signals
+static void wake(int *flag, pthread_mutex_t *lock, pthread_cond_t *cond) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(flag, __ATOMIC_SEQ_CST)) return;
+
+    pthread_mutex_lock(lock);
+    pthread_cond_broadcast(cond);
+    pthread_mutex_unlock(lock);
+}
+
+static void deliver_run(bp_cla_sender_t *s, bp_cla_msg_t *msgs, int count) {
+    if (count == 0) return;
+    int failed = bp_cla_deliver_batch(s->cla, s->impl, s->stats, msgs, count);
+    if (failed > 0) __atomic_fetch_add(&s->send_errors, failed, __ATOMIC_RELAXED);
+}
+
+// Whatever is queued, up to SENDER_BATCH bundles, goes to the CLA in one bp_cla_deliver_batch() call,
+// split wherever the pacer holds a bundle back so the ones already admitted are not delayed with it
+static void *sender_main(void *arg) {
+    bp_cla_sender_t *s = (bp_cla_sender_t*)arg;
+    outbound_t *items[SENDER_BATCH];
+    struct iovec iov[SENDER_BATCH];
+    bp_cla_msg_t msgs[SENDER_BATCH];
+    int idle = 0;
+
+    for (;;) {
+        int n = 0;
+        while (n < SENDER_BATCH && (items[n] = ring_pop(s)) != NULL) n++;
+
+        if (n > 0) {
+            idle = 0;
+            wake(&s->blocked, &s->lock, &s->not_full);
+
+            for (int i = 0; i < n; i++) {
+                iov[i].iov_base = items[i]->data;
+                iov[i].iov_len = items[i]->len;
+                msgs[i].iov = &iov[i];
+                msgs[i].iovcnt = 1;
+                msgs[i].dest = items[i]->dest;
+            }
+
+            int start = 0;
+            for (int i = 0; i < n; i++) {
+                if (bp_cla_pacer_take(s->pacer, items[i]->len, items[i]->priority) == 0) continue;
+                deliver_run(s, msgs + start, i - start);
+                bp_cla_pacer_wait(s->pacer, items[i]->len, items[i]->priority);
+                start = i;
+            }
+            deliver_run(s, msgs + start, n - start);
+
+            size_t sent_bytes = 0;
+            for (int i = 0; i < n; i++) {
+                sent_bytes += items[i]->len;
+                free(items[i]);
+            }
+            __atomic_fetch_sub(&s->queued_bytes, sent_bytes, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        // Producers stop before bp_cla_sender_destroy() sets stopping, so an empty ring is final
+        if (__atomic_load_n(&s->stopping, __ATOMIC_ACQUIRE)) break;
+
+        if (++idle < SENDER_SPIN) {
+            sched_yield();
+            continue;
+        }
+
+        pthread_mutex_lock(&s->lock);
+        __atomic_store_n(&s->sleeping, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (ring_depth(s) == 0 && !__atomic_load_n(&s->stopping, __ATOMIC_SEQ_CST)) {
+            struct timespec deadline;
+            bp_deadline_after_ms(&deadline, SENDER_IDLE_WAIT_MS);
+            pthread_cond_timedwait(&s->not_empty, &s->lock, &deadline);
+        }
+        __atomic_store_n(&s->sleeping, 0, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&s->lock);
+        idle = 0;
+    }
+    return NULL;
+}
+
+static int init_sync(bp_cla_sender_t *s) {
+    pthread_condattr_t attr;
+    if (pthread_condattr_init(&attr) != 0) return BP_ERROR_MEMORY;
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+
+    int ok = pthread_mutex_init(&s->lock, NULL) == 0;
+    if (ok && pthread_cond_init(&s->not_empty, &attr) != 0) {
+        pthread_mutex_destroy(&s->lock);
+        ok = 0;
+    }
+    if (ok && pthread_cond_init(&s->not_full, &attr) != 0) {
+        pthread_cond_destroy(&s->not_empty);
+        pthread_mutex_destroy(&s->lock);
+        ok = 0;
+    }
+    pthread_condattr_destroy(&attr);
+    return ok ? BP_SUCCESS : BP_ERROR_MEMORY;
+}
+
+int bp_cla_sender_create(bp_cla_t *cla, void *impl, bp_stats_entity_t *stats, bp_cla_pacer_t *pacer,
+                         bp_cla_sender_t **sender) {
+    size_t capacity = 2;
+    while (capacity < cla->queue_depth) capacity *= 2;
+
+    bp_cla_sender_t *s;
+    if (posix_memalign((void**)&s, BP_CACHE_LINE, sizeof(bp_cla_sender_t)) != 0) return BP_ERROR_MEMORY;
+    memset(s, 0, sizeof(bp_cla_sender_t));
+
+    s->cells = malloc(capacity * sizeof(ring_cell_t));
+    if (!s->cells || init_sync(s) != BP_SUCCESS) {
+        free(s->cells);
+        free(s);
+        return BP_ERROR_MEMORY;
+    }
+    for (size_t i = 0; i < capacity; i++) s->cells[i].seq = i;
+
+    s->mask = capacity - 1;
+    s->capacity = (uint32_t)capacity;
+    s->policy = cla->queue_policy;
+    s->cla = cla;
+    s->impl = impl;
+    s->stats = stats;
+    s->pacer = pacer;
+
+    if (pthread_create(&s->thread, NULL, sender_main, s) != 0) {
+        pthread_cond_destroy(&s->not_full);
+        pthread_cond_destroy(&s->not_empty);
+        pthread_mutex_destroy(&s->lock);
+        free(s->cells);
+        free(s);
+        return BP_ERROR_MEMORY;
+    }
+
+    *sender = s;
+    return BP_SUCCESS;
+}
+
+static int push_or_wait(bp_cla_sender_t *s, outbound_t *item) {
+    for (int spin = 0; !ring_push(s, item); spin++) {
+        if (s->policy == BP_CLA_QUEUE_DROP) return 0;
+        if (spin < SENDER_SPIN) {
+            sched_yield();
+            continue;
+        }
+
+        pthread_mutex_lock(&s->lock);
+        __atomic_fetch_add(&s->blocked, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (ring_depth(s) >= s->capacity) {
+            struct timespec deadline;
+            bp_deadline_after_ms(&deadline, SENDER_IDLE_WAIT_MS);
+            pthread_cond_timedwait(&s->not_full, &s->lock, &deadline);
+        }
+        __atomic_fetch_sub(&s->blocked, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&s->lock);
+        spin = 0;
+    }
+    return 1;
+}
+
+// The caller's buffers are gathered into one queued copy, so they can be reused on return
+int bp_cla_sender_enqueue(bp_cla_sender_t *sender, const struct iovec *iov, int iovcnt, const char *dest,
+                          bp_priority_t priority) {
+    size_t len = 0;
+    for (int i = 0; i < iovcnt; i++) len += iov[i].iov_len;
+
+    size_t dest_len = strlen(dest) + 1;
+    outbound_t *item = malloc(sizeof(outbound_t) + len + dest_len);
+    if (!item) return BP_ERROR_MEMORY;
+
+    item->len = len;
+    item->priority = priority;
+    item->dest = item->data + len;
+    size_t offset = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        memcpy(item->data + offset, iov[i].iov_base, iov[i].iov_len);
+        offset += iov[i].iov_len;
+    }
+    memcpy(item->dest, dest, dest_len);
+
+    // Counted before the push so the sender thread never subtracts bytes not yet added
+    __atomic_fetch_add(&sender->queued_bytes, len, __ATOMIC_RELAXED);
+    if (!push_or_wait(sender, item)) {
+        __atomic_fetch_sub(&sender->queued_bytes, len, __ATOMIC_RELAXED);
+        free(item);
+        __atomic_fetch_add(&sender->dropped, 1, __ATOMIC_RELAXED);
+        bp_stats_add(BP_STAT_DELETED, 1);
+        bp_stats_entity_add(sender->stats, BP_ENTITY_ERRORS, 1);
+        return BP_ERROR_TIMEOUT;
+    }
+
+    __atomic_fetch_add(&sender->enqueued, 1, __ATOMIC_RELAXED);
+    note_depth(sender);
+    wake(&sender->sleeping, &sender->lock, &sender->not_empty);
+    return BP_SUCCESS;
+}
+
+// Callers guarantee no producer can still reach the sender; whatever is queued is sent first, still paced
+void bp_cla_sender_destroy(bp_cla_sender_t *sender) {
+    __atomic_store_n(&sender->stopping, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_lock(&sender->lock);
+    pthread_cond_broadcast(&sender->not_empty);
+    pthread_mutex_unlock(&sender->lock);
+
+    pthread_join(sender->thread, NULL);
+
+    pthread_cond_destroy(&sender->not_full);
+    pthread_cond_destroy(&sender->not_empty);
+    pthread_mutex_destroy(&sender->lock);
+    free(sender->cells);
+    free(sender);
+}
+
+void bp_cla_sender_stats(bp_cla_sender_t *sender, bp_cla_queue_stats_t *stats) {
+    stats->depth = ring_depth(sender);
+    stats->capacity = sender->capacity;
+    stats->high_watermark = __atomic_load_n(&sender->high_watermark, __ATOMIC_RELAXED);
+    stats->enqueued = __atomic_load_n(&sender->enqueued, __ATOMIC_RELAXED);
+    stats->dropped = __atomic_load_n(&sender->dropped, __ATOMIC_RELAXED);
+    stats->send_errors = __atomic_load_n(&sender->send_errors, __ATOMIC_RELAXED);
+}
+
+uint64_t bp_cla_sender_backlog(bp_cla_sender_t *sender) {
+    return __atomic_load_n(&sender->queued_bytes, __ATOMIC_RELAXED);
+}
\ No newline at end of file
@@ -0,0 +1,695 @@
+#include "bp_sdk_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#define SHM_RING_SIZE (8 * 1024 * 1024)
+#define SHM_MIN_RING_SIZE 4096
+#define SHM_MAX_PAYLOAD (1024 * 1024)
+#define SHM_RECORD_HEADER 8
+#define SHM_WRAP UINT32_MAX
+#define SHM_SOCKET_PREFIX "bp-shm-"
+#define SHM_EVENTS 64
+#define SHM_SPIN 256
+#define SHM_FULL_WAIT_MS 100
+#define SHM_DEFAULT_QUEUE_DEPTH 1024
+#define SHM_SEALS (F_SEAL_SHRINK | F_SEAL_GROW)
+
+// Shared by exactly one producer and one consumer process. Positions only grow; each side's
+// position and waiting flag share a cache line that only that side writes. Records are a
+// 4-byte length (plus 4 bytes of padding) followed by the bundle, 8-byte aligned; a record
+// that would cross the end of the ring is preceded by a SHM_WRAP marker.
+typedef struct {
+    uint64_t head __attribute__((aligned(BP_CACHE_LINE)));
+    uint32_t producer_waiting;
+    uint64_t tail __attribute__((aligned(BP_CACHE_LINE)));
+    uint32_t consumer_waiting;
+    uint32_t size __attribute__((aligned(BP_CACHE_LINE)));
+} shm_ring_t;
+
+#define SHM_DATA_OFFSET ((sizeof(shm_ring_t) + BP_CACHE_LINE - 1) & ~(size_t)(BP_CACHE_LINE - 1))
+
+typedef struct {
+    shm_ring_t *ring;
+    char *data;
+    size_t map_len;
+} shm_map_t;
+
+// Our ring towards one destination. The lock makes us its single producer even when the CLA
+// runs without a queue; a peer that hangs up is reconnected on the next send.
+typedef struct shm_peer {
+    char *dest;
+    pthread_mutex_t lock;
+    shm_map_t map;
+    int conn_fd;
+    int data_fd;
+    int space_fd;
+    struct shm_peer *next;
+} shm_peer_t;
+
+enum { SHM_TAG_LISTENER, SHM_TAG_STOP, SHM_TAG_CONN, SHM_TAG_DATA };
+
+struct shm_inbound;
+
+typedef struct {
+    int kind;
+    struct shm_inbound *inbound;
+} shm_tag_t;
+
+// A ring some other process writes into; only the receive thread touches these. Size and tail
+// are kept here, since the sender can rewrite anything in the mapping at any time.
+typedef struct shm_inbound {
+    shm_tag_t conn_tag;
+    shm_tag_t data_tag;
+    int conn_fd;
+    int data_fd;
+    int space_fd;
+    int closed;
+    shm_map_t map;
+    size_t size;
+    uint64_t tail;
+    char source[sizeof(((struct sockaddr_un*)0)->sun_path)];
+    struct shm_inbound *next;
+} shm_inbound_t;
+
+typedef struct {
+    bp_cla_t *cla;
+    char *name;
+    int listen_fd;
+    int epoll_fd;
+    int stop_fd;
+    shm_tag_t listener_tag;
+    shm_tag_t stop_tag;
+    int rx_started;
+    pthread_t rx_thread;
+    pthread_rwlock_t peers_lock;
+    shm_peer_t *peers;
+    shm_inbound_t *inbounds;
+} shm_cla_t;
+
+static size_t record_size(size_t len) {
+    return SHM_RECORD_HEADER + ((len + 7) & ~(size_t)7);
+}
+
+static int socket_address(const char *name, struct sockaddr_un *addr, socklen_t *addr_len) {
+    size_t len = strlen(name);
+    if (len == 0 || len + sizeof(SHM_SOCKET_PREFIX) > sizeof(addr->sun_path)) return -1;
+
+    // Abstract namespace: the leading NUL keeps the rendezvous out of the filesystem
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    memcpy(addr->sun_path + 1, SHM_SOCKET_PREFIX, sizeof(SHM_SOCKET_PREFIX) - 1);
+    memcpy(addr->sun_path + sizeof(SHM_SOCKET_PREFIX), name, len);
+    *addr_len = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + sizeof(SHM_SOCKET_PREFIX) + len);
+    return 0;
+}
+
+static void signal_fd(int fd) {
+    uint64_t one = 1;
+    if (write(fd, &one, sizeof(one)) < 0) {}
+}
+
+static void drain_fd(int fd) {
+    uint64_t value;
+    if (read(fd, &value, sizeof(value)) < 0) {}
+}
+
+static void unmap(shm_map_t *map) {
+    if (map->ring) munmap(map->ring, map->map_len);
+    map->ring = NULL;
+}
+
+static int map_ring(int memfd, shm_map_t *map) {
+    struct stat st;
+    if (fstat(memfd, &st) != 0 || (size_t)st.st_size <= SHM_DATA_OFFSET) return -1;
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (base == MAP_FAILED) return -1;
+
+    map->ring = (shm_ring_t*)base;
+    map->data = (char*)base + SHM_DATA_OFFSET;
+    map->map_len = (size_t)st.st_size;
+    return 0;
+}
+
+static void peer_disconnect(shm_peer_t *peer) {
+    unmap(&peer->map);
+    if (peer->conn_fd >= 0) close(peer->conn_fd);
+    if (peer->data_fd >= 0) close(peer->data_fd);
+    if (peer->space_fd >= 0) close(peer->space_fd);
+    peer->conn_fd = peer->data_fd = peer->space_fd = -1;
+}
+
+// Creates the ring and hands it, with both eventfds, to the destination over its rendezvous socket
+static int peer_connect(shm_cla_t *shm, shm_peer_t *peer) {
+    struct sockaddr_un addr;
+    socklen_t addr_len;
+    if (socket_address(peer->dest, &addr, &addr_len) != 0) return -1;
+
+    // Sealed against resizing, so the receiver can trust its mapping to stay backed
+    int memfd = memfd_create("bp-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memfd < 0) return -1;
+    if (ftruncate(memfd, SHM_DATA_OFFSET + SHM_RING_SIZE) != 0 || fcntl(memfd, F_ADD_SEALS, SHM_SEALS) != 0 ||
+        map_ring(memfd, &peer->map) != 0) {
+        close(memfd);
+        return -1;
+    }
+    peer->map.ring->size = SHM_RING_SIZE;
+
+    peer->data_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    peer->space_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    peer->conn_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (peer->data_fd < 0 || peer->space_fd < 0 || peer->conn_fd < 0 ||
+        connect(peer->conn_fd, (struct sockaddr*)&addr, addr_len) != 0) {
+        close(memfd);
+        peer_disconnect(peer);
+        return -1;
+    }
+
+    int fds[3] = { memfd, peer->data_fd, peer->space_fd };
+    char control[CMSG_SPACE(sizeof(fds))];
+    memset(control, 0, sizeof(control));
+    struct iovec iov = { .iov_base = shm->name, .iov_len = strlen(shm->name) };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(peer->conn_fd, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    close(memfd);
+
+    if (sent < 0) {
+        peer_disconnect(peer);
+        return -1;
+    }
+    return 0;
+}
+
+// Peers are never removed before the CLA is destroyed, so a pointer stays valid after the lock is dropped
+static shm_peer_t *get_peer(shm_cla_t *shm, const char *dest) {
+    pthread_rwlock_rdlock(&shm->peers_lock);
+    shm_peer_t *peer = shm->peers;
+    while (peer && strcmp(peer->dest, dest) != 0) peer = peer->next;
+    pthread_rwlock_unlock(&shm->peers_lock);
+    if (peer) return peer;
+
+    pthread_rwlock_wrlock(&shm->peers_lock);
+    for (peer = shm->peers; peer && strcmp(peer->dest, dest) != 0; peer = peer->next) {}
+    if (!peer) {
+        peer = calloc(1, sizeof(shm_peer_t));
+        if (peer && !(peer->dest = strdup(dest))) {
+            free(peer);
+            peer = NULL;
+        }
+        if (peer) {
+            pthread_mutex_init(&peer->lock, NULL);
+            peer->conn_fd = peer->data_fd = peer->space_fd = -1;
+            peer->next = shm->peers;
+            shm->peers = peer;
+        }
+    }
+    pthread_rwlock_unlock(&shm->peers_lock);
+    return peer;
+}
+
+static void publish(shm_peer_t *peer, uint64_t head) {
+    shm_ring_t *ring = peer->map.ring;
+    __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->consumer_waiting, __ATOMIC_SEQ_CST)) signal_fd(peer->data_fd);
+}
+
+// Publishes what is written so far, then sleeps until the consumer frees space; fails if it hung up
+static int wait_for_space(shm_peer_t *peer, uint64_t head, size_t needed) {
+    shm_ring_t *ring = peer->map.ring;
+    publish(peer, head);
+
+    for (;;) {
+        __atomic_store_n(&ring->producer_waiting, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (ring->size - (head - __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST)) >= needed) break;
+
+        struct pollfd fds[2] = {
+            { .fd = peer->space_fd, .events = POLLIN },
+            { .fd = peer->conn_fd, .events = POLLRDHUP }
+        };
+        if (poll(fds, 2, SHM_FULL_WAIT_MS) < 0 && errno != EINTR) break;
+        if (fds[1].revents & (POLLRDHUP | POLLHUP | POLLERR)) {
+            __atomic_store_n(&ring->producer_waiting, 0, __ATOMIC_RELAXED);
+            return -1;
+        }
+        if (fds[0].revents & POLLIN) drain_fd(peer->space_fd);
+    }
+
+    __atomic_store_n(&ring->producer_waiting, 0, __ATOMIC_RELAXED);
+    return 0;
+}
+
+// Copies one bundle into the ring at *head without publishing it
+static int write_record(shm_peer_t *peer, uint64_t *head, const struct iovec *iov, int iovcnt) {
+    shm_ring_t *ring = peer->map.ring;
+    size_t len = 0;
+    for (int i = 0; i < iovcnt; i++) len += iov[i].iov_len;
+    if (len > SHM_MAX_PAYLOAD) return -1;
+
+    size_t size = ring->size;
+    size_t index = *head & (size - 1);
+    size_t record = record_size(len);
+    size_t pad = size - index < record ? size - index : 0;
+
+    if (size - (*head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) < pad + record &&
+        wait_for_space(peer, *head, pad + record) != 0) return -1;
+
+    if (pad > 0) {
+        *(uint32_t*)(peer->map.data + index) = SHM_WRAP;
+        *head += pad;
+        index = 0;
+    }
+
+    char *slot = peer->map.data + index;
+    *(uint32_t*)slot = (uint32_t)len;
+    size_t offset = SHM_RECORD_HEADER;
+    for (int i = 0; i < iovcnt; i++) {
+        memcpy(slot + offset, iov[i].iov_base, iov[i].iov_len);
+        offset += iov[i].iov_len;
+    }
+    *head += record;
+    return 0;
+}
+
+static int lock_connected(shm_cla_t *shm, shm_peer_t *peer) {
+    pthread_mutex_lock(&peer->lock);
+    if (peer->map.ring) {
+        struct pollfd hup = { .fd = peer->conn_fd, .events = POLLRDHUP };
+        if (poll(&hup, 1, 0) <= 0) return 0;
+        peer_disconnect(peer);
+    }
+    if (peer_connect(shm, peer) == 0) return 0;
+
+    pthread_mutex_unlock(&peer->lock);
+    return -1;
+}
+
+static int shm_send_iov(const struct iovec *iov, int iovcnt, const char *dest, void *context) {
+    shm_cla_t *shm = (shm_cla_t*)context;
+    shm_peer_t *peer = get_peer(shm, dest);
+    if (!peer || lock_connected(shm, peer) != 0) return -1;
+
+    uint64_t head = peer->map.ring->head;
+    int result = write_record(peer, &head, iov, iovcnt);
+    publish(peer, head);
+    pthread_mutex_unlock(&peer->lock);
+    return result;
+}
+
+// Consecutive bundles for one destination are written under one lock and published with one wakeup
+static int shm_send_batch(bp_cla_msg_t *msgs, int count, void *context) {
+    shm_cla_t *shm = (shm_cla_t*)context;
+    int failed = 0;
+
+    for (int start = 0; start < count; ) {
+        int end = start + 1;
+        while (end < count && strcmp(msgs[end].dest, msgs[start].dest) == 0) end++;
+
+        shm_peer_t *peer = get_peer(shm, msgs[start].dest);
+        if (!peer || lock_connected(shm, peer) != 0) {
+            for (int i = start; i < end; i++) msgs[i].result = -1;
+            failed += end - start;
+            start = end;
+            continue;
+        }
+
+        uint64_t head = peer->map.ring->head;
+        for (int i = start; i < end; i++) {
+            msgs[i].result = write_record(peer, &head, msgs[i].iov, msgs[i].iovcnt);
+            if (msgs[i].result != 0) failed++;
+        }
+        publish(peer, head);
+        pthread_mutex_unlock(&peer->lock);
+        start = end;
+    }
+    return failed > 0 ? -1 : 0;
+}
+
+static int watch(shm_cla_t *shm, int fd, shm_tag_t *tag) {
+    struct epoll_event event = { .events = EPOLLIN, .data.ptr = tag };
+    return epoll_ctl(shm->epoll_fd, EPOLL_CTL_ADD, fd, &event);
+}
+
+// The eventfds are shared with the sending process, so closing them would not take them out of the epoll set
+static void inbound_free(shm_cla_t *shm, shm_inbound_t *in) {
+    unmap(&in->map);
+    epoll_ctl(shm->epoll_fd, EPOLL_CTL_DEL, in->conn_fd, NULL);
+    close(in->conn_fd);
+    if (in->data_fd >= 0) {
+        epoll_ctl(shm->epoll_fd, EPOLL_CTL_DEL, in->data_fd, NULL);
+        close(in->data_fd);
+    }
+    if (in->space_fd >= 0) close(in->space_fd);
+    free(in);
+}
+
+static void close_fds(int *fds, int count) {
+    for (int i = 0; i < count; i++) close(fds[i]);
+}
+
+// The first message on a new connection names the sender and carries its ring and eventfds
+static int inbound_handshake(shm_cla_t *shm, shm_inbound_t *in) {
+    int fds[3];
+    char control[CMSG_SPACE(sizeof(fds))];
+    struct iovec iov = { .iov_base = in->source, .iov_len = sizeof(in->source) - 1 };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t received = recvmsg(in->conn_fd, &msg, MSG_CMSG_CLOEXEC);
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+    if (received <= 0) return -1;
+    in->source[received] = '\0';
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) return -1;
+    int passed = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+    memcpy(fds, CMSG_DATA(cmsg), (passed < 3 ? passed : 3) * sizeof(int));
+    if (passed != 3 || msg.msg_flags & MSG_CTRUNC) {
+        close_fds(fds, passed < 3 ? passed : 3);
+        return -1;
+    }
+
+    // An unsealed ring could be truncated under us, and its size field is read once, here
+    int seals = fcntl(fds[0], F_GET_SEALS);
+    int mapped = seals >= 0 && (seals & SHM_SEALS) == SHM_SEALS ? map_ring(fds[0], &in->map) : -1;
+    close(fds[0]);
+    uint32_t size = mapped == 0 ? __atomic_load_n(&in->map.ring->size, __ATOMIC_RELAXED) : 0;
+    if (mapped != 0 || size < SHM_MIN_RING_SIZE || (size & (size - 1)) != 0 ||
+        in->map.map_len < SHM_DATA_OFFSET + size) {
+        unmap(&in->map);
+        close_fds(fds + 1, 2);
+        return -1;
+    }
+
+    in->size = size;
+    in->tail = __atomic_load_n(&in->map.ring->tail, __ATOMIC_RELAXED);
+    in->data_fd = fds[1];
+    in->space_fd = fds[2];
+    in->data_tag.kind = SHM_TAG_DATA;
+    in->data_tag.inbound = in;
+    return watch(shm, in->data_fd, &in->data_tag);
+}
+
+static void accept_all(shm_cla_t *shm) {
+    for (;;) {
+        int fd = accept4(shm->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+
+        // Abstract sockets carry no permissions, so only our own user may hand us a ring
+        struct ucred cred;
+        socklen_t cred_len = sizeof(cred);
+        if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) != 0 || cred.uid != geteuid()) {
+            close(fd);
+            continue;
+        }
+
+        shm_inbound_t *in = calloc(1, sizeof(shm_inbound_t));
+        if (!in) {
+            close(fd);
+            continue;
+        }
+        in->conn_fd = fd;
+        in->data_fd = in->space_fd = -1;
+        in->conn_tag.kind = SHM_TAG_CONN;
+        in->conn_tag.inbound = in;
+        if (watch(shm, fd, &in->conn_tag) != 0) {
+            inbound_free(shm, in);
+            continue;
+        }
+        in->next = shm->inbounds;
+        shm->inbounds = in;
+    }
+}
+
+// Bundles are handed on straight from the ring, so they are only valid during the callback.
+// Returns how many were delivered, or -1 if the ring is corrupt.
+static int drain_ring(shm_cla_t *shm, shm_inbound_t *in) {
+    shm_ring_t *ring = in->map.ring;
+    if (!ring) return 0;
+
+    size_t size = in->size;
+    uint64_t tail = in->tail;
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    if (head - tail > size) return -1;
+    int delivered = 0;
+
+    while (tail < head) {
+        size_t index = tail & (size - 1);
+        uint32_t len = *(volatile uint32_t*)(in->map.data + index);
+        if (len == SHM_WRAP) {
+            tail += size - index;
+        } else {
+            size_t record = record_size(len);
+            if (len == 0 || len > SHM_MAX_PAYLOAD || index + record > size || tail + record > head) return -1;
+            bp_cla_handle_bundle_receive(shm->cla, in->map.data + index + SHM_RECORD_HEADER, len, in->source);
+            tail += record;
+            delivered++;
+        }
+        in->tail = tail;
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    }
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (delivered > 0 && __atomic_load_n(&ring->producer_waiting, __ATOMIC_SEQ_CST)) signal_fd(in->space_fd);
+    return delivered;
+}
+
+static void drop_closed(shm_cla_t *shm) {
+    shm_inbound_t **link = &shm->inbounds;
+    while (*link) {
+        shm_inbound_t *in = *link;
+        if (!in->closed) {
+            link = &in->next;
+            continue;
+        }
+        *link = in->next;
+        inbound_free(shm, in);
+    }
+}
+
+static int drain_all(shm_cla_t *shm) {
+    int delivered = 0;
+    for (shm_inbound_t *in = shm->inbounds; in; in = in->next) {
+        int n = drain_ring(shm, in);
+        if (n < 0) in->closed = 1; else delivered += n;
+    }
+    return delivered;
+}
+
+// Before sleeping the thread sets every ring's waiting flag and looks once more, so a producer
+// either sees the flag and signals or its bundle is found here
+static int prepare_sleep(shm_cla_t *shm) {
+    for (shm_inbound_t *in = shm->inbounds; in; in = in->next) {
+        if (in->map.ring) __atomic_store_n(&in->map.ring->consumer_waiting, 1, __ATOMIC_SEQ_CST);
+    }
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    for (shm_inbound_t *in = shm->inbounds; in; in = in->next) {
+        shm_ring_t *ring = in->map.ring;
+        if (ring && __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) != in->tail) return 0;
+    }
+    return 1;
+}
+
+static void wake_up(shm_cla_t *shm) {
+    for (shm_inbound_t *in = shm->inbounds; in; in = in->next) {
+        if (in->map.ring) __atomic_store_n(&in->map.ring->consumer_waiting, 0, __ATOMIC_RELAXED);
+    }
+}
+
+// A closed connection still gets its ring drained, since the sender may have published before hanging up
+static void handle_conn(shm_cla_t *shm, shm_inbound_t *in) {
+    if (!in->map.ring) {
+        if (inbound_handshake(shm, in) != 0) in->closed = 1;
+        return;
+    }
+
+    char byte;
+    ssize_t n = recv(in->conn_fd, &byte, 1, MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        drain_ring(shm, in);
+        in->closed = 1;
+    }
+}
+
+static void *receive_main(void *arg) {
+    shm_cla_t *shm = (shm_cla_t*)arg;
+    struct epoll_event events[SHM_EVENTS];
+    int idle = 0;
+
+    for (;;) {
+        int delivered = drain_all(shm);
+        if (delivered > 0) idle = 0;
+
+        int timeout = 0;
+        if (delivered == 0 && ++idle >= SHM_SPIN) {
+            timeout = prepare_sleep(shm) ? -1 : 0;
+            idle = 0;
+        }
+
+        int n = epoll_wait(shm->epoll_fd, events, SHM_EVENTS, timeout);
+        if (timeout != 0) wake_up(shm);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (n == 0 && timeout == 0 && delivered == 0) sched_yield();
+
+        for (int i = 0; i < n; i++) {
+            shm_tag_t *tag = events[i].data.ptr;
+            if (tag->kind == SHM_TAG_STOP) return NULL;
+            if (tag->kind == SHM_TAG_LISTENER) accept_all(shm);
+            else if (tag->kind == SHM_TAG_DATA) drain_fd(tag->inbound->data_fd);
+            else handle_conn(shm, tag->inbound);
+        }
+        drop_closed(shm);
+    }
+    return NULL;
+}
+
+static void free_shm(shm_cla_t *shm) {
+    close(shm->listen_fd);
+    close(shm->epoll_fd);
+    close(shm->stop_fd);
+    pthread_rwlock_destroy(&shm->peers_lock);
+    free(shm->name);
+    free(shm);
+}
+
+static int shm_start(void *impl) {
+    shm_cla_t *shm = (shm_cla_t*)impl;
+    if (pthread_create(&shm->rx_thread, NULL, receive_main, shm) != 0) return BP_ERROR_MEMORY;
+    shm->rx_started = 1;
+    return BP_SUCCESS;
+}
+
+static void shm_release(void *impl) {
+    shm_cla_t *shm = (shm_cla_t*)impl;
+    if (!shm) return;
+
+    if (shm->rx_started) {
+        signal_fd(shm->stop_fd);
+        pthread_join(shm->rx_thread, NULL);
+    }
+
+    while (shm->inbounds) {
+        shm_inbound_t *in = shm->inbounds;
+        shm->inbounds = in->next;
+        inbound_free(shm, in);
+    }
+    while (shm->peers) {
+        shm_peer_t *peer = shm->peers;
+        shm->peers = peer->next;
+        peer_disconnect(peer);
+        pthread_mutex_destroy(&peer->lock);
+        free(peer->dest);
+        free(peer);
+    }
+    free_shm(shm);
+}
+
+static int open_rendezvous(shm_cla_t *shm) {
+    struct sockaddr_un addr;
+    socklen_t addr_len;
+    if (socket_address(shm->name, &addr, &addr_len) != 0) return BP_ERROR_INVALID_ARGS;
+
+    shm->listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (shm->listen_fd < 0) return BP_ERROR_PROTOCOL;
+    if (bind(shm->listen_fd, (struct sockaddr*)&addr, addr_len) != 0 || listen(shm->listen_fd, SOMAXCONN) != 0) {
+        close(shm->listen_fd);
+        return BP_ERROR_PROTOCOL;
+    }
+
+    shm->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    shm->stop_fd = eventfd(0, EFD_CLOEXEC);
+    shm->listener_tag.kind = SHM_TAG_LISTENER;
+    shm->stop_tag.kind = SHM_TAG_STOP;
+    if (shm->epoll_fd < 0 || shm->stop_fd < 0 ||
+        watch(shm, shm->listen_fd, &shm->listener_tag) != 0 || watch(shm, shm->stop_fd, &shm->stop_tag) != 0) {
+        if (shm->epoll_fd >= 0) close(shm->epoll_fd);
+        if (shm->stop_fd >= 0) close(shm->stop_fd);
+        close(shm->listen_fd);
+        return BP_ERROR_MEMORY;
+    }
+    return BP_SUCCESS;
+}
+
+// The name is both this CLA's address and what peers pass as dest; it must be unique on the host.
+// Bundles are copied once into the destination's ring and delivered from it without another copy.
+int bp_cla_create_shm(const char *name, bp_cla_t **cla) {
+    if (!name || !cla) return BP_ERROR_INVALID_ARGS;
+
+    shm_cla_t *shm = calloc(1, sizeof(shm_cla_t));
+    if (!shm) return BP_ERROR_MEMORY;
+
+    shm->name = strdup(name);
+    if (!shm->name || pthread_rwlock_init(&shm->peers_lock, NULL) != 0) {
+        free(shm->name);
+        free(shm);
+        return BP_ERROR_MEMORY;
+    }
+
+    int result = open_rendezvous(shm);
+    if (result != BP_SUCCESS) {
+        pthread_rwlock_destroy(&shm->peers_lock);
+        free(shm->name);
+        free(shm);
+        return result;
+    }
+
+    // Local delivery needs no pacing, so data_rate is 0
+    *cla = bp_cla_create_base("shm", name, 0, SHM_MAX_PAYLOAD, 0);
+    char *address = *cla ? strdup(name) : NULL;
+    if (!address) {
+        if (*cla) bp_cla_destroy(*cla);
+        *cla = NULL;
+        free_shm(shm);
+        return BP_ERROR_MEMORY;
+    }
+    free((*cla)->local_address);
+    (*cla)->local_address = address;
+
+    shm->cla = *cla;
+    (*cla)->send_iov_callback = shm_send_iov;
+    (*cla)->send_batch_callback = shm_send_batch;
+    (*cla)->queue_depth = SHM_DEFAULT_QUEUE_DEPTH;
+    (*cla)->queue_policy = BP_CLA_QUEUE_BLOCK;
+
+    // Peers can connect to the rendezvous right away; they are accepted once the receive thread starts
+    bp_cla_set_impl(*cla, shm, shm_start, shm_release);
+    return BP_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "bp_sdk_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// Accepts "a.b.c.d:port" and "[v6]:port"
+int bp_cla_parse_address(const char *text, int family, struct sockaddr_storage *addr, socklen_t *addr_len) {
+    char host[INET6_ADDRSTRLEN];
+    const char *colon = strrchr(text, ':');
+    if (!colon) return -1;
+
+    const char *start = text;
+    size_t host_len = colon - text;
+    if (*text == '[') {
+        if (host_len < 2 || colon[-1] != ']') return -1;
+        start = text + 1;
+        host_len -= 2;
+    }
+    if (host_len == 0 || host_len >= sizeof(host)) return -1;
+    memcpy(host, start, host_len);
+    host[host_len] = '\0';
+
+    char *end;
+    long port = strtol(colon + 1, &end, 10);
+    if (*end != '\0' || port <= 0 || port > 65535) return -1;
+
+    memset(addr, 0, sizeof(*addr));
+    if (family == AF_INET6) {
+        struct sockaddr_in6 *in6 = (struct sockaddr_in6*)addr;
+        in6->sin6_family = AF_INET6;
+        in6->sin6_port = htons((uint16_t)port);
+        if (inet_pton(AF_INET6, host, &in6->sin6_addr) != 1) return -1;
+        *addr_len = sizeof(struct sockaddr_in6);
+    } else {
+        struct sockaddr_in *in = (struct sockaddr_in*)addr;
+        in->sin_family = AF_INET;
+        in->sin_port = htons((uint16_t)port);
+        if (inet_pton(AF_INET, host, &in->sin_addr) != 1) return -1;
+        *addr_len = sizeof(struct sockaddr_in);
+    }
+    return 0;
+}
+
+void bp_cla_format_address(const struct sockaddr_storage *addr, char *text, size_t len) {
+    char host[INET6_ADDRSTRLEN] = "";
+    if (addr->ss_family == AF_INET6) {
+        const struct sockaddr_in6 *in6 = (const struct sockaddr_in6*)addr;
+        inet_ntop(AF_INET6, &in6->sin6_addr, host, sizeof(host));
+        snprintf(text, len, "[%s]:%u", host, ntohs(in6->sin6_port));
+    } else {
+        const struct sockaddr_in *in = (const struct sockaddr_in*)addr;
+        inet_ntop(AF_INET, &in->sin_addr, host, sizeof(host));
+        snprintf(text, len, "%s:%u", host, ntohs(in->sin_port));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,663 @@
+#include "bp_sdk_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define TCP_FRAME_HEADER 4
+#define TCP_MAX_FRAME (16 * 1024 * 1024)
+// A whole frame always fits behind a connection with nothing pending
+#define TCP_MAX_PENDING (TCP_FRAME_HEADER + TCP_MAX_FRAME)
+#define TCP_READ_CHUNK 65536
+#define TCP_PEER_BUCKETS 1024
+#define TCP_EVENTS 256
+#define TCP_BACKLOG 1024
+#define TCP_BATCH_MAX 64
+#define TCP_DEFAULT_QUEUE_DEPTH 1024
+
+struct tcp_cla;
+struct tcp_peer;
+
+// Bundles travel as a 4-byte big-endian length followed by the bundle. Output that the socket
+// does not take at once waits in out until the event loop sees EPOLLOUT.
+typedef struct tcp_conn {
+    int fd;
+    int listener;
+    int connecting;
+    int armed;
+    int loop;
+    int slot;
+    struct tcp_peer *peer;
+    char source[INET6_ADDRSTRLEN + 8];
+    char *out;
+    size_t out_off;
+    size_t out_len;
+    size_t out_cap;
+    char *in;
+    size_t in_len;
+    size_t in_cap;
+    struct tcp_conn *prev;
+    struct tcp_conn *next;
+} tcp_conn_t;
+
+// Outbound connections to one peer address. The lock covers every write to them and their removal,
+// so a sender never touches a connection the event loop is closing.
+typedef struct tcp_peer {
+    char *dest;
+    uint64_t hash;
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+    pthread_mutex_t lock;
+    unsigned next_slot;
+    tcp_conn_t **conns;
+    struct tcp_peer *next;
+} tcp_peer_t;
+
+typedef struct {
+    int epoll_fd;
+    int stop_fd;
+    pthread_t thread;
+    struct tcp_cla *tcp;
+} tcp_loop_t;
+
+typedef struct tcp_cla {
+    bp_cla_t *cla;
+    bp_cla_tcp_config_t config;
+    int family;
+    tcp_conn_t listener;
+    tcp_loop_t *loops;
+    int loops_started;
+    unsigned next_loop;
+    pthread_mutex_t conns_lock;
+    tcp_conn_t *conns;
+    pthread_rwlock_t peers_lock;
+    tcp_peer_t *peers[TCP_PEER_BUCKETS];
+} tcp_cla_t;
+
+static const bp_cla_tcp_config_t default_config = {
+    .loop_threads = 1,
+    .connections_per_peer = 1,
+    .nodelay = 1,
+    .cork = 0
+};
+
+static int set_socket_options(tcp_cla_t *tcp, int fd) {
+    int nodelay = tcp->config.nodelay ? 1 : 0;
+    return setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+}
+
+static void set_cork(tcp_cla_t *tcp, tcp_conn_t *conn, int on) {
+    if (tcp->config.cork) setsockopt(conn->fd, IPPROTO_TCP, TCP_CORK, &on, sizeof(on));
+}
+
+static int watch(tcp_cla_t *tcp, tcp_conn_t *conn, int op, uint32_t events) {
+    struct epoll_event event = { .events = events, .data.ptr = conn };
+    return epoll_ctl(tcp->loops[conn->loop].epoll_fd, op, conn->fd, &event);
+}
+
+static tcp_conn_t *conn_new(tcp_cla_t *tcp, int fd) {
+    tcp_conn_t *conn = calloc(1, sizeof(tcp_conn_t));
+    if (!conn) return NULL;
+
+    conn->fd = fd;
+    conn->loop = (int)(__atomic_fetch_add(&tcp->next_loop, 1, __ATOMIC_RELAXED) % tcp->config.loop_threads);
+
+    pthread_mutex_lock(&tcp->conns_lock);
+    conn->next = tcp->conns;
+    if (tcp->conns) tcp->conns->prev = conn;
+    tcp->conns = conn;
+    pthread_mutex_unlock(&tcp->conns_lock);
+    return conn;
+}
+
+static void conn_free(tcp_cla_t *tcp, tcp_conn_t *conn) {
+    pthread_mutex_lock(&tcp->conns_lock);
+    if (conn->prev) conn->prev->next = conn->next;
+    else tcp->conns = conn->next;
+    if (conn->next) conn->next->prev = conn->prev;
+    pthread_mutex_unlock(&tcp->conns_lock);
+
+    close(conn->fd);
+    free(conn->out);
+    free(conn->in);
+    free(conn);
+}
+
+// Event loop only. Queued output is lost with the connection and counted as one error.
+static void conn_close(tcp_cla_t *tcp, tcp_conn_t *conn) {
+    if (conn->peer) {
+        pthread_mutex_lock(&conn->peer->lock);
+        if (conn->peer->conns[conn->slot] == conn) conn->peer->conns[conn->slot] = NULL;
+        pthread_mutex_unlock(&conn->peer->lock);
+    }
+    if (conn->out_len > conn->out_off) {
+        bp_stats_entity_add(bp_stats_entity(BP_STATS_CLA, tcp->cla->protocol_name), BP_ENTITY_ERRORS, 1);
+    }
+
+    epoll_ctl(tcp->loops[conn->loop].epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    conn_free(tcp, conn);
+}
+
+static int reserve(char **buffer, size_t *cap, size_t needed) {
+    if (needed <= *cap) return 0;
+
+    size_t new_cap = *cap ? *cap : TCP_READ_CHUNK;
+    while (new_cap < needed) new_cap *= 2;
+    char *grown = realloc(*buffer, new_cap);
+    if (!grown) return -1;
+
+    *buffer = grown;
+    *cap = new_cap;
+    return 0;
+}
+
+// Peer lock held. Appends the len bytes of iov past skip to the connection's pending output, all or nothing.
+static int append_pending(tcp_conn_t *conn, const struct iovec *iov, int iovcnt, size_t skip, size_t len) {
+    if (conn->out_off > 0 && conn->out_off == conn->out_len) conn->out_off = conn->out_len = 0;
+    if (reserve(&conn->out, &conn->out_cap, conn->out_len + len) != 0) return -1;
+
+    for (int i = 0; i < iovcnt; i++) {
+        if (skip >= iov[i].iov_len) {
+            skip -= iov[i].iov_len;
+            continue;
+        }
+        size_t part = iov[i].iov_len - skip;
+        memcpy(conn->out + conn->out_len, (const char*)iov[i].iov_base + skip, part);
+        conn->out_len += part;
+        skip = 0;
+    }
+    return 0;
+}
+
+// Peer lock held. Writes straight to the socket when nothing is pending, otherwise queues behind it.
+// The iovec must hold whole frames: they are checked against the pending limit together and either
+// all go out or queue, so a failure never leaves part of a frame on the stream.
+static int conn_write(tcp_cla_t *tcp, tcp_conn_t *conn, const struct iovec *iov, int iovcnt, size_t total) {
+    size_t pending = conn->out_len - conn->out_off;
+    if (pending + total > TCP_MAX_PENDING) return -1;
+
+    size_t written = 0;
+    if (pending == 0 && !conn->connecting) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = (struct iovec*)iov;
+        msg.msg_iovlen = iovcnt < IOV_MAX ? iovcnt : IOV_MAX;
+
+        ssize_t sent;
+        do {
+            sent = sendmsg(conn->fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        } while (sent < 0 && errno == EINTR);
+        if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) return -1;
+        written = sent > 0 ? (size_t)sent : 0;
+    }
+    if (written == total) return 0;
+
+    if (append_pending(conn, iov, iovcnt, written, total - written) != 0) {
+        // Part of the frame is already on the wire, so the stream cannot be kept whole: have the loop close it
+        if (written > 0) shutdown(conn->fd, SHUT_RDWR);
+        return -1;
+    }
+    if (!conn->armed) {
+        conn->armed = 1;
+        watch(tcp, conn, EPOLL_CTL_MOD, EPOLLIN | EPOLLOUT);
+    }
+    return 0;
+}
+
+static tcp_conn_t *conn_connect(tcp_cla_t *tcp, tcp_peer_t *peer, int slot) {
+    int fd = socket(tcp->family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return NULL;
+    set_socket_options(tcp, fd);
+
+    if (connect(fd, (struct sockaddr*)&peer->addr, peer->addr_len) != 0 && errno != EINPROGRESS) {
+        close(fd);
+        return NULL;
+    }
+
+    tcp_conn_t *conn = conn_new(tcp, fd);
+    if (!conn) {
+        close(fd);
+        return NULL;
+    }
+    conn->peer = peer;
+    conn->slot = slot;
+    conn->connecting = 1;
+    conn->armed = 1;
+    snprintf(conn->source, sizeof(conn->source), "%s", peer->dest);
+
+    if (watch(tcp, conn, EPOLL_CTL_ADD, EPOLLIN | EPOLLOUT) != 0) {
+        conn_free(tcp, conn);
+        return NULL;
+    }
+    return conn;
+}
+
+// Peer lock held. Connections are spread round-robin over the pool and reopened when found closed.
+static tcp_conn_t *peer_conn(tcp_cla_t *tcp, tcp_peer_t *peer) {
+    int slot = (int)(peer->next_slot++ % (unsigned)tcp->config.connections_per_peer);
+    if (!peer->conns[slot]) peer->conns[slot] = conn_connect(tcp, peer, slot);
+    return peer->conns[slot];
+}
+
+static tcp_peer_t *peer_find(tcp_cla_t *tcp, const char *dest, uint64_t hash) {
+    for (tcp_peer_t *peer = tcp->peers[hash & (TCP_PEER_BUCKETS - 1)]; peer; peer = peer->next) {
+        if (peer->hash == hash && strcmp(peer->dest, dest) == 0) return peer;
+    }
+    return NULL;
+}
+
+// Peers stay in the table until the CLA is destroyed, so callers may keep using one after unlocking
+static tcp_peer_t *peer_get(tcp_cla_t *tcp, const char *dest) {
+    uint64_t hash = bp_hash_string(dest);
+
+    pthread_rwlock_rdlock(&tcp->peers_lock);
+    tcp_peer_t *peer = peer_find(tcp, dest, hash);
+    pthread_rwlock_unlock(&tcp->peers_lock);
+    if (peer) return peer;
+
+    pthread_rwlock_wrlock(&tcp->peers_lock);
+    peer = peer_find(tcp, dest, hash);
+    if (!peer) {
+        peer = calloc(1, sizeof(tcp_peer_t));
+        if (peer) {
+            peer->dest = strdup(dest);
+            peer->conns = calloc(tcp->config.connections_per_peer, sizeof(tcp_conn_t*));
+            if (!peer->dest || !peer->conns ||
+                bp_cla_parse_address(dest, tcp->family, &peer->addr, &peer->addr_len) != 0 ||
+                pthread_mutex_init(&peer->lock, NULL) != 0) {
+                free(peer->dest);
+                free(peer->conns);
+                free(peer);
+                peer = NULL;
+            } else {
+                peer->hash = hash;
+                peer->next = tcp->peers[hash & (TCP_PEER_BUCKETS - 1)];
+                tcp->peers[hash & (TCP_PEER_BUCKETS - 1)] = peer;
+            }
+        }
+    }
+    pthread_rwlock_unlock(&tcp->peers_lock);
+    return peer;
+}
+
+static void encode_length(uint8_t header[TCP_FRAME_HEADER], size_t len) {
+    header[0] = (uint8_t)(len >> 24);
+    header[1] = (uint8_t)(len >> 16);
+    header[2] = (uint8_t)(len >> 8);
+    header[3] = (uint8_t)len;
+}
+
+static size_t iov_total(const struct iovec *iov, int iovcnt) {
+    size_t len = 0;
+    for (int i = 0; i < iovcnt; i++) len += iov[i].iov_len;
+    return len;
+}
+
+static int tcp_send_iov(const struct iovec *iov, int iovcnt, const char *dest, void *context) {
+    tcp_cla_t *tcp = (tcp_cla_t*)context;
+    size_t len = iov_total(iov, iovcnt);
+    if (len == 0 || len > TCP_MAX_FRAME || iovcnt > IOV_MAX) return -1;
+
+    tcp_peer_t *peer = peer_get(tcp, dest);
+    if (!peer) return -1;
+
+    // Header and bundle go out as one write, so a failure cannot leave a header without its bundle
+    uint8_t header[TCP_FRAME_HEADER];
+    encode_length(header, len);
+    struct iovec frame[IOV_MAX + 1];
+    frame[0].iov_base = header;
+    frame[0].iov_len = sizeof(header);
+    memcpy(&frame[1], iov, iovcnt * sizeof(struct iovec));
+
+    pthread_mutex_lock(&peer->lock);
+    tcp_conn_t *conn = peer_conn(tcp, peer);
+    int result = -1;
+    if (conn) {
+        set_cork(tcp, conn, 1);
+        result = conn_write(tcp, conn, frame, iovcnt + 1, sizeof(header) + len);
+        set_cork(tcp, conn, 0);
+    }
+    pthread_mutex_unlock(&peer->lock);
+    return result;
+}
+
+// Frames consecutive bundles for the same peer, up to the pending limit, into a single writev-style sendmsg()
+static int send_run(tcp_cla_t *tcp, bp_cla_msg_t *msgs, int count, int start) {
+    uint8_t headers[TCP_BATCH_MAX][TCP_FRAME_HEADER];
+    struct iovec iov[IOV_MAX];
+    int iov_used = 0;
+    size_t total = 0;
+    int end = start;
+
+    while (end < count && end - start < TCP_BATCH_MAX && strcmp(msgs[end].dest, msgs[start].dest) == 0 &&
+           iov_used + 1 + msgs[end].iovcnt <= IOV_MAX) {
+        size_t len = iov_total(msgs[end].iov, msgs[end].iovcnt);
+        if (len == 0 || len > TCP_MAX_FRAME || total + TCP_FRAME_HEADER + len > TCP_MAX_PENDING) break;
+
+        encode_length(headers[end - start], len);
+        iov[iov_used].iov_base = headers[end - start];
+        iov[iov_used].iov_len = TCP_FRAME_HEADER;
+        memcpy(&iov[iov_used + 1], msgs[end].iov, msgs[end].iovcnt * sizeof(struct iovec));
+        iov_used += 1 + msgs[end].iovcnt;
+        total += TCP_FRAME_HEADER + len;
+        end++;
+    }
+
+    // A bundle that cannot be framed with the others goes through the single-bundle path
+    if (end == start) {
+        msgs[start].result = tcp_send_iov(msgs[start].iov, msgs[start].iovcnt, msgs[start].dest, tcp);
+        return start + 1;
+    }
+
+    int result = -1;
+    tcp_peer_t *peer = peer_get(tcp, msgs[start].dest);
+    if (peer) {
+        pthread_mutex_lock(&peer->lock);
+        tcp_conn_t *conn = peer_conn(tcp, peer);
+        if (conn) {
+            set_cork(tcp, conn, 1);
+            result = conn_write(tcp, conn, iov, iov_used, total);
+            set_cork(tcp, conn, 0);
+        }
+        pthread_mutex_unlock(&peer->lock);
+    }
+
+    for (int i = start; i < end; i++) msgs[i].result = result;
+    return end;
+}
+
+static int tcp_send_batch(bp_cla_msg_t *msgs, int count, void *context) {
+    tcp_cla_t *tcp = (tcp_cla_t*)context;
+
+    int next = 0;
+    while (next < count) next = send_run(tcp, msgs, count, next);
+    return 0;
+}
+
+static void accept_all(tcp_cla_t *tcp) {
+    for (;;) {
+        struct sockaddr_storage addr;
+        socklen_t addr_len = sizeof(addr);
+        int fd = accept4(tcp->listener.fd, (struct sockaddr*)&addr, &addr_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return;
+        }
+        set_socket_options(tcp, fd);
+
+        // Accepted connections only carry inbound bundles; replies go out through the peer pool
+        tcp_conn_t *conn = conn_new(tcp, fd);
+        if (!conn) {
+            close(fd);
+            continue;
+        }
+        bp_cla_format_address(&addr, conn->source, sizeof(conn->source));
+        if (watch(tcp, conn, EPOLL_CTL_ADD, EPOLLIN) != 0) conn_free(tcp, conn);
+    }
+}
+
+// Returns -1 when the connection should be closed
+static int handle_writable(tcp_cla_t *tcp, tcp_conn_t *conn) {
+    if (!conn->peer) return 0;
+
+    int result = 0;
+    pthread_mutex_lock(&conn->peer->lock);
+    if (conn->connecting) {
+        int error = 0;
+        socklen_t error_len = sizeof(error);
+        getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &error, &error_len);
+        conn->connecting = 0;
+        if (error != 0) result = -1;
+    }
+
+    while (result == 0 && conn->out_off < conn->out_len) {
+        ssize_t sent = send(conn->fd, conn->out + conn->out_off, conn->out_len - conn->out_off,
+                            MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) result = -1;
+            break;
+        }
+        conn->out_off += sent;
+    }
+
+    if (result == 0 && conn->out_off == conn->out_len) {
+        conn->out_off = conn->out_len = 0;
+        conn->armed = 0;
+        watch(tcp, conn, EPOLL_CTL_MOD, EPOLLIN);
+    }
+    pthread_mutex_unlock(&conn->peer->lock);
+    return result;
+}
+
+static int deliver_frames(tcp_cla_t *tcp, tcp_conn_t *conn) {
+    size_t offset = 0;
+    while (conn->in_len - offset >= TCP_FRAME_HEADER) {
+        const uint8_t *header = (const uint8_t*)conn->in + offset;
+        size_t len = ((size_t)header[0] << 24) | ((size_t)header[1] << 16) | ((size_t)header[2] << 8) | header[3];
+        if (len == 0 || len > TCP_MAX_FRAME) return -1;
+        if (conn->in_len - offset < TCP_FRAME_HEADER + len) break;
+
+        bp_cla_handle_bundle_receive(tcp->cla, conn->in + offset + TCP_FRAME_HEADER, len, conn->source);
+        offset += TCP_FRAME_HEADER + len;
+    }
+
+    if (offset > 0) {
+        memmove(conn->in, conn->in + offset, conn->in_len - offset);
+        conn->in_len -= offset;
+    }
+    return 0;
+}
+
+static int handle_readable(tcp_cla_t *tcp, tcp_conn_t *conn) {
+    for (;;) {
+        if (reserve(&conn->in, &conn->in_cap, conn->in_len + TCP_READ_CHUNK) != 0) return -1;
+
+        ssize_t received = recv(conn->fd, conn->in + conn->in_len, conn->in_cap - conn->in_len, MSG_DONTWAIT);
+        if (received == 0) return -1;
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        }
+
+        conn->in_len += received;
+        if (deliver_frames(tcp, conn) != 0) return -1;
+    }
+}
+
+static void *loop_main(void *arg) {
+    tcp_loop_t *loop = (tcp_loop_t*)arg;
+    tcp_cla_t *tcp = loop->tcp;
+    struct epoll_event events[TCP_EVENTS];
+
+    for (;;) {
+        int n = epoll_wait(loop->epoll_fd, events, TCP_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            tcp_conn_t *conn = events[i].data.ptr;
+            if (!conn) return NULL;
+
+            if (conn->listener) {
+                accept_all(tcp);
+                continue;
+            }
+
+            int failed = 0;
+            if (events[i].events & EPOLLOUT) failed = handle_writable(tcp, conn) != 0;
+            if (!failed && events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) failed = handle_readable(tcp, conn) != 0;
+            if (failed) conn_close(tcp, conn);
+        }
+    }
+    return NULL;
+}
+
+static void stop_loops(tcp_cla_t *tcp) {
+    uint64_t one = 1;
+    for (int i = 0; i < tcp->loops_started; i++) {
+        if (write(tcp->loops[i].stop_fd, &one, sizeof(one)) == sizeof(one)) pthread_join(tcp->loops[i].thread, NULL);
+    }
+    for (int i = 0; i < tcp->config.loop_threads; i++) {
+        if (tcp->loops[i].stop_fd >= 0) close(tcp->loops[i].stop_fd);
+        if (tcp->loops[i].epoll_fd >= 0) close(tcp->loops[i].epoll_fd);
+    }
+    tcp->loops_started = 0;
+}
+
+static void tcp_release(void *impl) {
+    tcp_cla_t *tcp = (tcp_cla_t*)impl;
+    if (!tcp) return;
+
+    if (tcp->loops) stop_loops(tcp);
+    while (tcp->conns) conn_free(tcp, tcp->conns);
+    if (tcp->listener.fd >= 0) close(tcp->listener.fd);
+
+    for (int i = 0; i < TCP_PEER_BUCKETS; i++) {
+        tcp_peer_t *peer = tcp->peers[i];
+        while (peer) {
+            tcp_peer_t *next = peer->next;
+            pthread_mutex_destroy(&peer->lock);
+            free(peer->dest);
+            free(peer->conns);
+            free(peer);
+            peer = next;
+        }
+    }
+
+    pthread_rwlock_destroy(&tcp->peers_lock);
+    pthread_mutex_destroy(&tcp->conns_lock);
+    free(tcp->loops);
+    free(tcp);
+}
+
+static int open_listener(tcp_cla_t *tcp, const char *local_addr, uint16_t local_port) {
+    char text[INET6_ADDRSTRLEN + 8];
+    tcp->family = strchr(local_addr, ':') ? AF_INET6 : AF_INET;
+    snprintf(text, sizeof(text), tcp->family == AF_INET6 ? "[%s]:%u" : "%s:%u", local_addr, local_port);
+
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+    if (bp_cla_parse_address(text, tcp->family, &addr, &addr_len) != 0) return BP_ERROR_INVALID_ARGS;
+
+    int fd = socket(tcp->family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return BP_ERROR_PROTOCOL;
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, (struct sockaddr*)&addr, addr_len) != 0 || listen(fd, TCP_BACKLOG) != 0) {
+        close(fd);
+        return BP_ERROR_PROTOCOL;
+    }
+
+    tcp->listener.fd = fd;
+    tcp->listener.listener = 1;
+    return BP_SUCCESS;
+}
+
+static int start_loops(tcp_cla_t *tcp) {
+    tcp->loops = calloc(tcp->config.loop_threads, sizeof(tcp_loop_t));
+    if (!tcp->loops) return BP_ERROR_MEMORY;
+
+    for (int i = 0; i < tcp->config.loop_threads; i++) {
+        tcp->loops[i].epoll_fd = tcp->loops[i].stop_fd = -1;
+    }
+
+    for (int i = 0; i < tcp->config.loop_threads; i++) {
+        tcp_loop_t *loop = &tcp->loops[i];
+        loop->tcp = tcp;
+        loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        loop->stop_fd = eventfd(0, EFD_CLOEXEC);
+        if (loop->epoll_fd < 0 || loop->stop_fd < 0) return BP_ERROR_MEMORY;
+
+        struct epoll_event stop = { .events = EPOLLIN, .data.ptr = NULL };
+        epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->stop_fd, &stop);
+    }
+
+    // The first loop also accepts
+    struct epoll_event accept_event = { .events = EPOLLIN, .data.ptr = &tcp->listener };
+    if (epoll_ctl(tcp->loops[0].epoll_fd, EPOLL_CTL_ADD, tcp->listener.fd, &accept_event) != 0) return BP_ERROR_PROTOCOL;
+
+    for (int i = 0; i < tcp->config.loop_threads; i++) {
+        if (pthread_create(&tcp->loops[i].thread, NULL, loop_main, &tcp->loops[i]) != 0) return BP_ERROR_MEMORY;
+        tcp->loops_started++;
+    }
+    return BP_SUCCESS;
+}
+
+// A failed start leaves no loop behind, so a later one can try again
+static int tcp_start(void *impl) {
+    tcp_cla_t *tcp = (tcp_cla_t*)impl;
+    int result = start_loops(tcp);
+    if (result != BP_SUCCESS && tcp->loops) {
+        stop_loops(tcp);
+        free(tcp->loops);
+        tcp->loops = NULL;
+    }
+    return result;
+}
+
+static tcp_cla_t *tcp_alloc(const bp_cla_tcp_config_t *config) {
+    tcp_cla_t *tcp = calloc(1, sizeof(tcp_cla_t));
+    if (!tcp) return NULL;
+
+    tcp->config = *config;
+    tcp->listener.fd = -1;
+    if (pthread_mutex_init(&tcp->conns_lock, NULL) != 0) {
+        free(tcp);
+        return NULL;
+    }
+    if (pthread_rwlock_init(&tcp->peers_lock, NULL) != 0) {
+        pthread_mutex_destroy(&tcp->conns_lock);
+        free(tcp);
+        return NULL;
+    }
+    return tcp;
+}
+
+// Like the UDP CLA, this one keeps its state out of context, starts its loops on bp_cla_register() or
+// bp_cla_start() and queues sends so bundles for a peer are coalesced
+int bp_cla_create_tcp_ex(const char *local_addr, uint16_t local_port, const bp_cla_tcp_config_t *config, bp_cla_t **cla) {
+    if (!local_addr || !cla) return BP_ERROR_INVALID_ARGS;
+    if (!config) config = &default_config;
+    if (config->loop_threads <= 0 || config->connections_per_peer <= 0) return BP_ERROR_INVALID_ARGS;
+
+    tcp_cla_t *tcp = tcp_alloc(config);
+    if (!tcp) return BP_ERROR_MEMORY;
+
+    *cla = bp_cla_create_base("tcp", local_addr, local_port, 65536, 0);
+    if (!*cla) {
+        tcp_release(tcp);
+        return BP_ERROR_MEMORY;
+    }
+    tcp->cla = *cla;
+    bp_cla_set_impl(*cla, tcp, tcp_start, tcp_release);
+
+    int result = open_listener(tcp, local_addr, local_port);
+    if (result != BP_SUCCESS) {
+        bp_cla_destroy(*cla);
+        *cla = NULL;
+        return result;
+    }
+
+    (*cla)->send_iov_callback = tcp_send_iov;
+    (*cla)->send_batch_callback = tcp_send_batch;
+    (*cla)->queue_depth = TCP_DEFAULT_QUEUE_DEPTH;
+    (*cla)->queue_policy = BP_CLA_QUEUE_BLOCK;
+    return BP_SUCCESS;
+}
+
+int bp_cla_create_tcp(const char *local_addr, uint16_t local_port, bp_cla_t **cla) {
+    return bp_cla_create_tcp_ex(local_addr, local_port, NULL, cla);
+}
\ No newline at end of file
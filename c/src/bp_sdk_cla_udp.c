@@ -0,0 +1,364 @@
+#include "bp_sdk_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// Older libc headers lack the UDP segmentation offload options
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+#define UDP_SOCKET_BUFFER (4 * 1024 * 1024)
+#define UDP_BATCH_MAX 64
+#define UDP_IOV_MAX 256
+#define UDP_GSO_MAX_SEGMENTS 64
+#define UDP_GSO_MAX_BYTES 65000
+#define UDP_RX_SLOTS 32
+#define UDP_RX_SLOT_SIZE 65536
+#define UDP_DEFAULT_QUEUE_DEPTH 1024
+
+typedef struct {
+    bp_cla_t *cla;
+    int fd;
+    int stop_fd;
+    int family;
+    int gso;
+    int gro;
+    int rx_started;
+    pthread_t rx_thread;
+    bp_stats_entity_t *stats;
+    // Receive ring: every slot is reused by the next recvmmsg(), so bundles are only valid during the callback
+    char *rx_buffers;
+    struct mmsghdr rx_msgs[UDP_RX_SLOTS];
+    struct iovec rx_iov[UDP_RX_SLOTS];
+    struct sockaddr_storage rx_addrs[UDP_RX_SLOTS];
+    char rx_control[UDP_RX_SLOTS][CMSG_SPACE(sizeof(int))];
+} udp_cla_t;
+
+static size_t msg_length(const bp_cla_msg_t *msg) {
+    size_t len = 0;
+    for (int i = 0; i < msg->iovcnt; i++) len += msg->iov[i].iov_len;
+    return len;
+}
+
+static int udp_send_iov(const struct iovec *iov, int iovcnt, const char *dest, void *context) {
+    udp_cla_t *udp = (udp_cla_t*)context;
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+    if (bp_cla_parse_address(dest, udp->family, &addr, &addr_len) != 0) return -1;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = &addr;
+    msg.msg_namelen = addr_len;
+    msg.msg_iov = (struct iovec*)iov;
+    msg.msg_iovlen = iovcnt;
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(udp->fd, &msg, 0);
+    } while (sent < 0 && errno == EINTR);
+    return sent < 0 ? -1 : 0;
+}
+
+// One datagram header for the sendmmsg() batch; with GSO it may carry several bundles as equal-sized segments
+typedef struct {
+    int first;
+    int count;
+    struct sockaddr_storage addr;
+    char control[CMSG_SPACE(sizeof(uint16_t))];
+} udp_group_t;
+
+// Consecutive bundles for the same peer become one GSO send when all but the last share a size
+static int gso_joins(udp_cla_t *udp, const bp_cla_msg_t *msgs, const udp_group_t *group,
+                     int next, size_t segment, size_t total, int iov_used) {
+    if (!udp->gso || group->count >= UDP_GSO_MAX_SEGMENTS) return 0;
+
+    const bp_cla_msg_t *last = &msgs[group->first + group->count - 1];
+    const bp_cla_msg_t *msg = &msgs[next];
+    size_t len = msg_length(msg);
+
+    return msg_length(last) == segment && len <= segment && total + len <= UDP_GSO_MAX_BYTES &&
+           iov_used + msg->iovcnt <= UDP_IOV_MAX && strcmp(msg->dest, last->dest) == 0;
+}
+
+static void set_segment(udp_group_t *group, struct msghdr *hdr, uint16_t segment) {
+    hdr->msg_control = group->control;
+    hdr->msg_controllen = sizeof(group->control);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(hdr);
+    cmsg->cmsg_level = SOL_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+}
+
+static void mark_group(bp_cla_msg_t *msgs, const udp_group_t *group, int result) {
+    for (int i = 0; i < group->count; i++) msgs[group->first + i].result = result;
+}
+
+// Builds up to UDP_BATCH_MAX datagrams starting at msgs[start] and sends them; returns the next unsent index
+static int send_chunk(udp_cla_t *udp, bp_cla_msg_t *msgs, int count, int start) {
+    udp_group_t groups[UDP_BATCH_MAX];
+    struct mmsghdr hdrs[UDP_BATCH_MAX];
+    struct iovec iov[UDP_IOV_MAX];
+    int group_count = 0;
+    int iov_used = 0;
+    int next = start;
+
+    memset(hdrs, 0, sizeof(hdrs));
+    while (next < count && group_count < UDP_BATCH_MAX && iov_used + msgs[next].iovcnt <= UDP_IOV_MAX) {
+        udp_group_t *group = &groups[group_count];
+        struct msghdr *hdr = &hdrs[group_count].msg_hdr;
+        socklen_t addr_len;
+
+        if (bp_cla_parse_address(msgs[next].dest, udp->family, &group->addr, &addr_len) != 0) {
+            msgs[next++].result = -1;
+            continue;
+        }
+
+        group->first = next;
+        group->count = 0;
+        hdr->msg_name = &group->addr;
+        hdr->msg_namelen = addr_len;
+        hdr->msg_iov = &iov[iov_used];
+
+        size_t segment = msg_length(&msgs[next]);
+        size_t total = 0;
+        do {
+            memcpy(&iov[iov_used], msgs[next].iov, msgs[next].iovcnt * sizeof(struct iovec));
+            iov_used += msgs[next].iovcnt;
+            hdr->msg_iovlen += msgs[next].iovcnt;
+            total += msg_length(&msgs[next]);
+            group->count++;
+            next++;
+        } while (next < count && gso_joins(udp, msgs, group, next, segment, total, iov_used));
+
+        if (group->count > 1) set_segment(group, hdr, (uint16_t)segment);
+        group_count++;
+    }
+
+    // A datagram the kernel refuses fails only its own bundles; the rest of the batch is retried
+    int done = 0;
+    while (done < group_count) {
+        int sent = sendmmsg(udp->fd, hdrs + done, group_count - done, 0);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (groups[done].count > 1 && (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT)) {
+                // The route cannot segment after all; stop grouping and fail only this datagram
+                udp->gso = 0;
+            }
+            mark_group(msgs, &groups[done], -1);
+            done++;
+            continue;
+        }
+        for (int i = 0; i < sent; i++) mark_group(msgs, &groups[done + i], 0);
+        done += sent;
+    }
+    return next;
+}
+
+static int udp_send_batch(bp_cla_msg_t *msgs, int count, void *context) {
+    udp_cla_t *udp = (udp_cla_t*)context;
+
+    int next = 0;
+    while (next < count) {
+        if (msgs[next].iovcnt > UDP_IOV_MAX) {
+            msgs[next].result = udp_send_iov(msgs[next].iov, msgs[next].iovcnt, msgs[next].dest, udp);
+            next++;
+            continue;
+        }
+        next = send_chunk(udp, msgs, count, next);
+    }
+    return 0;
+}
+
+static int gro_segment(struct msghdr *hdr) {
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(hdr); cmsg; cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+            int segment;
+            memcpy(&segment, CMSG_DATA(cmsg), sizeof(segment));
+            return segment;
+        }
+    }
+    return 0;
+}
+
+static void deliver_datagrams(udp_cla_t *udp, int received) {
+    char source[INET6_ADDRSTRLEN + 8];
+
+    for (int i = 0; i < received; i++) {
+        struct msghdr *hdr = &udp->rx_msgs[i].msg_hdr;
+        size_t len = udp->rx_msgs[i].msg_len;
+        if (hdr->msg_flags & (MSG_TRUNC | MSG_CTRUNC) || len == 0) {
+            bp_stats_entity_add(udp->stats, BP_ENTITY_ERRORS, 1);
+            continue;
+        }
+
+        bp_cla_format_address(&udp->rx_addrs[i], source, sizeof(source));
+
+        // With GRO one buffer may hold several datagrams from the same peer
+        const char *data = udp->rx_iov[i].iov_base;
+        size_t segment = udp->gro ? (size_t)gro_segment(hdr) : 0;
+        if (segment == 0) segment = len;
+        for (size_t offset = 0; offset < len; offset += segment) {
+            size_t part = len - offset < segment ? len - offset : segment;
+            bp_cla_handle_bundle_receive(udp->cla, data + offset, part, source);
+        }
+    }
+}
+
+static void *receive_main(void *arg) {
+    udp_cla_t *udp = (udp_cla_t*)arg;
+    struct pollfd fds[2] = {
+        { .fd = udp->fd, .events = POLLIN },
+        { .fd = udp->stop_fd, .events = POLLIN }
+    };
+
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents) break;
+
+        for (int i = 0; i < UDP_RX_SLOTS; i++) {
+            struct msghdr *hdr = &udp->rx_msgs[i].msg_hdr;
+            hdr->msg_namelen = sizeof(udp->rx_addrs[i]);
+            hdr->msg_controllen = sizeof(udp->rx_control[i]);
+            hdr->msg_flags = 0;
+        }
+
+        int received = recvmmsg(udp->fd, udp->rx_msgs, UDP_RX_SLOTS, MSG_DONTWAIT, NULL);
+        if (received > 0) deliver_datagrams(udp, received);
+    }
+    return NULL;
+}
+
+static int udp_start(void *impl) {
+    udp_cla_t *udp = (udp_cla_t*)impl;
+    if (pthread_create(&udp->rx_thread, NULL, receive_main, udp) != 0) return BP_ERROR_MEMORY;
+    udp->rx_started = 1;
+    return BP_SUCCESS;
+}
+
+static void udp_release(void *impl) {
+    udp_cla_t *udp = (udp_cla_t*)impl;
+    if (!udp) return;
+
+    uint64_t one = 1;
+    if (udp->rx_started && write(udp->stop_fd, &one, sizeof(one)) == sizeof(one)) pthread_join(udp->rx_thread, NULL);
+
+    close(udp->stop_fd);
+    close(udp->fd);
+    free(udp->rx_buffers);
+    free(udp);
+}
+
+static void configure_socket(udp_cla_t *udp) {
+    int size = UDP_SOCKET_BUFFER;
+    setsockopt(udp->fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+    setsockopt(udp->fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+    // Kernels without UDP_SEGMENT reject the read; ones without UDP_GRO reject the write
+    int value = 0;
+    socklen_t value_len = sizeof(value);
+    udp->gso = getsockopt(udp->fd, SOL_UDP, UDP_SEGMENT, &value, &value_len) == 0;
+
+    int one = 1;
+    udp->gro = setsockopt(udp->fd, SOL_UDP, UDP_GRO, &one, sizeof(one)) == 0;
+}
+
+static int open_socket(udp_cla_t *udp, const char *local_addr, uint16_t local_port) {
+    char text[INET6_ADDRSTRLEN + 8];
+    udp->family = strchr(local_addr, ':') ? AF_INET6 : AF_INET;
+    snprintf(text, sizeof(text), udp->family == AF_INET6 ? "[%s]:%u" : "%s:%u", local_addr, local_port);
+
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+    if (bp_cla_parse_address(text, udp->family, &addr, &addr_len) != 0) return BP_ERROR_INVALID_ARGS;
+
+    udp->fd = socket(udp->family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (udp->fd < 0) return BP_ERROR_PROTOCOL;
+
+    configure_socket(udp);
+    if (bind(udp->fd, (struct sockaddr*)&addr, addr_len) != 0) {
+        close(udp->fd);
+        return BP_ERROR_PROTOCOL;
+    }
+    return BP_SUCCESS;
+}
+
+static int init_receive_ring(udp_cla_t *udp) {
+    udp->rx_buffers = malloc((size_t)UDP_RX_SLOTS * UDP_RX_SLOT_SIZE);
+    if (!udp->rx_buffers) return BP_ERROR_MEMORY;
+
+    for (int i = 0; i < UDP_RX_SLOTS; i++) {
+        udp->rx_iov[i].iov_base = udp->rx_buffers + (size_t)i * UDP_RX_SLOT_SIZE;
+        udp->rx_iov[i].iov_len = UDP_RX_SLOT_SIZE;
+
+        struct msghdr *hdr = &udp->rx_msgs[i].msg_hdr;
+        hdr->msg_name = &udp->rx_addrs[i];
+        hdr->msg_iov = &udp->rx_iov[i];
+        hdr->msg_iovlen = 1;
+        hdr->msg_control = udp->rx_control[i];
+    }
+    return BP_SUCCESS;
+}
+
+// The send callbacks get the socket state; context is left to the caller's receive_callback, and the
+// receive thread starts on bp_cla_register() or bp_cla_start(). Sends are queued by default so the
+// sender thread can batch them into sendmmsg().
+int bp_cla_create_udp(const char *local_addr, uint16_t local_port, bp_cla_t **cla) {
+    if (!local_addr || !cla) return BP_ERROR_INVALID_ARGS;
+
+    udp_cla_t *udp = calloc(1, sizeof(udp_cla_t));
+    if (!udp) return BP_ERROR_MEMORY;
+
+    int result = open_socket(udp, local_addr, local_port);
+    if (result != BP_SUCCESS) {
+        free(udp);
+        return result;
+    }
+
+    udp->stop_fd = eventfd(0, EFD_CLOEXEC);
+    if (udp->stop_fd < 0 || init_receive_ring(udp) != BP_SUCCESS) {
+        if (udp->stop_fd >= 0) close(udp->stop_fd);
+        close(udp->fd);
+        free(udp);
+        return BP_ERROR_MEMORY;
+    }
+
+    *cla = bp_cla_create_base("udp", local_addr, local_port, 1472, 0);
+    if (!*cla) {
+        close(udp->stop_fd);
+        close(udp->fd);
+        free(udp->rx_buffers);
+        free(udp);
+        return BP_ERROR_MEMORY;
+    }
+
+    udp->cla = *cla;
+    udp->stats = bp_stats_entity(BP_STATS_CLA, "udp");
+    (*cla)->send_iov_callback = udp_send_iov;
+    (*cla)->send_batch_callback = udp_send_batch;
+    (*cla)->queue_depth = UDP_DEFAULT_QUEUE_DEPTH;
+    (*cla)->queue_policy = BP_CLA_QUEUE_BLOCK;
+
+    bp_cla_set_impl(*cla, udp, udp_start, udp_release);
+    return BP_SUCCESS;
+}
\ No newline at end of file
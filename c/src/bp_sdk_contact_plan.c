@@ -0,0 +1,540 @@
+#include "bp_sdk_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+extern bp_context_t g_bp_context;
+
+#define PLAN_INITIAL_SLOTS 64
+
+// Entries from one node to another, as a run of the order
+typedef struct {
+    uint32_t to;
+    uint32_t first;
+    uint32_t last;
+} plan_link_t;
+
+// Entries with an open-addressing index on (from, to, start). order sorts them by (from, to,
+// start) and reach[k] is the latest end among order[k] and the entries of its pair before it,
+// so the entries of a pair still open at t begin at the first k with reach[k] > t. links is a
+// CSR adjacency over the order: node n's links are links[node_links[n]] up to links[node_links[n + 1]].
+typedef struct {
+    bp_contact_plan_entry_t *items;
+    uint32_t count;
+    uint32_t capacity;
+    int32_t *slots;
+    uint32_t slot_count;
+    uint32_t slots_used;
+    uint32_t *order;
+    time_t *reach;
+    plan_link_t *links;
+    uint32_t *node_links;
+} plan_table_t;
+
+// Node indices come from ipn node numbers. Orders and links are rebuilt on the first read
+// after a change.
+static struct {
+    pthread_rwlock_t lock;
+    uint64_t *node_ids;
+    uint32_t node_count;
+    uint32_t node_capacity;
+    uint32_t *node_slots;
+    uint32_t node_slot_count;
+    plan_table_t tables[2];
+    int dirty;
+} g_plan = { .lock = PTHREAD_RWLOCK_INITIALIZER };
+
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// NULL names the local node
+int bp_contact_plan_node_of(const char *eid, uint64_t *node) {
+    unsigned long long n;
+    if (!eid) eid = g_bp_context.node_id;
+    if (!eid || sscanf(eid, "ipn:%llu", &n) != 1) return 0;
+    *node = n;
+    return 1;
+}
+
+static int grow_node_slots(void) {
+    uint32_t slot_count = g_plan.node_slot_count ? g_plan.node_slot_count * 2 : PLAN_INITIAL_SLOTS;
+    uint32_t *slots = calloc(slot_count, sizeof(uint32_t));
+    if (!slots) return 0;
+
+    for (uint32_t i = 0; i < g_plan.node_count; i++) {
+        uint32_t s = (uint32_t)mix64(g_plan.node_ids[i]) & (slot_count - 1);
+        while (slots[s]) s = (s + 1) & (slot_count - 1);
+        slots[s] = i + 1;
+    }
+    free(g_plan.node_slots);
+    g_plan.node_slots = slots;
+    g_plan.node_slot_count = slot_count;
+    return 1;
+}
+
+// Returns the node's index, adding it when create is set; -1 if absent or out of memory
+static int64_t node_index(uint64_t id, int create) {
+    if (g_plan.node_slot_count) {
+        uint32_t s = (uint32_t)mix64(id) & (g_plan.node_slot_count - 1);
+        while (g_plan.node_slots[s]) {
+            if (g_plan.node_ids[g_plan.node_slots[s] - 1] == id) return g_plan.node_slots[s] - 1;
+            s = (s + 1) & (g_plan.node_slot_count - 1);
+        }
+    }
+    if (!create) return -1;
+
+    if (g_plan.node_count == g_plan.node_capacity) {
+        uint32_t capacity = g_plan.node_capacity ? g_plan.node_capacity * 2 : PLAN_INITIAL_SLOTS;
+        uint64_t *ids = realloc(g_plan.node_ids, capacity * sizeof(uint64_t));
+        if (!ids) return -1;
+        g_plan.node_ids = ids;
+        g_plan.node_capacity = capacity;
+    }
+    if ((g_plan.node_count + 1) * 4 > g_plan.node_slot_count * 3 && !grow_node_slots()) return -1;
+
+    uint32_t index = g_plan.node_count++;
+    g_plan.node_ids[index] = id;
+    uint32_t s = (uint32_t)mix64(id) & (g_plan.node_slot_count - 1);
+    while (g_plan.node_slots[s]) s = (s + 1) & (g_plan.node_slot_count - 1);
+    g_plan.node_slots[s] = index + 1;
+    g_plan.dirty = 1;
+    return index;
+}
+
+static uint32_t entry_slot_start(const plan_table_t *table, uint32_t from, uint32_t to, time_t start) {
+    uint64_t key = ((uint64_t)from << 32 | to) ^ mix64((uint64_t)start);
+    return (uint32_t)mix64(key) & (table->slot_count - 1);
+}
+
+// Slot holding the entry with this key, or -1; a slot value of -1 marks a removed entry
+static int64_t find_slot(const plan_table_t *table, uint32_t from, uint32_t to, time_t start) {
+    if (!table->slot_count) return -1;
+    uint32_t s = entry_slot_start(table, from, to, start);
+    while (table->slots[s]) {
+        if (table->slots[s] > 0) {
+            const bp_contact_plan_entry_t *e = &table->items[table->slots[s] - 1];
+            if (e->from == from && e->to == to && e->start == start) return s;
+        }
+        s = (s + 1) & (table->slot_count - 1);
+    }
+    return -1;
+}
+
+static int rehash(plan_table_t *table, uint32_t slot_count) {
+    int32_t *slots = calloc(slot_count, sizeof(int32_t));
+    if (!slots) return 0;
+
+    free(table->slots);
+    table->slots = slots;
+    table->slot_count = slot_count;
+    table->slots_used = table->count;
+    for (uint32_t i = 0; i < table->count; i++) {
+        const bp_contact_plan_entry_t *e = &table->items[i];
+        uint32_t s = entry_slot_start(table, e->from, e->to, e->start);
+        while (slots[s]) s = (s + 1) & (slot_count - 1);
+        slots[s] = (int32_t)i + 1;
+    }
+    return 1;
+}
+
+static bp_contact_plan_entry_t *table_insert(plan_table_t *table, uint32_t from, uint32_t to, time_t start) {
+    if (table->count == table->capacity) {
+        uint32_t capacity = table->capacity ? table->capacity * 2 : PLAN_INITIAL_SLOTS;
+        bp_contact_plan_entry_t *items = realloc(table->items, capacity * sizeof(bp_contact_plan_entry_t));
+        if (!items) return NULL;
+        table->items = items;
+        table->capacity = capacity;
+    }
+    // Removed slots count as used until the next rehash
+    if ((table->slots_used + 1) * 4 > table->slot_count * 3) {
+        uint32_t slot_count = table->slot_count ? table->slot_count : PLAN_INITIAL_SLOTS;
+        while ((table->count + 1) * 2 > slot_count) slot_count *= 2;
+        if (!rehash(table, slot_count)) return NULL;
+    }
+
+    uint32_t index = table->count++;
+    uint32_t s = entry_slot_start(table, from, to, start);
+    while (table->slots[s] > 0) s = (s + 1) & (table->slot_count - 1);
+    if (table->slots[s] == 0) table->slots_used++;
+    table->slots[s] = (int32_t)index + 1;
+
+    bp_contact_plan_entry_t *e = &table->items[index];
+    memset(e, 0, sizeof(bp_contact_plan_entry_t));
+    e->from = from;
+    e->to = to;
+    e->start = start;
+    return e;
+}
+
+// The last entry moves into the hole, so indices are not stable across removals
+static void table_remove(plan_table_t *table, int64_t slot) {
+    uint32_t index = (uint32_t)table->slots[slot] - 1;
+    table->slots[slot] = -1;
+
+    uint32_t last = table->count - 1;
+    if (index != last) {
+        const bp_contact_plan_entry_t *moved = &table->items[last];
+        table->slots[find_slot(table, moved->from, moved->to, moved->start)] = (int32_t)index + 1;
+        table->items[index] = *moved;
+    }
+    table->count--;
+}
+
+// A rate or OWLT of 0 removes the entry; otherwise it is added, or its end and value replaced.
+// ref is kept for the caller, e.g. the SDR list element of an admin contact; 0 keeps the old one.
+int bp_contact_plan_update(bp_contact_plan_kind_t kind, uint64_t from_node, uint64_t to_node,
+                           time_t start, time_t end, uint32_t value, uint64_t ref) {
+    if (start >= end) return BP_ERROR_INVALID_ARGS;
+    plan_table_t *table = &g_plan.tables[kind];
+
+    pthread_rwlock_wrlock(&g_plan.lock);
+    int64_t from = node_index(from_node, value != 0);
+    int64_t to = node_index(to_node, value != 0);
+    int64_t slot = from >= 0 && to >= 0 ? find_slot(table, (uint32_t)from, (uint32_t)to, start) : -1;
+
+    int result = BP_SUCCESS;
+    if (value == 0) {
+        if (slot >= 0) {
+            table_remove(table, slot);
+            g_plan.dirty = 1;
+        } else {
+            result = BP_ERROR_NOT_FOUND;
+        }
+    } else {
+        bp_contact_plan_entry_t *e = NULL;
+        if (from >= 0 && to >= 0) {
+            e = slot >= 0 ? &table->items[table->slots[slot] - 1] : table_insert(table, (uint32_t)from, (uint32_t)to, start);
+        }
+        if (e) {
+            e->end = end;
+            e->value = value;
+            if (kind == BP_CONTACT_PLAN_CONTACT) e->residual = (uint64_t)value * (uint64_t)(end - start);
+            if (ref) e->ref = ref;
+            g_plan.dirty = 1;
+        } else {
+            result = BP_ERROR_MEMORY;
+        }
+    }
+    pthread_rwlock_unlock(&g_plan.lock);
+    return result;
+}
+
+int bp_contact_plan_lookup(bp_contact_plan_kind_t kind, uint64_t from_node, uint64_t to_node, time_t start,
+                           bp_contact_plan_entry_t *entry) {
+    const plan_table_t *table = &g_plan.tables[kind];
+
+    pthread_rwlock_rdlock(&g_plan.lock);
+    int64_t from = node_index(from_node, 0);
+    int64_t to = node_index(to_node, 0);
+    int64_t slot = from >= 0 && to >= 0 ? find_slot(table, (uint32_t)from, (uint32_t)to, start) : -1;
+    if (slot >= 0) *entry = table->items[table->slots[slot] - 1];
+    pthread_rwlock_unlock(&g_plan.lock);
+    return slot >= 0 ? BP_SUCCESS : BP_ERROR_NOT_FOUND;
+}
+
+// qsort has no context argument, so the table being sorted is passed through this
+static const plan_table_t *g_sorting;
+static pthread_mutex_t g_sort_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int compare_entries(const void *a, const void *b) {
+    const bp_contact_plan_entry_t *x = &g_sorting->items[*(const uint32_t*)a];
+    const bp_contact_plan_entry_t *y = &g_sorting->items[*(const uint32_t*)b];
+    if (x->from != y->from) return x->from < y->from ? -1 : 1;
+    if (x->to != y->to) return x->to < y->to ? -1 : 1;
+    return (x->start > y->start) - (x->start < y->start);
+}
+
+static int index_table(plan_table_t *table) {
+    uint32_t size = table->count ? table->count : 1;
+    uint32_t *order = realloc(table->order, size * sizeof(uint32_t));
+    if (order) table->order = order;
+    time_t *reach = realloc(table->reach, size * sizeof(time_t));
+    if (reach) table->reach = reach;
+    plan_link_t *links = realloc(table->links, size * sizeof(plan_link_t));
+    if (links) table->links = links;
+    uint32_t *node_links = calloc(g_plan.node_count + 1, sizeof(uint32_t));
+    if (!order || !reach || !links || !node_links) {
+        free(node_links);
+        return 0;
+    }
+    for (uint32_t i = 0; i < table->count; i++) order[i] = i;
+
+    pthread_mutex_lock(&g_sort_lock);
+    g_sorting = table;
+    qsort(order, table->count, sizeof(uint32_t), compare_entries);
+    pthread_mutex_unlock(&g_sort_lock);
+
+    uint32_t link_count = 0;
+    const bp_contact_plan_entry_t *prev = NULL;
+    for (uint32_t k = 0; k < table->count; k++) {
+        const bp_contact_plan_entry_t *e = &table->items[order[k]];
+        if (!prev || prev->from != e->from || prev->to != e->to) {
+            links[link_count].to = e->to;
+            links[link_count].first = k;
+            link_count++;
+            node_links[e->from + 1]++;
+            reach[k] = e->end;
+        } else {
+            reach[k] = reach[k - 1] > e->end ? reach[k - 1] : e->end;
+        }
+        links[link_count - 1].last = k + 1;
+        prev = e;
+    }
+    for (uint32_t n = 0; n < g_plan.node_count; n++) node_links[n + 1] += node_links[n];
+
+    free(table->node_links);
+    table->node_links = node_links;
+    return 1;
+}
+
+// Caller holds the write lock
+static int rebuild(void) {
+    if (!index_table(&g_plan.tables[0]) || !index_table(&g_plan.tables[1])) return BP_ERROR_MEMORY;
+    g_plan.dirty = 0;
+    return BP_SUCCESS;
+}
+
+// Takes the read lock with the index current; on failure no lock is held
+int bp_contact_plan_read_lock(void) {
+    pthread_rwlock_rdlock(&g_plan.lock);
+    while (g_plan.dirty) {
+        pthread_rwlock_unlock(&g_plan.lock);
+        pthread_rwlock_wrlock(&g_plan.lock);
+        int result = g_plan.dirty ? rebuild() : BP_SUCCESS;
+        pthread_rwlock_unlock(&g_plan.lock);
+        if (result != BP_SUCCESS) return result;
+        pthread_rwlock_rdlock(&g_plan.lock);
+    }
+    return BP_SUCCESS;
+}
+
+void bp_contact_plan_unlock(void) {
+    pthread_rwlock_unlock(&g_plan.lock);
+}
+
+int64_t bp_contact_plan_node_index(uint64_t node) {
+    return node_index(node, 0);
+}
+
+uint64_t bp_contact_plan_node_id(uint32_t index) {
+    return g_plan.node_ids[index];
+}
+
+uint32_t bp_contact_plan_node_count(void) {
+    return g_plan.node_count;
+}
+
+// Links from a node are numbered first up to the returned end
+uint32_t bp_contact_plan_links(uint32_t node, uint32_t *first) {
+    const plan_table_t *contacts = &g_plan.tables[BP_CONTACT_PLAN_CONTACT];
+    *first = contacts->node_links[node];
+    return contacts->node_links[node + 1];
+}
+
+uint32_t bp_contact_plan_link_to(uint32_t link) {
+    return g_plan.tables[BP_CONTACT_PLAN_CONTACT].links[link].to;
+}
+
+// The run of a pair within the order, by binary search over the links of from; empty if none
+static void pair_run(const plan_table_t *table, uint32_t from, uint32_t to, uint32_t *lo, uint32_t *hi) {
+    uint32_t a = table->node_links[from], b = table->node_links[from + 1];
+    while (a < b) {
+        uint32_t mid = a + (b - a) / 2;
+        if (table->links[mid].to < to) a = mid + 1; else b = mid;
+    }
+    int found = a < table->node_links[from + 1] && table->links[a].to == to;
+    *lo = found ? table->links[a].first : 0;
+    *hi = found ? table->links[a].last : 0;
+}
+
+// First position in [lo, hi) whose pair has an entry still open at when
+static uint32_t first_open(const plan_table_t *table, uint32_t lo, uint32_t hi, time_t when) {
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (table->reach[mid] <= when) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+// The entry open at or after when that starts first, so the earliest departure; for contacts,
+// only those with at least min_residual bytes of volume left
+static bp_contact_plan_entry_t *next_in_run(const plan_table_t *table, uint32_t lo, uint32_t hi, time_t when,
+                                            uint64_t min_residual) {
+    for (uint32_t k = first_open(table, lo, hi, when); k < hi; k++) {
+        bp_contact_plan_entry_t *e = &table->items[table->order[k]];
+        if (e->end > when && e->residual >= min_residual) return e;
+    }
+    return NULL;
+}
+
+// A volume of 0 takes any contact with some residual volume left
+const bp_contact_plan_entry_t *bp_contact_plan_link_next(uint32_t link, time_t when, uint64_t volume) {
+    const plan_table_t *contacts = &g_plan.tables[BP_CONTACT_PLAN_CONTACT];
+    return next_in_run(contacts, contacts->links[link].first, contacts->links[link].last, when,
+                       volume > 0 ? volume : 1);
+}
+
+// Ranges hold in both directions, as in ION; a pair with no range is taken to be 0 seconds apart
+time_t bp_contact_plan_owlt(uint32_t a, uint32_t b, time_t when) {
+    const plan_table_t *ranges = &g_plan.tables[BP_CONTACT_PLAN_RANGE];
+    for (int direction = 0; direction < 2; direction++) {
+        uint32_t lo, hi;
+        pair_run(ranges, direction ? b : a, direction ? a : b, &lo, &hi);
+
+        const bp_contact_plan_entry_t *r = next_in_run(ranges, lo, hi, when, 0);
+        if (r && r->start <= when) return r->value;
+    }
+    return 0;
+}
+
+void bp_contact_plan_clear(void) {
+    pthread_rwlock_wrlock(&g_plan.lock);
+    for (int kind = 0; kind < 2; kind++) {
+        plan_table_t *table = &g_plan.tables[kind];
+        free(table->items);
+        free(table->slots);
+        free(table->order);
+        free(table->reach);
+        free(table->links);
+        free(table->node_links);
+        memset(table, 0, sizeof(plan_table_t));
+    }
+    free(g_plan.node_ids);
+    free(g_plan.node_slots);
+    g_plan.node_ids = NULL;
+    g_plan.node_slots = NULL;
+    g_plan.node_count = g_plan.node_capacity = g_plan.node_slot_count = 0;
+    g_plan.dirty = 0;
+    pthread_rwlock_unlock(&g_plan.lock);
+}
+
+static int add_entry(bp_contact_plan_kind_t kind, const char *from_eid, const char *to_eid,
+                     time_t start, time_t end, uint32_t value) {
+    uint64_t from, to;
+    if (!g_bp_context.initialized) return BP_ERROR_NOT_INITIALIZED;
+    if (!bp_contact_plan_node_of(from_eid, &from) || !to_eid || !bp_contact_plan_node_of(to_eid, &to) || start >= end)
+        return BP_ERROR_INVALID_ARGS;
+
+    int result = bp_contact_plan_update(kind, from, to, start, end, value, 0);
+    bp_route_cache_invalidate(NULL);
+    return result;
+}
+
+// Contacts between any two nodes, for multi-hop plans; a NULL from_eid is the local node
+int bp_contact_plan_add_contact(const char *from_eid, const char *to_eid, time_t start, time_t end, uint32_t rate) {
+    return add_entry(BP_CONTACT_PLAN_CONTACT, from_eid, to_eid, start, end, rate);
+}
+
+int bp_contact_plan_add_range(const char *from_eid, const char *to_eid, time_t start, time_t end, uint32_t owlt) {
+    return add_entry(BP_CONTACT_PLAN_RANGE, from_eid, to_eid, start, end, owlt);
+}
+
+static void fill_info(const bp_contact_plan_entry_t *e, bp_contact_info_t *info) {
+    info->start = e->start;
+    info->end = e->end;
+    info->rate = e->value;
+    info->residual = e->residual;
+}
+
+// Contacts overlapping [t0, t1), by start time
+int bp_contact_plan_query(const char *from_eid, const char *to_eid, time_t t0, time_t t1,
+                          bp_contact_info_t **contacts, int *count) {
+    uint64_t from_node, to_node;
+    if (!contacts || !count || !to_eid || !g_bp_context.initialized)
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+    if (!bp_contact_plan_node_of(from_eid, &from_node) || !bp_contact_plan_node_of(to_eid, &to_node) || t0 >= t1)
+        return BP_ERROR_INVALID_ARGS;
+
+    *contacts = NULL;
+    *count = 0;
+    int result = bp_contact_plan_read_lock();
+    if (result != BP_SUCCESS) return result;
+
+    const plan_table_t *table = &g_plan.tables[BP_CONTACT_PLAN_CONTACT];
+    int64_t from = node_index(from_node, 0);
+    int64_t to = node_index(to_node, 0);
+    uint32_t lo = 0, hi = 0;
+    if (from >= 0 && to >= 0) pair_run(table, (uint32_t)from, (uint32_t)to, &lo, &hi);
+
+    // Entries from first_open on start in order, so the scan stops at the first starting at t1
+    for (uint32_t k = first_open(table, lo, hi, t0); k < hi; k++) {
+        const bp_contact_plan_entry_t *e = &table->items[table->order[k]];
+        if (e->start >= t1) break;
+        if (e->end <= t0) continue;
+
+        if (*count % 16 == 0) {
+            bp_contact_info_t *grown = realloc(*contacts, (*count + 16) * sizeof(bp_contact_info_t));
+            if (!grown) {
+                result = BP_ERROR_MEMORY;
+                break;
+            }
+            *contacts = grown;
+        }
+        fill_info(e, &(*contacts)[(*count)++]);
+    }
+    bp_contact_plan_unlock();
+
+    if (result != BP_SUCCESS) {
+        free(*contacts);
+        *contacts = NULL;
+        *count = 0;
+    }
+    return result;
+}
+
+// The contact open at after, or else the first one starting later
+int bp_contact_plan_next(const char *from_eid, const char *to_eid, time_t after, bp_contact_info_t *contact) {
+    uint64_t from_node, to_node;
+    if (!contact || !to_eid || !g_bp_context.initialized)
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+    if (!bp_contact_plan_node_of(from_eid, &from_node) || !bp_contact_plan_node_of(to_eid, &to_node))
+        return BP_ERROR_INVALID_ARGS;
+
+    int result = bp_contact_plan_read_lock();
+    if (result != BP_SUCCESS) return result;
+
+    const plan_table_t *table = &g_plan.tables[BP_CONTACT_PLAN_CONTACT];
+    int64_t from = node_index(from_node, 0);
+    int64_t to = node_index(to_node, 0);
+    uint32_t lo = 0, hi = 0;
+    if (from >= 0 && to >= 0) pair_run(table, (uint32_t)from, (uint32_t)to, &lo, &hi);
+
+    const bp_contact_plan_entry_t *e = next_in_run(table, lo, hi, after, 0);
+    if (e) fill_info(e, contact);
+    bp_contact_plan_unlock();
+    return e ? BP_SUCCESS : BP_ERROR_NOT_FOUND;
+}
+
+// Books bytes sent to a neighbor against the local contact open at when, or the next one;
+// a contact whose residual volume runs out is no longer routed over
+int bp_contact_plan_consume(const char *neighbor_eid, time_t when, uint64_t bytes) {
+    uint64_t local_node, neighbor_node;
+    if (!neighbor_eid || !g_bp_context.initialized)
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+    if (!bp_contact_plan_node_of(NULL, &local_node) || !bp_contact_plan_node_of(neighbor_eid, &neighbor_node))
+        return BP_ERROR_INVALID_ARGS;
+
+    // Residual volume changes no ordering, so it is updated in place under the write lock
+    pthread_rwlock_wrlock(&g_plan.lock);
+    int result = g_plan.dirty ? rebuild() : BP_SUCCESS;
+    const plan_table_t *table = &g_plan.tables[BP_CONTACT_PLAN_CONTACT];
+    int64_t local = node_index(local_node, 0);
+    int64_t neighbor = node_index(neighbor_node, 0);
+    uint32_t lo = 0, hi = 0;
+    if (result == BP_SUCCESS && local >= 0 && neighbor >= 0) pair_run(table, (uint32_t)local, (uint32_t)neighbor, &lo, &hi);
+
+    bp_contact_plan_entry_t *e = result == BP_SUCCESS ? next_in_run(table, lo, hi, when, 1) : NULL;
+    if (e) e->residual = e->residual > bytes ? e->residual - bytes : 0;
+    pthread_rwlock_unlock(&g_plan.lock);
+
+    if (result != BP_SUCCESS) return result;
+    if (!e) return BP_ERROR_NOT_FOUND;
+    bp_route_cache_invalidate(neighbor_eid);
+    return BP_SUCCESS;
+}
\ No newline at end of file
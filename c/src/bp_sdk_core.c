@@ -2,44 +2,14 @@
 #include "../bpv7/include/bp.h"
 #include "../ici/include/ion.h"
 #include "../ici/include/sdr.h"
+#include "../bpv7/library/bpP.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
 #include <unistd.h>
-
-typedef struct {
-    char *node_id;
-    char *config_file;
-    int initialized;
-    pthread_mutex_t mutex;
-    BpSAP sap;
-    struct {
-        bp_endpoint_t **endpoints;
-        int count;
-        int capacity;
-    } endpoints;
-    struct {
-        bp_cla_t **clas;
-        int count;
-        int capacity;
-    } clas;
-    struct {
-        bp_routing_t **routing;
-        int count;
-        int capacity;
-    } routing;
-    struct {
-        bp_storage_t **storage;
-        int count;
-        int capacity;
-    } storage;
-    struct {
-        bp_security_t **security;
-        int count;
-        int capacity;
-    } security;
-} bp_context_t;
+#include <limits.h>
+#include <sys/stat.h>
 
 bp_context_t g_bp_context = {0};
 
@@ -49,28 +19,59 @@ static const char *error_messages[] = {
     "Routing error", "Storage error", "Security error"
 };
 
-int ensure_capacity(void ***array, int *capacity, int needed, size_t element_size) {
-    if (needed >= *capacity) {
-        int new_capacity = *capacity == 0 ? 8 : *capacity * 2;
-        while (new_capacity <= needed) new_capacity *= 2;
-        
-        void **new_array = realloc(*array, new_capacity * element_size);
-        if (!new_array) return BP_ERROR_MEMORY;
-        
-        *array = new_array;
-        *capacity = new_capacity;
+uint64_t bp_hash_string(const char *str) {
+    uint64_t hash = 1469598103934665603ULL;
+    while (*str) {
+        hash ^= (unsigned char)*str++;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void bp_deadline_after_ms(struct timespec *deadline, int timeout_ms) {
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    deadline->tv_sec += timeout_ms / 1000;
+    deadline->tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+static const char *routing_name(const void *item) {
+    return ((const bp_routing_t*)item)->algorithm_name;
+}
+
+static const char *security_name(const void *item) {
+    return ((const bp_security_t*)item)->security_name;
+}
+
+static void destroy_registries(void) {
+    bp_registry_destroy(&g_bp_context.endpoints);
+    bp_registry_destroy(&g_bp_context.clas);
+    bp_registry_destroy(&g_bp_context.bonds);
+    bp_registry_destroy(&g_bp_context.routing);
+    bp_registry_destroy(&g_bp_context.storage);
+    bp_registry_destroy(&g_bp_context.security);
+}
+
+static int init_registries(void) {
+    if (bp_registry_init(&g_bp_context.endpoints, NULL) != BP_SUCCESS ||
+        bp_registry_init(&g_bp_context.clas, bp_cla_entry_name) != BP_SUCCESS ||
+        bp_registry_init(&g_bp_context.bonds, bp_cla_bond_name) != BP_SUCCESS ||
+        bp_registry_init(&g_bp_context.routing, routing_name) != BP_SUCCESS ||
+        bp_registry_init(&g_bp_context.storage, NULL) != BP_SUCCESS ||
+        bp_registry_init(&g_bp_context.security, security_name) != BP_SUCCESS) {
+        destroy_registries();
+        return BP_ERROR_MEMORY;
     }
     return BP_SUCCESS;
 }
 
 static void cleanup_context(void) {
+    destroy_registries();
     free(g_bp_context.node_id);
     free(g_bp_context.config_file);
-    free(g_bp_context.endpoints.endpoints);
-    free(g_bp_context.clas.clas);
-    free(g_bp_context.routing.routing);
-    free(g_bp_context.storage.storage);
-    free(g_bp_context.security.security);
     memset(&g_bp_context, 0, sizeof(g_bp_context));
 }
 
@@ -81,24 +82,40 @@ int bp_init(const char *node_id, const char *config_file) {
     if (pthread_mutex_init(&g_bp_context.mutex, NULL) != 0)
         return BP_ERROR_MEMORY;
 
+    if (pthread_rwlock_init(&g_bp_context.saps.lock, NULL) != 0) {
+        pthread_mutex_destroy(&g_bp_context.mutex);
+        return BP_ERROR_MEMORY;
+    }
+
+    if (init_registries() != BP_SUCCESS) {
+        pthread_rwlock_destroy(&g_bp_context.saps.lock);
+        pthread_mutex_destroy(&g_bp_context.mutex);
+        cleanup_context();
+        return BP_ERROR_MEMORY;
+    }
+
     g_bp_context.node_id = strdup(node_id);
     if (!g_bp_context.node_id) {
+        pthread_rwlock_destroy(&g_bp_context.saps.lock);
         pthread_mutex_destroy(&g_bp_context.mutex);
+        cleanup_context();
         return BP_ERROR_MEMORY;
     }
 
     if (config_file) {
         g_bp_context.config_file = strdup(config_file);
         if (!g_bp_context.config_file) {
-            cleanup_context();
+            pthread_rwlock_destroy(&g_bp_context.saps.lock);
             pthread_mutex_destroy(&g_bp_context.mutex);
+            cleanup_context();
             return BP_ERROR_MEMORY;
         }
     }
 
     if (bp_attach() < 0) {
-        cleanup_context();
+        pthread_rwlock_destroy(&g_bp_context.saps.lock);
         pthread_mutex_destroy(&g_bp_context.mutex);
+        cleanup_context();
         return BP_ERROR_PROTOCOL;
     }
 
@@ -109,17 +126,26 @@ int bp_init(const char *node_id, const char *config_file) {
 int bp_shutdown(void) {
     if (!g_bp_context.initialized) return BP_ERROR_NOT_INITIALIZED;
 
+    bp_dispatcher_stop();
+    bp_async_stop();
+    bp_async_clear();
+    bp_cla_probe_stop();
+    bp_cla_bond_remove_all();
+    bp_cla_unregister_all();
+    bp_cla_reassembly_clear();
+    bp_route_cache_clear();
+    bp_contact_plan_clear();
+
     pthread_mutex_lock(&g_bp_context.mutex);
     
-    if (g_bp_context.sap) {
-        bp_close(g_bp_context.sap);
-        g_bp_context.sap = NULL;
-    }
+    bp_sap_cache_close_all();
+    pthread_rwlock_destroy(&g_bp_context.saps.lock);
 
     bp_detach();
-    cleanup_context();
+    bp_bundle_pool_trim();
     pthread_mutex_unlock(&g_bp_context.mutex);
     pthread_mutex_destroy(&g_bp_context.mutex);
+    cleanup_context();
     
     return BP_SUCCESS;
 }
@@ -157,18 +183,11 @@ int bp_endpoint_register(bp_endpoint_t *endpoint) {
     if (!endpoint || !endpoint->endpoint_id || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    pthread_mutex_lock(&g_bp_context.mutex);
-    
-    int result = ensure_capacity((void***)&g_bp_context.endpoints.endpoints, 
-                               &g_bp_context.endpoints.capacity, 
-                               g_bp_context.endpoints.count, 
-                               sizeof(bp_endpoint_t*));
-    
+    int result = bp_registry_add(&g_bp_context.endpoints, endpoint, NULL);
     if (result == BP_SUCCESS) {
-        g_bp_context.endpoints.endpoints[g_bp_context.endpoints.count++] = endpoint;
+        result = bp_dispatch_add_endpoint(endpoint);
+        if (result != BP_SUCCESS) bp_endpoint_unregister(endpoint);
     }
-    
-    pthread_mutex_unlock(&g_bp_context.mutex);
     return result;
 }
 
@@ -176,21 +195,10 @@ int bp_endpoint_unregister(bp_endpoint_t *endpoint) {
     if (!endpoint || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    pthread_mutex_lock(&g_bp_context.mutex);
-    
-    for (int i = 0; i < g_bp_context.endpoints.count; i++) {
-        if (g_bp_context.endpoints.endpoints[i] == endpoint) {
-            memmove(&g_bp_context.endpoints.endpoints[i], 
-                   &g_bp_context.endpoints.endpoints[i + 1], 
-                   (g_bp_context.endpoints.count - i - 1) * sizeof(bp_endpoint_t*));
-            g_bp_context.endpoints.count--;
-            pthread_mutex_unlock(&g_bp_context.mutex);
-            return BP_SUCCESS;
-        }
-    }
-    
-    pthread_mutex_unlock(&g_bp_context.mutex);
-    return BP_ERROR_NOT_FOUND;
+    bp_dispatch_remove_endpoint(endpoint);
+    int result = bp_registry_remove(&g_bp_context.endpoints, NULL, endpoint, NULL);
+    if (result == BP_SUCCESS) bp_sap_cache_evict(endpoint->endpoint_id);
+    return result;
 }
 
 int bp_send(const char *source_eid, const char *dest_eid, const void *payload, size_t payload_len, 
@@ -199,114 +207,381 @@ int bp_send(const char *source_eid, const char *dest_eid, const void *payload, s
     if (!source_eid || !dest_eid || !payload || payload_len == 0 || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    BpSAP sap;
-    if (bp_open((char*)source_eid, &sap) < 0) return BP_ERROR_PROTOCOL;
+    bp_send_req_t req = {
+        .source_eid = source_eid,
+        .dest_eid = dest_eid,
+        .payload = payload,
+        .payload_len = payload_len,
+        .priority = priority,
+        .custody = custody,
+        .ttl = ttl,
+        .report_to_eid = report_to_eid
+    };
+
+    int result;
+    bp_send_batch(&req, 1, &result);
+    return result;
+}
+
+static int validate_send_req(const bp_send_req_t *req) {
+    return req->source_eid && req->dest_eid && req->payload && req->payload_len > 0 &&
+           req->ttl > 0 && req->ttl <= INT_MAX;
+}
+
+static BpCustodySwitch custody_switch(bp_custody_t custody) {
+    switch (custody) {
+        case BP_CUSTODY_REQUIRED: return SourceCustodyRequired;
+        case BP_CUSTODY_OPTIONAL: return SourceCustodyOptional;
+        default: return NoCustodyRequested;
+    }
+}
+
+// Hands a ZCO to ION inside the caller's transaction. ION owns the ZCO once the bundle is
+// accepted; a rejected ZCO is destroyed here. BP_ERROR_PROTOCOL means the transaction is lost.
+static int submit_zco(Sdr sdr, bp_sap_entry_t *sap_entry, const char *dest_eid, const char *report_to_eid,
+                      bp_priority_t priority, bp_custody_t custody, uint32_t ttl, Object zco) {
+    BpAncillaryData ancillary = {0};
+    Object bundle;
+    int accepted = bpSend(&sap_entry->sap->endpointMetaEid, (char*)dest_eid, (char*)report_to_eid, (int)ttl,
+                          priority, custody_switch(custody), 0, 0, &ancillary, zco, &bundle, 0);
+    if (accepted > 0) return BP_SUCCESS;
+
+    zco_destroy(sdr, zco);
+    return accepted == 0 ? BP_ERROR_INVALID_ARGS : BP_ERROR_PROTOCOL;
+}
+
+static int send_payload(Sdr sdr, const bp_send_req_t *req, bp_sap_entry_t *sap_entry) {
+    Object payload = sdr_malloc(sdr, req->payload_len);
+    if (!payload) return BP_ERROR_MEMORY;
+    sdr_write(sdr, payload, (char*)req->payload, req->payload_len);
+
+    Object zco = ionCreateZco(ZcoSdrSource, payload, 0, req->payload_len, req->priority, 0, ZcoOutbound, NULL);
+    if (zco == 0 || zco == (Object)ERROR) {
+        sdr_free(sdr, payload);
+        return zco == 0 ? BP_ERROR_MEMORY : BP_ERROR_PROTOCOL;
+    }
+
+    return submit_zco(sdr, sap_entry, req->dest_eid, req->report_to_eid, req->priority, req->custody, req->ttl, zco);
+}
+
+int bp_send_batch(const bp_send_req_t *reqs, size_t n, int *results) {
+    if (!reqs || n == 0 || !results || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    uint64_t started = bp_stats_now_ns();
+    bp_sap_entry_t *single_sap = NULL;
+    bp_sap_entry_t **saps = (n == 1) ? &single_sap : calloc(n, sizeof(bp_sap_entry_t*));
+    if (!saps) return BP_ERROR_MEMORY;
 
     Sdr sdr = bp_get_sdr();
-    if (!sdr) {
-        bp_close(sap);
-        return BP_ERROR_PROTOCOL;
+    bp_sap_entry_t *sap_entry = NULL;
+    const char *sap_eid = NULL;
+
+    for (size_t i = 0; i < n; i++) {
+        if (!validate_send_req(&reqs[i])) {
+            results[i] = BP_ERROR_INVALID_ARGS;
+        } else if (!sdr) {
+            results[i] = BP_ERROR_PROTOCOL;
+        } else if (sap_eid && strcmp(sap_eid, reqs[i].source_eid) == 0) {
+            results[i] = BP_SUCCESS;
+            bp_sap_cache_hold(sap_entry);
+        } else {
+            results[i] = bp_sap_cache_get_source(reqs[i].source_eid, &sap_entry);
+            sap_eid = (results[i] == BP_SUCCESS) ? reqs[i].source_eid : NULL;
+        }
+        if (results[i] == BP_SUCCESS) saps[i] = sap_entry;
     }
 
-    Object payload_obj = sdr_malloc(sdr, payload_len);
-    if (!payload_obj) {
-        bp_close(sap);
-        return BP_ERROR_MEMORY;
+    // Every payload is copied, wrapped in a ZCO and handed to ION in a single SDR transaction
+    if (sdr) {
+        sdr_begin_xn(sdr);
+        int failure = BP_SUCCESS;
+        for (size_t i = 0; i < n && failure == BP_SUCCESS; i++) {
+            if (results[i] != BP_SUCCESS) continue;
+            results[i] = send_payload(sdr, &reqs[i], saps[i]);
+            if (results[i] == BP_ERROR_PROTOCOL) failure = BP_ERROR_PROTOCOL;
+        }
+
+        if (failure != BP_SUCCESS) {
+            sdr_cancel_xn(sdr);
+        } else if (sdr_end_xn(sdr) < 0) {
+            failure = BP_ERROR_STORAGE;
+        }
+
+        // A lost transaction takes every bundle of the batch with it
+        for (size_t i = 0; i < n && failure != BP_SUCCESS; i++) {
+            if (results[i] == BP_SUCCESS) results[i] = failure;
+        }
     }
 
-    Object zco = ionCreateZco(ZcoSdrSource, payload_obj, 0, payload_len, priority, 0, ZcoInbound, NULL);
-    if (!zco) {
-        bp_close(sap);
-        return BP_ERROR_MEMORY;
+    int batch_result = BP_SUCCESS;
+    uint64_t elapsed = bp_stats_now_ns() - started;
+    for (size_t i = 0; i < n; i++) {
+        bp_stats_entity_t *stats = saps[i] ? saps[i]->stats : NULL;
+        if (results[i] == BP_SUCCESS) {
+            // Every request in the batch waited for the whole batch
+            bp_stats_add(BP_STAT_SENT, 1);
+            bp_stats_add(BP_STAT_BYTES_SENT, reqs[i].payload_len);
+            bp_stats_observe(BP_HISTOGRAM_PAYLOAD_SIZE, reqs[i].payload_len);
+            bp_stats_observe(BP_HISTOGRAM_SEND_LATENCY, elapsed);
+            bp_stats_entity_add(stats, BP_ENTITY_SENT, 1);
+            bp_stats_entity_add(stats, BP_ENTITY_BYTES_SENT, reqs[i].payload_len);
+        } else {
+            if (results[i] != BP_ERROR_INVALID_ARGS) {
+                bp_stats_add(BP_STAT_DELETED, 1);
+                bp_stats_entity_add(stats, BP_ENTITY_ERRORS, 1);
+            }
+            if (batch_result == BP_SUCCESS) batch_result = results[i];
+        }
+        if (saps[i]) bp_sap_cache_put(saps[i]);
     }
 
+    if (saps != &single_sap) free(saps);
+    return batch_result;
+}
+
+int bp_send_file(const char *source_eid, const char *dest_eid, const char *path, size_t offset, size_t length, 
+                 bp_priority_t priority, bp_custody_t custody, uint32_t ttl, const char *report_to_eid) {
+    if (!source_eid || !dest_eid || !path || ttl == 0 || ttl > INT_MAX || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    uint64_t started = bp_stats_now_ns();
+    char full_path[PATH_MAX];
+    if (!realpath(path, full_path)) return BP_ERROR_NOT_FOUND;
+
+    struct stat st;
+    if (stat(full_path, &st) != 0 || !S_ISREG(st.st_mode)) return BP_ERROR_INVALID_ARGS;
+
+    size_t file_size = (size_t)st.st_size;
+    if (offset >= file_size) return BP_ERROR_INVALID_ARGS;
+    if (length == 0) length = file_size - offset;
+    if (length > file_size - offset) return BP_ERROR_INVALID_ARGS;
+
+    Sdr sdr = bp_get_sdr();
+    if (!sdr) return BP_ERROR_PROTOCOL;
+
+    bp_sap_entry_t *sap_entry;
+    int sap_result = bp_sap_cache_get_source(source_eid, &sap_entry);
+    if (sap_result != BP_SUCCESS) return sap_result;
+
+    // The ZCO references the file in place; only the file reference lives in the SDR heap
     sdr_begin_xn(sdr);
-    sdr_write(sdr, payload_obj, (char*)payload, payload_len);
-    sdr_end_xn(sdr);
+    int result = BP_ERROR_STORAGE;
+    Object file_ref = zco_create_file_ref(sdr, full_path, NULL, ZcoOutbound);
+    if (file_ref) {
+        Object zco = ionCreateZco(ZcoFileSource, file_ref, offset, length, priority, 0, ZcoOutbound, NULL);
+        if (zco == 0 || zco == (Object)ERROR) {
+            result = zco == 0 ? BP_ERROR_MEMORY : BP_ERROR_PROTOCOL;
+        } else {
+            result = submit_zco(sdr, sap_entry, dest_eid, report_to_eid, priority, custody, ttl, zco);
+        }
 
-    BpCustodySwitch custodySwitch = (custody == BP_CUSTODY_REQUIRED) ? SourceCustodyRequired :
-                                   (custody == BP_CUSTODY_OPTIONAL) ? SourceCustodyOptional :
-                                   NoCustodyRequested;
+        // Drop our reference; ION frees the file reference once the ZCO no longer needs it
+        zco_destroy_file_ref(sdr, file_ref);
+    }
+
+    if (result == BP_ERROR_PROTOCOL || result == BP_ERROR_STORAGE) {
+        sdr_cancel_xn(sdr);
+    } else if (sdr_end_xn(sdr) < 0) {
+        result = BP_ERROR_STORAGE;
+    }
+
+    if (result != BP_SUCCESS) {
+        if (result != BP_ERROR_INVALID_ARGS) {
+            bp_stats_add(BP_STAT_DELETED, 1);
+            bp_stats_entity_add(sap_entry->stats, BP_ENTITY_ERRORS, 1);
+        }
+        bp_sap_cache_put(sap_entry);
+        return result;
+    }
 
-    // Simple approach: create ZCO and close SAP, let ION handle the sending
-    bp_close(sap);
+    bp_stats_add(BP_STAT_SENT, 1);
+    bp_stats_entity_add(sap_entry->stats, BP_ENTITY_SENT, 1);
+    bp_stats_entity_add(sap_entry->stats, BP_ENTITY_BYTES_SENT, length);
+    bp_sap_cache_put(sap_entry);
+    bp_stats_add(BP_STAT_BYTES_SENT, length);
+    bp_stats_observe(BP_HISTOGRAM_PAYLOAD_SIZE, length);
+    bp_stats_observe(BP_HISTOGRAM_SEND_LATENCY, bp_stats_now_ns() - started);
     return BP_SUCCESS;
 }
 
-int bp_receive(bp_endpoint_t *endpoint, bp_bundle_t **bundle, int timeout_ms) {
-    if (!endpoint || !bundle || !g_bp_context.initialized) 
+static int receive_delivery(bp_endpoint_t *endpoint, BpDelivery *delivery, int timeout_ms, 
+                            bp_sap_entry_t **sap_entry) {
+    int sap_result = bp_sap_cache_get(endpoint->endpoint_id, sap_entry);
+    if (sap_result != BP_SUCCESS) return sap_result;
+
+    uint64_t started = bp_stats_now_ns();
+    int result = bp_sap_take_delivery(*sap_entry, delivery, (timeout_ms > 0) ? timeout_ms : BP_SAP_WAIT_FOREVER);
+    if (result == BP_SUCCESS) {
+        bp_stats_observe(BP_HISTOGRAM_RECEIVE_LATENCY, bp_stats_now_ns() - started);
+    } else {
+        bp_sap_cache_put(*sap_entry);
+    }
+    return result;
+}
+
+// Bundles that ION hands to an application endpoint; CLA ingress counts as received instead
+static void count_delivery(bp_sap_entry_t *sap_entry, size_t payload_len) {
+    bp_stats_add(BP_STAT_DELIVERED, 1);
+    bp_stats_add(BP_STAT_BYTES_RECEIVED, payload_len);
+    bp_stats_observe(BP_HISTOGRAM_PAYLOAD_SIZE, payload_len);
+    bp_stats_entity_add(sap_entry->stats, BP_ENTITY_RECEIVED, 1);
+    bp_stats_entity_add(sap_entry->stats, BP_ENTITY_BYTES_RECEIVED, payload_len);
+}
+
+int bp_endpoint_get_fd(bp_endpoint_t *endpoint, int *fd) {
+    if (!endpoint || !fd || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    BpSAP sap;
-    if (bp_open(endpoint->endpoint_id, &sap) < 0) return BP_ERROR_PROTOCOL;
+    bp_sap_entry_t *sap_entry;
+    int sap_result = bp_sap_cache_get(endpoint->endpoint_id, &sap_entry);
+    if (sap_result != BP_SUCCESS) return sap_result;
 
-    BpDelivery delivery;
-    int timeout_seconds = (timeout_ms > 0) ? (timeout_ms / 1000) : BP_BLOCKING;
-    
-    int result = bp_receive(sap, &delivery, timeout_seconds);
-    if (result < 0) {
-        bp_close(sap);
-        return BP_ERROR_PROTOCOL;
-    }
+    // The descriptor stays valid until the endpoint is unregistered
+    int result = bp_sap_get_fd(sap_entry, fd);
+    bp_sap_cache_put(sap_entry);
+    return result;
+}
 
-    if (delivery.result != BpPayloadPresent) {
-        bp_close(sap);
-        return (delivery.result == BpReceptionTimedOut) ? BP_ERROR_TIMEOUT : BP_ERROR_PROTOCOL;
-    }
+int bp_bundle_from_delivery(bp_sap_entry_t *sap_entry, BpDelivery *delivery, bp_bundle_t **bundle) {
+    Sdr sdr = bp_get_sdr();
+    size_t eid_len = delivery->bundleSourceEid ? strlen(delivery->bundleSourceEid) + 1 : 0;
+    size_t adu_len = zco_source_data_length(sdr, delivery->adu);
 
-    bp_bundle_t *new_bundle = malloc(sizeof(bp_bundle_t));
+    // Header, source EID and payload come from one pooled block when they fit
+    bp_bundle_t *new_bundle = bp_bundle_alloc(eid_len, adu_len);
     if (!new_bundle) {
-        bp_release_delivery(&delivery, 1);
-        bp_close(sap);
+        bp_release_delivery(delivery, 1);
         return BP_ERROR_MEMORY;
     }
 
-    memset(new_bundle, 0, sizeof(bp_bundle_t));
-    
-    if (delivery.bundleSourceEid) {
-        new_bundle->source_eid = strdup(delivery.bundleSourceEid);
-    }
-    new_bundle->creation_time.msec = delivery.bundleCreationTime.msec;
-    new_bundle->creation_time.count = delivery.bundleCreationTime.count;
-    new_bundle->ttl = delivery.timeToLive;
+    if (eid_len > 0) memcpy(new_bundle->source_eid, delivery->bundleSourceEid, eid_len);
+    new_bundle->creation_time.msec = delivery->bundleCreationTime.msec;
+    new_bundle->creation_time.count = delivery->bundleCreationTime.count;
+    new_bundle->ttl = delivery->timeToLive;
 
     // Read payload from ZCO
-    ZcoReader reader;
-    zco_start_receiving(delivery.adu, &reader);
-    size_t adu_len = zco_source_data_length(bp_get_sdr(), delivery.adu);
-    
     if (adu_len > 0) {
-        new_bundle->payload = malloc(adu_len);
-        if (!new_bundle->payload) {
-            bp_bundle_free(new_bundle);
-            bp_release_delivery(&delivery, 1);
-            bp_close(sap);
-            return BP_ERROR_MEMORY;
-        }
-        
-        zco_receive_source(bp_get_sdr(), &reader, adu_len, (char*)new_bundle->payload);
-        new_bundle->payload_len = adu_len;
+        ZcoReader reader;
+        zco_start_receiving(delivery->adu, &reader);
+        zco_receive_source(sdr, &reader, adu_len, (char*)new_bundle->payload);
     }
 
-    bp_release_delivery(&delivery, 1);
-    bp_close(sap);
+    bp_release_delivery(delivery, 1);
+    count_delivery(sap_entry, adu_len);
     
     *bundle = new_bundle;
     return BP_SUCCESS;
 }
 
-int bp_bundle_free(bp_bundle_t *bundle) {
-    if (!bundle) return BP_ERROR_INVALID_ARGS;
+int bp_receive(bp_endpoint_t *endpoint, bp_bundle_t **bundle, int timeout_ms) {
+    if (!endpoint || !bundle || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    BpDelivery delivery;
+    bp_sap_entry_t *sap_entry;
+    int result = receive_delivery(endpoint, &delivery, timeout_ms, &sap_entry);
+    if (result != BP_SUCCESS) return result;
+
+    result = bp_bundle_from_delivery(sap_entry, &delivery, bundle);
+    bp_sap_cache_put(sap_entry);
+    return result;
+}
+
+int bp_receive_view(bp_endpoint_t *endpoint, bp_delivery_t **delivery, int timeout_ms) {
+    if (!endpoint || !delivery || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    bp_delivery_lease_t *lease = malloc(sizeof(bp_delivery_lease_t));
+    if (!lease) return BP_ERROR_MEMORY;
+
+    memset(lease, 0, sizeof(bp_delivery_lease_t));
+
+    bp_sap_entry_t *sap_entry;
+    int result = receive_delivery(endpoint, &lease->delivery, timeout_ms, &sap_entry);
+    if (result != BP_SUCCESS) {
+        free(lease);
+        return result;
+    }
+
+    Sdr sdr = bp_get_sdr();
+    sdr_begin_xn(sdr);
+    zco_start_receiving(lease->delivery.adu, &lease->reader);
+    lease->view.payload_len = zco_source_data_length(sdr, lease->delivery.adu);
+    sdr_end_xn(sdr);
+
+    // Metadata points into the ION delivery, which stays alive until bp_delivery_release()
+    lease->view.source_eid = lease->delivery.bundleSourceEid;
+    lease->view.creation_time.msec = lease->delivery.bundleCreationTime.msec;
+    lease->view.creation_time.count = lease->delivery.bundleCreationTime.count;
+    lease->view.ttl = lease->delivery.timeToLive;
+    count_delivery(sap_entry, lease->view.payload_len);
+    bp_sap_cache_put(sap_entry);
+
+    *delivery = &lease->view;
+    return BP_SUCCESS;
+}
+
+int bp_delivery_read(bp_delivery_t *delivery, void *buffer, size_t len, size_t *bytes_read) {
+    if (!delivery || !buffer || !bytes_read) return BP_ERROR_INVALID_ARGS;
+
+    bp_delivery_lease_t *lease = (bp_delivery_lease_t*)delivery;
+    size_t remaining = delivery->payload_len - lease->offset;
+    size_t chunk = (len < remaining) ? len : remaining;
+
+    *bytes_read = 0;
+    if (chunk == 0) return BP_SUCCESS;
 
-    free(bundle->eid);
-    free(bundle->source_eid);
-    free(bundle->dest_eid);
-    free(bundle->report_to_eid);
-    free(bundle->payload);
-    free(bundle);
+    Sdr sdr = bp_get_sdr();
+    sdr_begin_xn(sdr);
+    vast received = zco_receive_source(sdr, &lease->reader, chunk, (char*)buffer);
+    if (sdr_end_xn(sdr) < 0 || received < 0) return BP_ERROR_PROTOCOL;
+
+    lease->offset += (size_t)received;
+    *bytes_read = (size_t)received;
+    return BP_SUCCESS;
+}
+
+int bp_delivery_release(bp_delivery_t *delivery) {
+    if (!delivery) return BP_ERROR_INVALID_ARGS;
+
+    bp_delivery_lease_t *lease = (bp_delivery_lease_t*)delivery;
+    bp_release_delivery(&lease->delivery, 1);
+    free(lease);
     return BP_SUCCESS;
 }
 
+int bp_receive_stream(bp_endpoint_t *endpoint, bp_sink_callback_t sink, void *context, 
+                      size_t chunk_size, int timeout_ms) {
+    if (!endpoint || !sink || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    if (chunk_size == 0) chunk_size = BP_STREAM_DEFAULT_CHUNK;
+
+    char *chunk = malloc(chunk_size);
+    if (!chunk) return BP_ERROR_MEMORY;
+
+    bp_delivery_t *delivery;
+    int result = bp_receive_view(endpoint, &delivery, timeout_ms);
+    if (result != BP_SUCCESS) {
+        free(chunk);
+        return result;
+    }
+
+    // Only one chunk is resident at a time, however large the ADU is
+    size_t bytes_read;
+    while ((result = bp_delivery_read(delivery, chunk, chunk_size, &bytes_read)) == BP_SUCCESS && bytes_read > 0) {
+        if (sink(delivery, chunk, bytes_read, context) != 0) {
+            result = BP_ERROR_PROTOCOL;
+            break;
+        }
+    }
+
+    bp_delivery_release(delivery);
+    free(chunk);
+    return result;
+}
+
 const char *bp_strerror(bp_result_t result) {
     int index = -result;
     return (index >= 0 && index < (int)(sizeof(error_messages) / sizeof(error_messages[0]))) 
@@ -0,0 +1,421 @@
+#include "bp_sdk_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+
+extern bp_context_t g_bp_context;
+
+typedef struct dispatch_watch {
+    bp_endpoint_t *endpoint;
+    bp_sap_entry_t *sap;
+    int fd;
+    int inflight;
+    int removed;
+    int failed;
+    int detached;
+    struct dispatch_watch *next;
+} dispatch_watch_t;
+
+typedef struct {
+    bp_bundle_t *bundle;
+    dispatch_watch_t *watch;
+} dispatch_item_t;
+
+static struct {
+    int running;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    pthread_cond_t changed;
+    dispatch_item_t *queue;
+    int queue_depth;
+    int head;
+    int count;
+    pthread_t poller;
+    pthread_t *workers;
+    int worker_count;
+    dispatch_watch_t *watches;
+    int generation;
+    int generation_seen;
+    int wake_fds[2];
+} g_dispatch = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+// Set on the poller and worker threads, where callbacks run and nothing may wait for them
+static __thread int t_dispatcher_thread;
+
+static void wake_poller(void) {
+    char byte = 1;
+    ssize_t written = write(g_dispatch.wake_fds[1], &byte, 1);
+    (void)written;
+}
+
+static void notify_status(bp_endpoint_t *endpoint, const char *bundle_id, int status) {
+    if (endpoint->status_callback) {
+        endpoint->status_callback(bundle_id, status, endpoint->context);
+    }
+}
+
+// Caller holds the dispatcher lock. A watch removed from a callback is freed once the poller
+// has rebuilt its fd set without it and no worker is still delivering to it.
+static void reap_detached(void) {
+    dispatch_watch_t **link = &g_dispatch.watches;
+    while (*link) {
+        dispatch_watch_t *watch = *link;
+        if (watch->detached && watch->inflight == 0 && g_dispatch.generation_seen >= watch->detached) {
+            *link = watch->next;
+            bp_sap_cache_put(watch->sap);
+            free(watch);
+        } else {
+            link = &watch->next;
+        }
+    }
+}
+
+// Caller holds the dispatcher lock; blocks while the queue is full so ION keeps the backlog
+static int enqueue(bp_bundle_t *bundle, dispatch_watch_t *watch) {
+    while (g_dispatch.count == g_dispatch.queue_depth && g_dispatch.running && !watch->removed) {
+        pthread_cond_wait(&g_dispatch.not_full, &g_dispatch.lock);
+    }
+    if (!g_dispatch.running || watch->removed) return BP_ERROR_NOT_FOUND;
+
+    int tail = (g_dispatch.head + g_dispatch.count) % g_dispatch.queue_depth;
+    g_dispatch.queue[tail].bundle = bundle;
+    g_dispatch.queue[tail].watch = watch;
+    g_dispatch.count++;
+    watch->inflight++;
+    pthread_cond_signal(&g_dispatch.not_empty);
+    return BP_SUCCESS;
+}
+
+static int rebuild_pollfds(struct pollfd **fds, dispatch_watch_t ***map, int *capacity) {
+    int needed = 1;
+    for (dispatch_watch_t *w = g_dispatch.watches; w; w = w->next) {
+        if (!w->removed && !w->failed) needed++;
+    }
+
+    if (needed > *capacity) {
+        struct pollfd *new_fds = realloc(*fds, needed * sizeof(struct pollfd));
+        if (!new_fds) return -1;
+        *fds = new_fds;
+
+        dispatch_watch_t **new_map = realloc(*map, needed * sizeof(dispatch_watch_t*));
+        if (!new_map) return -1;
+        *map = new_map;
+        *capacity = needed;
+    }
+
+    (*fds)[0].fd = g_dispatch.wake_fds[0];
+    (*fds)[0].events = POLLIN;
+    (*map)[0] = NULL;
+
+    int n = 1;
+    for (dispatch_watch_t *w = g_dispatch.watches; w; w = w->next) {
+        if (w->removed || w->failed) continue;
+        (*fds)[n].fd = w->fd;
+        (*fds)[n].events = POLLIN;
+        (*map)[n] = w;
+        n++;
+    }
+    return n;
+}
+
+// A single thread waits on every endpoint's pending-delivery fd and feeds the worker queue
+static void *poller_main(void *arg) {
+    (void)arg;
+    struct pollfd *fds = NULL;
+    dispatch_watch_t **map = NULL;
+    int capacity = 0;
+    int nfds = 0;
+
+    t_dispatcher_thread = 1;
+    pthread_mutex_lock(&g_dispatch.lock);
+    while (g_dispatch.running) {
+        if (g_dispatch.generation_seen != g_dispatch.generation) {
+            nfds = rebuild_pollfds(&fds, &map, &capacity);
+            if (nfds < 0) break;
+            g_dispatch.generation_seen = g_dispatch.generation;
+            pthread_cond_broadcast(&g_dispatch.changed);
+            reap_detached();
+        }
+        pthread_mutex_unlock(&g_dispatch.lock);
+
+        int ready = poll(fds, nfds, -1);
+
+        pthread_mutex_lock(&g_dispatch.lock);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char drain[64];
+            while (read(g_dispatch.wake_fds[0], drain, sizeof(drain)) > 0) {}
+        }
+
+        for (int i = 1; i < nfds && g_dispatch.running; i++) {
+            dispatch_watch_t *watch = map[i];
+            if (!(fds[i].revents & POLLIN) || watch->removed) continue;
+
+            pthread_mutex_unlock(&g_dispatch.lock);
+            BpDelivery delivery;
+            bp_bundle_t *bundle = NULL;
+            int result = bp_sap_take_delivery(watch->sap, &delivery, BP_SAP_NO_WAIT);
+            if (result == BP_SUCCESS) result = bp_bundle_from_delivery(watch->sap, &delivery, &bundle);
+            pthread_mutex_lock(&g_dispatch.lock);
+
+            if (result == BP_SUCCESS) {
+                if (enqueue(bundle, watch) != BP_SUCCESS) bp_bundle_free(bundle);
+            } else if (result != BP_ERROR_TIMEOUT) {
+                // The endpoint's fd stays readable after a receive error, so stop polling it
+                watch->failed = 1;
+                g_dispatch.generation++;
+                pthread_mutex_unlock(&g_dispatch.lock);
+                notify_status(watch->endpoint, NULL, result);
+                pthread_mutex_lock(&g_dispatch.lock);
+            }
+        }
+    }
+    pthread_mutex_unlock(&g_dispatch.lock);
+
+    free(fds);
+    free(map);
+    return NULL;
+}
+
+static void *worker_main(void *arg) {
+    (void)arg;
+
+    t_dispatcher_thread = 1;
+    pthread_mutex_lock(&g_dispatch.lock);
+    for (;;) {
+        while (g_dispatch.count == 0 && g_dispatch.running) {
+            pthread_cond_wait(&g_dispatch.not_empty, &g_dispatch.lock);
+        }
+        if (g_dispatch.count == 0) break;
+
+        dispatch_item_t item = g_dispatch.queue[g_dispatch.head];
+        g_dispatch.head = (g_dispatch.head + 1) % g_dispatch.queue_depth;
+        g_dispatch.count--;
+        int deliver = !item.watch->removed;
+        pthread_cond_signal(&g_dispatch.not_full);
+        pthread_mutex_unlock(&g_dispatch.lock);
+
+        if (deliver) {
+            bp_endpoint_t *endpoint = item.watch->endpoint;
+            int result = endpoint->receive_callback(item.bundle, endpoint->context);
+
+            // The callback may have unregistered its own endpoint, which may be gone by now
+            pthread_mutex_lock(&g_dispatch.lock);
+            deliver = !item.watch->detached;
+            pthread_mutex_unlock(&g_dispatch.lock);
+            if (result != 0 && deliver) notify_status(endpoint, item.bundle->source_eid, result);
+        }
+        bp_bundle_free(item.bundle);
+
+        pthread_mutex_lock(&g_dispatch.lock);
+        item.watch->inflight--;
+        pthread_cond_broadcast(&g_dispatch.changed);
+        if (item.watch->detached) reap_detached();
+    }
+    pthread_mutex_unlock(&g_dispatch.lock);
+    return NULL;
+}
+
+// Caller holds the dispatcher lock
+static int add_watch(bp_endpoint_t *endpoint) {
+    for (dispatch_watch_t *w = g_dispatch.watches; w; w = w->next) {
+        if (w->endpoint == endpoint && !w->removed) return BP_ERROR_DUPLICATE;
+    }
+
+    dispatch_watch_t *watch = malloc(sizeof(dispatch_watch_t));
+    if (!watch) return BP_ERROR_MEMORY;
+
+    memset(watch, 0, sizeof(dispatch_watch_t));
+    watch->endpoint = endpoint;
+
+    int result = bp_sap_cache_get(endpoint->endpoint_id, &watch->sap);
+    if (result != BP_SUCCESS) {
+        free(watch);
+        return result;
+    }
+
+    result = bp_sap_get_fd(watch->sap, &watch->fd);
+    if (result != BP_SUCCESS) {
+        bp_sap_cache_put(watch->sap);
+        free(watch);
+        return result;
+    }
+
+    watch->next = g_dispatch.watches;
+    g_dispatch.watches = watch;
+    g_dispatch.generation++;
+    wake_poller();
+    return BP_SUCCESS;
+}
+
+int bp_dispatch_add_endpoint(bp_endpoint_t *endpoint) {
+    if (!endpoint->receive_callback) return BP_SUCCESS;
+
+    pthread_mutex_lock(&g_dispatch.lock);
+    int result = g_dispatch.running ? add_watch(endpoint) : BP_SUCCESS;
+    pthread_mutex_unlock(&g_dispatch.lock);
+    return result;
+}
+
+// Returns once the poller has forgotten the endpoint and no worker is still inside its callback.
+// Called from a dispatcher callback, the removal is deferred instead: nothing more is delivered
+// to the endpoint, but callbacks already running on other workers may still be using it.
+void bp_dispatch_remove_endpoint(bp_endpoint_t *endpoint) {
+    pthread_mutex_lock(&g_dispatch.lock);
+
+    dispatch_watch_t *watch = g_dispatch.watches;
+    while (watch && (watch->endpoint != endpoint || watch->removed)) watch = watch->next;
+    if (!watch) {
+        pthread_mutex_unlock(&g_dispatch.lock);
+        return;
+    }
+
+    watch->removed = 1;
+    int generation = ++g_dispatch.generation;
+    wake_poller();
+    pthread_cond_broadcast(&g_dispatch.not_full);
+
+    if (t_dispatcher_thread) {
+        watch->detached = generation;
+        reap_detached();
+        pthread_mutex_unlock(&g_dispatch.lock);
+        return;
+    }
+
+    while ((g_dispatch.running && g_dispatch.generation_seen < generation) || watch->inflight > 0) {
+        pthread_cond_wait(&g_dispatch.changed, &g_dispatch.lock);
+    }
+
+    // Other removals may have relinked the list while we waited
+    dispatch_watch_t **link = &g_dispatch.watches;
+    while (*link != watch) link = &(*link)->next;
+    *link = watch->next;
+    bp_sap_cache_put(watch->sap);
+    free(watch);
+    pthread_mutex_unlock(&g_dispatch.lock);
+}
+
+static int open_wake_pipe(void) {
+    if (pipe(g_dispatch.wake_fds) < 0) return -1;
+    for (int i = 0; i < 2; i++) {
+        fcntl(g_dispatch.wake_fds[i], F_SETFL, fcntl(g_dispatch.wake_fds[i], F_GETFL) | O_NONBLOCK);
+        fcntl(g_dispatch.wake_fds[i], F_SETFD, FD_CLOEXEC);
+    }
+    return 0;
+}
+
+static void stop_threads(int workers_started, int poller_started) {
+    g_dispatch.running = 0;
+    pthread_cond_broadcast(&g_dispatch.not_empty);
+    pthread_cond_broadcast(&g_dispatch.not_full);
+    wake_poller();
+    pthread_mutex_unlock(&g_dispatch.lock);
+
+    if (poller_started) pthread_join(g_dispatch.poller, NULL);
+    for (int i = 0; i < workers_started; i++) {
+        pthread_join(g_dispatch.workers[i], NULL);
+    }
+
+    pthread_mutex_lock(&g_dispatch.lock);
+    while (g_dispatch.watches) {
+        dispatch_watch_t *next = g_dispatch.watches->next;
+        bp_sap_cache_put(g_dispatch.watches->sap);
+        free(g_dispatch.watches);
+        g_dispatch.watches = next;
+    }
+
+    close(g_dispatch.wake_fds[0]);
+    close(g_dispatch.wake_fds[1]);
+    pthread_cond_destroy(&g_dispatch.not_empty);
+    pthread_cond_destroy(&g_dispatch.not_full);
+    pthread_cond_destroy(&g_dispatch.changed);
+    free(g_dispatch.workers);
+    free(g_dispatch.queue);
+    g_dispatch.workers = NULL;
+    g_dispatch.queue = NULL;
+}
+
+int bp_dispatcher_start(int worker_count, int queue_depth) {
+    if (worker_count <= 0 || queue_depth <= 0 || !g_bp_context.initialized)
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    pthread_mutex_lock(&g_dispatch.lock);
+    if (g_dispatch.running) {
+        pthread_mutex_unlock(&g_dispatch.lock);
+        return BP_ERROR_DUPLICATE;
+    }
+
+    g_dispatch.queue = calloc(queue_depth, sizeof(dispatch_item_t));
+    g_dispatch.workers = calloc(worker_count, sizeof(pthread_t));
+    if (!g_dispatch.queue || !g_dispatch.workers || open_wake_pipe() < 0) {
+        free(g_dispatch.queue);
+        free(g_dispatch.workers);
+        g_dispatch.queue = NULL;
+        g_dispatch.workers = NULL;
+        pthread_mutex_unlock(&g_dispatch.lock);
+        return BP_ERROR_MEMORY;
+    }
+
+    pthread_cond_init(&g_dispatch.not_empty, NULL);
+    pthread_cond_init(&g_dispatch.not_full, NULL);
+    pthread_cond_init(&g_dispatch.changed, NULL);
+    g_dispatch.queue_depth = queue_depth;
+    g_dispatch.worker_count = worker_count;
+    g_dispatch.head = 0;
+    g_dispatch.count = 0;
+    g_dispatch.generation = 1;
+    g_dispatch.generation_seen = 0;
+    g_dispatch.running = 1;
+
+    int result = BP_SUCCESS;
+
+    bp_rcu_read_lock();
+    const bp_snapshot_t *snapshot = bp_registry_read(&g_bp_context.endpoints);
+    for (int i = 0; i < snapshot->count && result == BP_SUCCESS; i++) {
+        bp_endpoint_t *endpoint = snapshot->items[i];
+        if (endpoint->receive_callback) result = add_watch(endpoint);
+    }
+    bp_rcu_read_unlock();
+
+    int workers_started = 0;
+    for (; result == BP_SUCCESS && workers_started < worker_count; workers_started++) {
+        if (pthread_create(&g_dispatch.workers[workers_started], NULL, worker_main, NULL) != 0) {
+            result = BP_ERROR_MEMORY;
+            break;
+        }
+    }
+
+    int poller_started = 0;
+    if (result == BP_SUCCESS) {
+        poller_started = pthread_create(&g_dispatch.poller, NULL, poller_main, NULL) == 0;
+        if (!poller_started) result = BP_ERROR_MEMORY;
+    }
+
+    if (result != BP_SUCCESS) stop_threads(workers_started, poller_started);
+
+    pthread_mutex_unlock(&g_dispatch.lock);
+    return result;
+}
+
+int bp_dispatcher_stop(void) {
+    pthread_mutex_lock(&g_dispatch.lock);
+    if (!g_dispatch.running) {
+        pthread_mutex_unlock(&g_dispatch.lock);
+        return BP_ERROR_NOT_INITIALIZED;
+    }
+
+    // Workers drain whatever is already queued before they exit
+    stop_threads(g_dispatch.worker_count, 1);
+    pthread_mutex_unlock(&g_dispatch.lock);
+    return BP_SUCCESS;
+}
\ No newline at end of file
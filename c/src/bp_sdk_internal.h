@@ -5,59 +5,283 @@
 #include "../bpv7/include/bp.h"
 #include "../ici/include/ion.h"
 #include <pthread.h>
+#include <sys/socket.h>
+
+#define BP_STREAM_DEFAULT_CHUNK (64 * 1024)
+#define BP_SAP_WAIT_FOREVER (-1)
+#define BP_SAP_NO_WAIT 0
+#define BP_CACHE_LINE 64
+
+typedef enum {
+    BP_STAT_SENT,
+    BP_STAT_RECEIVED,
+    BP_STAT_FORWARDED,
+    BP_STAT_DELIVERED,
+    BP_STAT_DELETED,
+    BP_STAT_BYTES_SENT,
+    BP_STAT_BYTES_RECEIVED,
+    BP_STAT_COUNT
+} bp_stat_t;
+
+typedef enum {
+    BP_STATS_ENDPOINT,
+    BP_STATS_CLA,
+    BP_STATS_KIND_COUNT
+} bp_stats_kind_t;
+
+typedef enum {
+    BP_ENTITY_SENT,
+    BP_ENTITY_RECEIVED,
+    BP_ENTITY_BYTES_SENT,
+    BP_ENTITY_BYTES_RECEIVED,
+    BP_ENTITY_ERRORS,
+    BP_ENTITY_STAT_COUNT
+} bp_entity_stat_t;
+
+// Counters for one endpoint EID or CLA; created on first use and kept for the life of the process
+typedef struct bp_stats_entity {
+    uint64_t counters[BP_ENTITY_STAT_COUNT];
+    uint64_t base[BP_ENTITY_STAT_COUNT];
+    char *name;
+    uint64_t hash;
+    struct bp_stats_entity *next;
+} __attribute__((aligned(BP_CACHE_LINE))) bp_stats_entity_t;
+
+// Cached ION service access point, one per EID and kind. Sends use source-only SAPs, which leave
+// reception to other applications; receive SAPs are evicted when their endpoint is unregistered.
+// Receives go through a watcher thread that parks one delivery in a mailbox.
+typedef struct bp_sap_entry {
+    char *eid;
+    uint64_t hash;
+    int source_only;
+    int refs;
+    BpSAP sap;
+    pthread_mutex_t recv_lock;
+    pthread_cond_t recv_cond;
+    pthread_t watcher;
+    int watching;
+    int stopping;
+    int watch_error;
+    int event_fds[2];
+    int pending;
+    BpDelivery delivery;
+    bp_stats_entity_t *stats;
+    struct bp_sap_entry *next;
+} bp_sap_entry_t;
+
+// Immutable, copy-on-write array of registered objects. Readers take it inside
+// bp_rcu_read_lock()/bp_rcu_read_unlock(); writers replace it and free the old one after a grace period.
+// Routing, security and CLA callbacks run inside read sections, so adding or removing registry
+// items from one fails with BP_ERROR_PROTOCOL rather than waiting on its own grace period.
+typedef const char *(*bp_registry_name_fn)(const void *item);
+
+typedef struct {
+    void *item;
+    uint64_t hash;
+    uint32_t handle;
+} bp_registry_entry_t;
+
+// items is dense for iteration; slots is indexed by handle; index is an open-addressed name table
+typedef struct {
+    int count;
+    int slot_count;
+    uint32_t index_mask;
+    bp_registry_entry_t *slots;
+    bp_registry_entry_t *index;
+    void *items[];
+} bp_snapshot_t;
+
+typedef struct {
+    bp_snapshot_t *current;
+    pthread_mutex_t write_lock;
+    bp_registry_name_fn name_of;
+} bp_registry_t;
+
+// Lease on an ION delivery handed out by bp_receive_view(); view must stay first
+typedef struct {
+    bp_delivery_t view;
+    BpDelivery delivery;
+    ZcoReader reader;
+    size_t offset;
+} bp_delivery_lease_t;
 
 typedef struct {
     char *node_id;
     char *config_file;
     int initialized;
     pthread_mutex_t mutex;
-    BpSAP sap;
-    struct {
-        bp_endpoint_t **endpoints;
-        int count;
-        int capacity;
-    } endpoints;
-    struct {
-        bp_cla_t **clas;
-        int count;
-        int capacity;
-    } clas;
-    struct {
-        bp_routing_t **routing;
-        int count;
-        int capacity;
-    } routing;
     struct {
-        bp_storage_t **storage;
+        bp_sap_entry_t **buckets;
+        int bucket_count;
         int count;
-        int capacity;
-    } storage;
-    struct {
-        bp_security_t **security;
-        int count;
-        int capacity;
-    } security;
+        pthread_rwlock_t lock;
+    } saps;
+    bp_registry_t endpoints;
+    bp_registry_t clas;
+    bp_registry_t routing;
+    bp_registry_t storage;
+    bp_registry_t security;
+    bp_registry_t bonds;
 } bp_context_t;
 
 extern bp_context_t g_bp_context;
 
 // Helper functions
-int ensure_capacity(void ***array, int *capacity, int needed, size_t element_size);
+uint64_t bp_hash_string(const char *str);
+void bp_deadline_after_ms(struct timespec *deadline, int timeout_ms);
+
+int bp_bundle_from_delivery(bp_sap_entry_t *entry, BpDelivery *delivery, bp_bundle_t **bundle);
+
+// Bundle allocator; source_eid and payload point at eid_len and payload_len bytes to fill in
+bp_bundle_t *bp_bundle_alloc(size_t eid_len, size_t payload_len);
+void bp_bundle_pool_trim(void);
+
+// Registry
+void bp_rcu_read_lock(void);
+void bp_rcu_read_unlock(void);
+void bp_rcu_synchronize(void);
+int bp_rcu_in_read_section(void);
+int bp_registry_init(bp_registry_t *registry, bp_registry_name_fn name_of);
+void bp_registry_destroy(bp_registry_t *registry);
+const bp_snapshot_t *bp_registry_read(bp_registry_t *registry);
+void *bp_registry_find(bp_registry_t *registry, const bp_snapshot_t *snapshot, const char *name, uint32_t *handle);
+void *bp_registry_get(const bp_snapshot_t *snapshot, uint32_t handle);
+int bp_registry_add(bp_registry_t *registry, void *item, uint32_t *handle);
+int bp_registry_remove(bp_registry_t *registry, const char *name, void *item, void **removed);
+int bp_registry_remove_handle(bp_registry_t *registry, uint32_t handle, void **removed);
+int bp_registry_replace(bp_registry_t *registry, void *item, void *replacement, void **removed);
+
+// Statistics; lock-free for the calling thread, latencies in nanoseconds
+void bp_stats_add(bp_stat_t stat, uint64_t n);
+void bp_stats_observe(bp_histogram_id_t histogram, uint64_t value);
+uint64_t bp_stats_now_ns(void);
+bp_stats_entity_t *bp_stats_entity(bp_stats_kind_t kind, const char *name);
+void bp_stats_entity_add(bp_stats_entity_t *entity, bp_entity_stat_t stat, uint64_t n);
+
+// SAP cache
+int bp_sap_cache_get(const char *eid, bp_sap_entry_t **entry);
+int bp_sap_cache_get_source(const char *eid, bp_sap_entry_t **entry);
+void bp_sap_cache_hold(bp_sap_entry_t *entry);
+void bp_sap_cache_put(bp_sap_entry_t *entry);
+void bp_sap_cache_evict(const char *eid);
+int bp_sap_take_delivery(bp_sap_entry_t *entry, BpDelivery *delivery, int timeout_ms);
+int bp_sap_get_fd(bp_sap_entry_t *entry, int *fd);
+void bp_sap_cache_close_all(void);
+
+// Receive dispatcher
+int bp_dispatch_add_endpoint(bp_endpoint_t *endpoint);
+void bp_dispatch_remove_endpoint(bp_endpoint_t *endpoint);
+
+// Async send; drops completions left unreaped after bp_async_stop()
+void bp_async_clear(void);
 
 // CLA functions
-int bp_cla_create_tcp(const char *local_addr, uint16_t local_port, bp_cla_t **cla);
-int bp_cla_create_udp(const char *local_addr, uint16_t local_port, bp_cla_t **cla);
-int bp_cla_destroy(bp_cla_t *cla);
-int bp_cla_handle_bundle_receive(bp_cla_t *cla, const void *data, size_t len, const char *source_eid);
-
-// Routing functions
-int bp_routing_create_cgr(bp_routing_t **routing);
-int bp_routing_create_static(bp_routing_t **routing);
-int bp_routing_destroy(bp_routing_t *routing);
-int bp_route_create(const char *dest_eid, const char *next_hop, uint32_t cost, 
-                   float confidence, time_t valid_until, bp_route_t **route);
-int bp_route_destroy(bp_route_t *route);
-int bp_route_list_destroy(bp_route_t *routes, int count);
+const char *bp_cla_entry_name(const void *item);
+void bp_cla_unregister_all(void);
+// Send callbacks get impl, the transport state of a built-in CLA, or cla->context when impl is NULL
+int bp_cla_deliver(bp_cla_t *cla, void *impl, bp_stats_entity_t *stats, const struct iovec *iov, int iovcnt,
+                   const char *dest_addr);
+int bp_cla_deliver_batch(bp_cla_t *cla, void *impl, bp_stats_entity_t *stats, bp_cla_msg_t *msgs, int count);
+bp_cla_t *bp_cla_create_base(const char *protocol, const char *addr, uint16_t port, 
+                             uint32_t max_payload, uint32_t rate);
+void bp_cla_set_impl(bp_cla_t *cla, void *impl, int (*start)(void *impl), void (*release)(void *impl));
+void *bp_cla_get_impl(bp_cla_t *cla);
+int bp_cla_validate_iov(const struct iovec *iov, int iovcnt);
+
+// Registered CLAs as seen by the bonding layer. bp_cla_acquire() pins an entry until bp_cla_release(),
+// so sends through it can block without holding the RCU read lock.
+typedef struct bp_cla_entry bp_cla_entry_t;
+bp_cla_entry_t *bp_cla_acquire(const char *protocol_name);
+void bp_cla_release(bp_cla_entry_t *entry);
+bp_cla_t *bp_cla_entry_cla(bp_cla_entry_t *entry);
+uint64_t bp_cla_entry_eta_ns(bp_cla_entry_t *entry, size_t len, bp_priority_t priority);
+int bp_cla_entry_send(bp_cla_entry_t *entry, const char *dest_addr, const struct iovec *iov, int iovcnt,
+                      bp_priority_t priority);
+
+// Neighbor bonds over several CLAs
+typedef void (*bp_cla_bond_visit_t)(const char *neighbor, const char *protocol_name, const char *dest_addr, void *arg);
+const char *bp_cla_bond_name(const void *item);
+void bp_cla_bond_remove_all(void);
+void bp_cla_bond_foreach(bp_cla_bond_visit_t visit, void *arg);
+
+// Path probing over bond members
+int bp_cla_is_probe(const void *data, size_t len);
+int bp_cla_probe_receive(bp_cla_t *cla, const void *data, size_t len, const char *source);
+int bp_cla_parse_address(const char *text, int family, struct sockaddr_storage *addr, socklen_t *addr_len);
+void bp_cla_format_address(const struct sockaddr_storage *addr, char *text, size_t len);
+
+// Fragmentation to max_payload_size and reassembly of fragments from any CLA
+typedef int (*bp_cla_fragment_fn)(const struct iovec *iov, int iovcnt, void *arg);
+int bp_cla_fragment(const struct iovec *iov, int iovcnt, size_t len, uint32_t max_payload,
+                    bp_cla_fragment_fn emit, void *arg);
+int bp_cla_is_fragment(const void *data, size_t len);
+int bp_cla_reassemble(const char *source, const void *data, size_t len, void **bundle, size_t *bundle_len);
+void bp_cla_reassembly_clear(void);
+
+// Per-CLA token-bucket pacer; a data_rate of 0 leaves the CLA unpaced
+typedef struct bp_cla_pacer bp_cla_pacer_t;
+int bp_cla_pacer_create(uint32_t data_rate, uint32_t max_payload, bp_cla_pacer_t **pacer);
+void bp_cla_pacer_destroy(bp_cla_pacer_t *pacer);
+void bp_cla_pacer_set_rate(bp_cla_pacer_t *pacer, uint32_t data_rate);
+void bp_cla_pacer_set_burst(bp_cla_pacer_t *pacer, bp_priority_t priority, uint32_t burst_bytes);
+uint64_t bp_cla_pacer_take(bp_cla_pacer_t *pacer, size_t len, bp_priority_t priority);
+void bp_cla_pacer_state(bp_cla_pacer_t *pacer, bp_priority_t priority, uint32_t *data_rate, uint64_t *backlog);
+void bp_cla_pacer_wait(bp_cla_pacer_t *pacer, size_t len, bp_priority_t priority);
+
+// Per-CLA outbound queue: a bounded MPSC ring drained by one sender thread
+typedef struct bp_cla_sender bp_cla_sender_t;
+int bp_cla_sender_create(bp_cla_t *cla, void *impl, bp_stats_entity_t *stats, bp_cla_pacer_t *pacer,
+                         bp_cla_sender_t **sender);
+int bp_cla_sender_enqueue(bp_cla_sender_t *sender, const struct iovec *iov, int iovcnt, const char *dest,
+                          bp_priority_t priority);
+void bp_cla_sender_destroy(bp_cla_sender_t *sender);
+void bp_cla_sender_stats(bp_cla_sender_t *sender, bp_cla_queue_stats_t *stats);
+uint64_t bp_cla_sender_backlog(bp_cla_sender_t *sender);
+
+// Per-destination cache of bp_routing_compute() results
+int bp_route_cache_get(const char *dest_eid, bp_route_t **routes, int *route_count);
+uint64_t bp_route_cache_epoch(void);
+void bp_route_cache_put(const char *dest_eid, const bp_route_t *routes, int route_count, uint64_t epoch);
+void bp_route_cache_invalidate(const char *neighbor_eid);
+void bp_route_cache_clear(void);
+
+// Time-indexed contact plan shared by the admin functions and routing engines. Entries name
+// nodes by dense index; a rate or OWLT of 0 removes one.
+typedef enum {
+    BP_CONTACT_PLAN_CONTACT = 0,
+    BP_CONTACT_PLAN_RANGE = 1
+} bp_contact_plan_kind_t;
+
+typedef struct {
+    uint32_t from;
+    uint32_t to;
+    time_t start;
+    time_t end;
+    uint32_t value;
+    uint64_t residual;
+    uint64_t ref;
+} bp_contact_plan_entry_t;
+
+int bp_contact_plan_node_of(const char *eid, uint64_t *node);
+int bp_contact_plan_update(bp_contact_plan_kind_t kind, uint64_t from_node, uint64_t to_node,
+                           time_t start, time_t end, uint32_t value, uint64_t ref);
+int bp_contact_plan_lookup(bp_contact_plan_kind_t kind, uint64_t from_node, uint64_t to_node, time_t start,
+                           bp_contact_plan_entry_t *entry);
+void bp_contact_plan_clear(void);
+
+// Graph access for routing engines, between bp_contact_plan_read_lock() and bp_contact_plan_unlock()
+int bp_contact_plan_read_lock(void);
+void bp_contact_plan_unlock(void);
+int64_t bp_contact_plan_node_index(uint64_t node);
+uint64_t bp_contact_plan_node_id(uint32_t index);
+uint32_t bp_contact_plan_node_count(void);
+uint32_t bp_contact_plan_links(uint32_t node, uint32_t *first);
+uint32_t bp_contact_plan_link_to(uint32_t link);
+const bp_contact_plan_entry_t *bp_contact_plan_link_next(uint32_t link, time_t when, uint64_t volume);
+time_t bp_contact_plan_owlt(uint32_t a, uint32_t b, time_t when);
+
+// Native contact graph routing behind bp_routing_create_cgr()
+void bp_cgr_init(bp_routing_t *routing);
 
 // Security functions
 int bp_security_create_aes_gcm(bp_security_t **security);
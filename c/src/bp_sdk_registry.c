@@ -0,0 +1,357 @@
+#include "bp_sdk_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+// Each reader thread owns a slot holding the epoch it entered its read section in (0 when idle).
+// Writers publish a new snapshot, advance the epoch and wait until no slot still shows an older one.
+// Slots are never unlinked, so writers walk the list without taking slots_lock.
+typedef struct rcu_slot {
+    uint64_t active_epoch;
+    int in_use;
+    struct rcu_slot *next;
+} __attribute__((aligned(BP_CACHE_LINE))) rcu_slot_t;
+
+static struct {
+    uint64_t epoch;
+    rcu_slot_t *slots;
+    pthread_mutex_t slots_lock;
+    pthread_rwlock_t fallback_lock;
+    pthread_mutex_t wait_lock;
+    pthread_cond_t released;
+    int waiters;
+    pthread_once_t once;
+    pthread_key_t key;
+} g_rcu = {
+    .epoch = 1,
+    .slots_lock = PTHREAD_MUTEX_INITIALIZER,
+    .fallback_lock = PTHREAD_RWLOCK_INITIALIZER,
+    .wait_lock = PTHREAD_MUTEX_INITIALIZER,
+    .released = PTHREAD_COND_INITIALIZER,
+    .once = PTHREAD_ONCE_INIT
+};
+
+static __thread rcu_slot_t *t_slot;
+static __thread int t_nesting;
+
+// A writer registers as a waiter before its last look at a slot, and a reader leaving stores
+// its slot before checking for waiters, so one of the two always sees the other
+static void rcu_leave(rcu_slot_t *slot) {
+    __atomic_store_n(&slot->active_epoch, 0, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&g_rcu.waiters, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&g_rcu.wait_lock);
+        pthread_cond_broadcast(&g_rcu.released);
+        pthread_mutex_unlock(&g_rcu.wait_lock);
+    }
+}
+
+static void rcu_slot_release(void *arg) {
+    rcu_slot_t *slot = (rcu_slot_t*)arg;
+    rcu_leave(slot);
+    __atomic_store_n(&slot->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void rcu_init_key(void) {
+    pthread_key_create(&g_rcu.key, rcu_slot_release);
+}
+
+static rcu_slot_t *rcu_slot_acquire(void) {
+    pthread_once(&g_rcu.once, rcu_init_key);
+
+    pthread_mutex_lock(&g_rcu.slots_lock);
+    rcu_slot_t *slot = g_rcu.slots;
+    while (slot && __atomic_load_n(&slot->in_use, __ATOMIC_ACQUIRE)) slot = slot->next;
+
+    if (!slot) {
+        if (posix_memalign((void**)&slot, BP_CACHE_LINE, sizeof(rcu_slot_t)) != 0) {
+            pthread_mutex_unlock(&g_rcu.slots_lock);
+            return NULL;
+        }
+        memset(slot, 0, sizeof(rcu_slot_t));
+        slot->next = g_rcu.slots;
+        __atomic_store_n(&g_rcu.slots, slot, __ATOMIC_RELEASE);
+    }
+    slot->in_use = 1;
+    pthread_mutex_unlock(&g_rcu.slots_lock);
+
+    pthread_setspecific(g_rcu.key, slot);
+    return slot;
+}
+
+void bp_rcu_read_lock(void) {
+    if (t_nesting++ > 0) return;
+
+    if (!t_slot) t_slot = rcu_slot_acquire();
+    if (!t_slot) {
+        // Without a slot this thread cannot be tracked; writers wait for the fallback lock instead
+        pthread_rwlock_rdlock(&g_rcu.fallback_lock);
+        return;
+    }
+    __atomic_store_n(&t_slot->active_epoch, __atomic_load_n(&g_rcu.epoch, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+}
+
+void bp_rcu_read_unlock(void) {
+    if (--t_nesting > 0) return;
+
+    if (!t_slot) {
+        pthread_rwlock_unlock(&g_rcu.fallback_lock);
+        return;
+    }
+    rcu_leave(t_slot);
+}
+
+int bp_rcu_in_read_section(void) {
+    return t_nesting > 0;
+}
+
+static int rcu_slot_blocks(const rcu_slot_t *slot, uint64_t target) {
+    uint64_t active = __atomic_load_n(&slot->active_epoch, __ATOMIC_SEQ_CST);
+    return active != 0 && active < target;
+}
+
+// Must not be called inside a read section: the caller would wait for itself
+void bp_rcu_synchronize(void) {
+    uint64_t target = __atomic_add_fetch(&g_rcu.epoch, 1, __ATOMIC_SEQ_CST);
+
+    for (rcu_slot_t *slot = __atomic_load_n(&g_rcu.slots, __ATOMIC_ACQUIRE); slot; slot = slot->next) {
+        if (!rcu_slot_blocks(slot, target)) continue;
+
+        pthread_mutex_lock(&g_rcu.wait_lock);
+        __atomic_add_fetch(&g_rcu.waiters, 1, __ATOMIC_SEQ_CST);
+        while (rcu_slot_blocks(slot, target)) pthread_cond_wait(&g_rcu.released, &g_rcu.wait_lock);
+        __atomic_sub_fetch(&g_rcu.waiters, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&g_rcu.wait_lock);
+    }
+
+    pthread_rwlock_wrlock(&g_rcu.fallback_lock);
+    pthread_rwlock_unlock(&g_rcu.fallback_lock);
+}
+
+// Handles carry the slot number in the low 16 bits and the slot's reuse count in the high 16,
+// so a handle to an unregistered object never resolves to whatever took its slot
+#define HANDLE_SLOT_BITS 16
+#define HANDLE_SLOT_MASK 0xFFFFu
+#define MAX_SLOTS 0xFFFF
+
+static uint32_t make_handle(int slot, uint32_t generation) {
+    return (generation << HANDLE_SLOT_BITS) | (uint32_t)(slot + 1);
+}
+
+static size_t align_up(size_t size) {
+    return (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+}
+
+// Items, slot table and name index share one allocation
+static bp_snapshot_t *snapshot_alloc(bp_registry_t *registry, int count, int slot_count) {
+    uint32_t index_size = 0;
+    if (registry->name_of) {
+        index_size = 8;
+        while (index_size < (uint32_t)count * 2) index_size *= 2;
+    }
+
+    size_t items_size = align_up(sizeof(bp_snapshot_t) + count * sizeof(void*));
+    size_t slots_size = slot_count * sizeof(bp_registry_entry_t);
+    char *memory = calloc(1, items_size + slots_size + index_size * sizeof(bp_registry_entry_t));
+    if (!memory) return NULL;
+
+    bp_snapshot_t *snapshot = (bp_snapshot_t*)memory;
+    snapshot->count = count;
+    snapshot->slot_count = slot_count;
+    snapshot->slots = (bp_registry_entry_t*)(memory + items_size);
+    if (index_size > 0) {
+        snapshot->index = (bp_registry_entry_t*)(memory + items_size + slots_size);
+        snapshot->index_mask = index_size - 1;
+    }
+    return snapshot;
+}
+
+static void snapshot_index(bp_registry_t *registry, bp_snapshot_t *snapshot) {
+    if (!snapshot->index) return;
+
+    for (int i = 0; i < snapshot->slot_count; i++) {
+        bp_registry_entry_t *slot = &snapshot->slots[i];
+        if (!slot->item) continue;
+
+        slot->hash = bp_hash_string(registry->name_of(slot->item));
+        uint32_t position = (uint32_t)slot->hash & snapshot->index_mask;
+        while (snapshot->index[position].item) position = (position + 1) & snapshot->index_mask;
+        snapshot->index[position] = *slot;
+    }
+}
+
+int bp_registry_init(bp_registry_t *registry, bp_registry_name_fn name_of) {
+    memset(registry, 0, sizeof(bp_registry_t));
+    registry->name_of = name_of;
+
+    registry->current = snapshot_alloc(registry, 0, 0);
+    if (!registry->current) return BP_ERROR_MEMORY;
+
+    if (pthread_mutex_init(&registry->write_lock, NULL) != 0) {
+        free(registry->current);
+        return BP_ERROR_MEMORY;
+    }
+    return BP_SUCCESS;
+}
+
+void bp_registry_destroy(bp_registry_t *registry) {
+    if (!registry->current) return;
+
+    bp_rcu_synchronize();
+    free(registry->current);
+    pthread_mutex_destroy(&registry->write_lock);
+    registry->current = NULL;
+}
+
+const bp_snapshot_t *bp_registry_read(bp_registry_t *registry) {
+    return __atomic_load_n(&registry->current, __ATOMIC_ACQUIRE);
+}
+
+void *bp_registry_find(bp_registry_t *registry, const bp_snapshot_t *snapshot, const char *name, uint32_t *handle) {
+    if (!name || !snapshot->index) return NULL;
+
+    uint64_t hash = bp_hash_string(name);
+    uint32_t position = (uint32_t)hash & snapshot->index_mask;
+    while (snapshot->index[position].item) {
+        const bp_registry_entry_t *entry = &snapshot->index[position];
+        if (entry->hash == hash && strcmp(registry->name_of(entry->item), name) == 0) {
+            if (handle) *handle = entry->handle;
+            return entry->item;
+        }
+        position = (position + 1) & snapshot->index_mask;
+    }
+    return NULL;
+}
+
+void *bp_registry_get(const bp_snapshot_t *snapshot, uint32_t handle) {
+    int slot = (int)(handle & HANDLE_SLOT_MASK) - 1;
+    if (slot < 0 || slot >= snapshot->slot_count) return NULL;
+
+    const bp_registry_entry_t *entry = &snapshot->slots[slot];
+    return entry->handle == handle ? entry->item : NULL;
+}
+
+// Caller holds write_lock; readers that still see the old snapshot are waited out before it is freed
+static void publish(bp_registry_t *registry, bp_snapshot_t *snapshot) {
+    bp_snapshot_t *old = registry->current;
+    __atomic_store_n(&registry->current, snapshot, __ATOMIC_SEQ_CST);
+    bp_rcu_synchronize();
+    free(old);
+}
+
+static int add_locked(bp_registry_t *registry, void *item, uint32_t *handle) {
+    bp_snapshot_t *old = registry->current;
+    for (int i = 0; i < old->count; i++) {
+        if (old->items[i] == item) return BP_ERROR_DUPLICATE;
+    }
+    if (registry->name_of && bp_registry_find(registry, old, registry->name_of(item), NULL)) {
+        return BP_ERROR_DUPLICATE;
+    }
+
+    int slot = 0;
+    while (slot < old->slot_count && old->slots[slot].item) slot++;
+    if (slot >= MAX_SLOTS) return BP_ERROR_MEMORY;
+
+    int slot_count = slot < old->slot_count ? old->slot_count : old->slot_count + 1;
+    bp_snapshot_t *snapshot = snapshot_alloc(registry, old->count + 1, slot_count);
+    if (!snapshot) return BP_ERROR_MEMORY;
+
+    memcpy(snapshot->items, old->items, old->count * sizeof(void*));
+    snapshot->items[old->count] = item;
+
+    memcpy(snapshot->slots, old->slots, old->slot_count * sizeof(bp_registry_entry_t));
+    uint32_t generation = slot < old->slot_count ? ((old->slots[slot].handle >> HANDLE_SLOT_BITS) + 1) & 0xFFFF : 0;
+    snapshot->slots[slot].item = item;
+    snapshot->slots[slot].handle = make_handle(slot, generation);
+    snapshot_index(registry, snapshot);
+
+    if (handle) *handle = snapshot->slots[slot].handle;
+    publish(registry, snapshot);
+    return BP_SUCCESS;
+}
+
+int bp_registry_add(bp_registry_t *registry, void *item, uint32_t *handle) {
+    if (bp_rcu_in_read_section()) return BP_ERROR_PROTOCOL;
+
+    pthread_mutex_lock(&registry->write_lock);
+    int result = add_locked(registry, item, handle);
+    pthread_mutex_unlock(&registry->write_lock);
+    return result;
+}
+
+// The emptied slot keeps its old handle so the next occupant gets a new generation
+static int remove_locked(bp_registry_t *registry, void *item, void **removed) {
+    bp_snapshot_t *old = registry->current;
+    int index = -1;
+    for (int i = 0; i < old->count && index < 0; i++) {
+        if (old->items[i] == item) index = i;
+    }
+    if (index < 0) return BP_ERROR_NOT_FOUND;
+
+    bp_snapshot_t *snapshot = snapshot_alloc(registry, old->count - 1, old->slot_count);
+    if (!snapshot) return BP_ERROR_MEMORY;
+
+    memcpy(snapshot->items, old->items, index * sizeof(void*));
+    memcpy(snapshot->items + index, old->items + index + 1, (old->count - index - 1) * sizeof(void*));
+
+    memcpy(snapshot->slots, old->slots, old->slot_count * sizeof(bp_registry_entry_t));
+    for (int i = 0; i < snapshot->slot_count; i++) {
+        if (snapshot->slots[i].item == item) snapshot->slots[i].item = NULL;
+    }
+    snapshot_index(registry, snapshot);
+
+    if (removed) *removed = item;
+    publish(registry, snapshot);
+    return BP_SUCCESS;
+}
+
+int bp_registry_remove(bp_registry_t *registry, const char *name, void *item, void **removed) {
+    if (bp_rcu_in_read_section()) return BP_ERROR_PROTOCOL;
+
+    pthread_mutex_lock(&registry->write_lock);
+    if (!item) item = bp_registry_find(registry, registry->current, name, NULL);
+    int result = item ? remove_locked(registry, item, removed) : BP_ERROR_NOT_FOUND;
+    pthread_mutex_unlock(&registry->write_lock);
+    return result;
+}
+
+// Swaps item for replacement in one publish; the replacement keeps item's handle and must keep its name
+int bp_registry_replace(bp_registry_t *registry, void *item, void *replacement, void **removed) {
+    if (bp_rcu_in_read_section()) return BP_ERROR_PROTOCOL;
+
+    pthread_mutex_lock(&registry->write_lock);
+    bp_snapshot_t *old = registry->current;
+    int index = -1;
+    for (int i = 0; i < old->count && index < 0; i++) {
+        if (old->items[i] == item) index = i;
+    }
+
+    bp_snapshot_t *snapshot = index < 0 ? NULL : snapshot_alloc(registry, old->count, old->slot_count);
+    if (!snapshot) {
+        pthread_mutex_unlock(&registry->write_lock);
+        return index < 0 ? BP_ERROR_NOT_FOUND : BP_ERROR_MEMORY;
+    }
+
+    memcpy(snapshot->items, old->items, old->count * sizeof(void*));
+    snapshot->items[index] = replacement;
+    memcpy(snapshot->slots, old->slots, old->slot_count * sizeof(bp_registry_entry_t));
+    for (int i = 0; i < snapshot->slot_count; i++) {
+        if (snapshot->slots[i].item == item) snapshot->slots[i].item = replacement;
+    }
+    snapshot_index(registry, snapshot);
+
+    if (removed) *removed = item;
+    publish(registry, snapshot);
+    pthread_mutex_unlock(&registry->write_lock);
+    return BP_SUCCESS;
+}
+
+int bp_registry_remove_handle(bp_registry_t *registry, uint32_t handle, void **removed) {
+    if (bp_rcu_in_read_section()) return BP_ERROR_PROTOCOL;
+
+    pthread_mutex_lock(&registry->write_lock);
+    void *item = bp_registry_get(registry->current, handle);
+    int result = item ? remove_locked(registry, item, removed) : BP_ERROR_NOT_FOUND;
+    pthread_mutex_unlock(&registry->write_lock);
+    return result;
+}
\ No newline at end of file
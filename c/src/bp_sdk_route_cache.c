@@ -0,0 +1,224 @@
+#include "bp_sdk_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+extern bp_context_t g_bp_context;
+
+#define ROUTE_CACHE_BUCKETS 1024
+#define ROUTE_CACHE_MAX_ENTRIES 4096
+
+// Combined bp_routing_compute() result for one destination. The routes are private copies;
+// hits hand out fresh copies, so callers free them exactly as they free computed routes.
+typedef struct cache_entry {
+    struct cache_entry *hash_next;
+    struct cache_entry *older;
+    struct cache_entry *newer;
+    uint64_t hash;
+    time_t expires;
+    int count;
+    bp_route_t *routes;
+    char dest[];
+} cache_entry_t;
+
+// epoch moves on every invalidation, so a result computed across one is never cached
+static struct {
+    pthread_rwlock_t lock;
+    cache_entry_t *buckets[ROUTE_CACHE_BUCKETS];
+    cache_entry_t *oldest;
+    cache_entry_t *newest;
+    uint32_t entries;
+    uint64_t epoch;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t invalidations;
+} g_route_cache = { .lock = PTHREAD_RWLOCK_INITIALIZER };
+
+static void free_routes(bp_route_t *routes, int count) {
+    for (int i = 0; i < count; i++) {
+        free(routes[i].dest_eid);
+        free(routes[i].next_hop);
+    }
+    free(routes);
+}
+
+static int copy_routes(const bp_route_t *routes, int count, bp_route_t **copy) {
+    *copy = NULL;
+    if (count == 0) return BP_SUCCESS;
+
+    bp_route_t *out = calloc(count, sizeof(bp_route_t));
+    if (!out) return BP_ERROR_MEMORY;
+
+    for (int i = 0; i < count; i++) {
+        out[i] = routes[i];
+        out[i].dest_eid = routes[i].dest_eid ? strdup(routes[i].dest_eid) : NULL;
+        out[i].next_hop = routes[i].next_hop ? strdup(routes[i].next_hop) : NULL;
+        if ((routes[i].dest_eid && !out[i].dest_eid) || (routes[i].next_hop && !out[i].next_hop)) {
+            free_routes(out, i + 1);
+            return BP_ERROR_MEMORY;
+        }
+    }
+    *copy = out;
+    return BP_SUCCESS;
+}
+
+// ipn EIDs name a node up to the service number, so a neighbor "ipn:3.0" covers next hop "ipn:3.1"
+static size_t node_length(const char *eid) {
+    const char *dot = strncmp(eid, "ipn:", 4) == 0 ? strchr(eid + 4, '.') : NULL;
+    return dot ? (size_t)(dot - eid) : strlen(eid);
+}
+
+static int same_node(const char *a, const char *b) {
+    size_t len = node_length(a);
+    return len == node_length(b) && memcmp(a, b, len) == 0;
+}
+
+static cache_entry_t *find_entry(uint64_t hash, const char *dest) {
+    for (cache_entry_t *e = g_route_cache.buckets[hash % ROUTE_CACHE_BUCKETS]; e; e = e->hash_next) {
+        if (e->hash == hash && strcmp(e->dest, dest) == 0) return e;
+    }
+    return NULL;
+}
+
+static void unlink_entry(cache_entry_t *e) {
+    cache_entry_t **link = &g_route_cache.buckets[e->hash % ROUTE_CACHE_BUCKETS];
+    while (*link != e) link = &(*link)->hash_next;
+    *link = e->hash_next;
+
+    if (e->older) e->older->newer = e->newer; else g_route_cache.oldest = e->newer;
+    if (e->newer) e->newer->older = e->older; else g_route_cache.newest = e->older;
+    g_route_cache.entries--;
+}
+
+static void free_entry(cache_entry_t *e) {
+    free_routes(e->routes, e->count);
+    free(e);
+}
+
+// Returns 1 with a copy of the cached routes, 0 on a miss; an expired entry is a miss
+int bp_route_cache_get(const char *dest_eid, bp_route_t **routes, int *route_count) {
+    uint64_t hash = bp_hash_string(dest_eid);
+    time_t now = time(NULL);
+
+    pthread_rwlock_rdlock(&g_route_cache.lock);
+    cache_entry_t *e = find_entry(hash, dest_eid);
+    int hit = e && (e->expires == 0 || now < e->expires);
+    int result = hit ? copy_routes(e->routes, e->count, routes) : BP_SUCCESS;
+    if (hit && result == BP_SUCCESS) *route_count = e->count;
+    pthread_rwlock_unlock(&g_route_cache.lock);
+
+    if (result != BP_SUCCESS) return result;
+    __atomic_fetch_add(hit ? &g_route_cache.hits : &g_route_cache.misses, 1, __ATOMIC_RELAXED);
+    return hit;
+}
+
+uint64_t bp_route_cache_epoch(void) {
+    return __atomic_load_n(&g_route_cache.epoch, __ATOMIC_ACQUIRE);
+}
+
+// Caches a result computed from epoch on; it lives until the earliest valid_until among its routes
+void bp_route_cache_put(const char *dest_eid, const bp_route_t *routes, int route_count, uint64_t epoch) {
+    time_t expires = 0;
+    for (int i = 0; i < route_count; i++) {
+        if (routes[i].valid_until > 0 && (expires == 0 || routes[i].valid_until < expires)) {
+            expires = routes[i].valid_until;
+        }
+    }
+    if (expires != 0 && expires <= time(NULL)) return;
+
+    size_t dest_len = strlen(dest_eid);
+    cache_entry_t *e = malloc(sizeof(cache_entry_t) + dest_len + 1);
+    if (!e) return;
+    if (copy_routes(routes, route_count, &e->routes) != BP_SUCCESS) {
+        free(e);
+        return;
+    }
+    memcpy(e->dest, dest_eid, dest_len + 1);
+    e->hash = bp_hash_string(dest_eid);
+    e->expires = expires;
+    e->count = route_count;
+
+    pthread_rwlock_wrlock(&g_route_cache.lock);
+    if (epoch != g_route_cache.epoch) {
+        pthread_rwlock_unlock(&g_route_cache.lock);
+        free_entry(e);
+        return;
+    }
+
+    cache_entry_t *old = find_entry(e->hash, dest_eid);
+    if (old) {
+        unlink_entry(old);
+        free_entry(old);
+    }
+    while (g_route_cache.entries >= ROUTE_CACHE_MAX_ENTRIES) {
+        cache_entry_t *victim = g_route_cache.oldest;
+        unlink_entry(victim);
+        free_entry(victim);
+    }
+
+    cache_entry_t **bucket = &g_route_cache.buckets[e->hash % ROUTE_CACHE_BUCKETS];
+    e->hash_next = *bucket;
+    *bucket = e;
+    e->older = g_route_cache.newest;
+    e->newer = NULL;
+    if (e->older) e->older->newer = e; else g_route_cache.oldest = e;
+    g_route_cache.newest = e;
+    g_route_cache.entries++;
+    pthread_rwlock_unlock(&g_route_cache.lock);
+}
+
+// A change at a neighbor drops the destinations reached through or at it. Empty results
+// are dropped on any change, since the new contact may be what makes them routable.
+static int depends_on(const cache_entry_t *e, const char *neighbor_eid) {
+    if (!neighbor_eid || e->count == 0 || same_node(e->dest, neighbor_eid)) return 1;
+    for (int i = 0; i < e->count; i++) {
+        if (e->routes[i].next_hop && same_node(e->routes[i].next_hop, neighbor_eid)) return 1;
+    }
+    return 0;
+}
+
+// A NULL neighbor drops everything
+void bp_route_cache_invalidate(const char *neighbor_eid) {
+    pthread_rwlock_wrlock(&g_route_cache.lock);
+    __atomic_fetch_add(&g_route_cache.epoch, 1, __ATOMIC_RELEASE);
+    for (cache_entry_t *e = g_route_cache.oldest; e;) {
+        cache_entry_t *next = e->newer;
+        if (depends_on(e, neighbor_eid)) {
+            unlink_entry(e);
+            free_entry(e);
+            g_route_cache.invalidations++;
+        }
+        e = next;
+    }
+    pthread_rwlock_unlock(&g_route_cache.lock);
+}
+
+void bp_route_cache_clear(void) {
+    bp_route_cache_invalidate(NULL);
+
+    pthread_rwlock_wrlock(&g_route_cache.lock);
+    g_route_cache.hits = g_route_cache.misses = g_route_cache.invalidations = 0;
+    pthread_rwlock_unlock(&g_route_cache.lock);
+}
+
+int bp_routing_cache_stats(bp_routing_cache_stats_t *stats) {
+    if (!stats) return BP_ERROR_INVALID_ARGS;
+
+    pthread_rwlock_rdlock(&g_route_cache.lock);
+    stats->entries = g_route_cache.entries;
+    stats->hits = __atomic_load_n(&g_route_cache.hits, __ATOMIC_RELAXED);
+    stats->misses = __atomic_load_n(&g_route_cache.misses, __ATOMIC_RELAXED);
+    stats->invalidations = g_route_cache.invalidations;
+    pthread_rwlock_unlock(&g_route_cache.lock);
+    return BP_SUCCESS;
+}
+
+// For algorithms whose routes change other than through bp_routing_update_contact()/update_range()
+int bp_routing_cache_invalidate(const char *neighbor_eid) {
+    if (!g_bp_context.initialized) return BP_ERROR_NOT_INITIALIZED;
+
+    bp_route_cache_invalidate(neighbor_eid);
+    return BP_SUCCESS;
+}
\ No newline at end of file
@@ -6,42 +6,28 @@
 
 extern bp_context_t g_bp_context;
 
-static bp_routing_t *find_routing(const char *algorithm_name) {
-    if (!algorithm_name) return NULL;
-    
-    for (int i = 0; i < g_bp_context.routing.count; i++) {
-        if (strcmp(g_bp_context.routing.routing[i]->algorithm_name, algorithm_name) == 0) {
-            return g_bp_context.routing.routing[i];
-        }
-    }
-    return NULL;
+static int validate_routing(bp_routing_t *routing) {
+    return routing && routing->algorithm_name && (routing->compute_route || routing->compute_route_sized);
 }
 
-static int validate_routing(bp_routing_t *routing) {
-    return routing && routing->algorithm_name && routing->compute_route;
+// Algorithms without compute_route_sized are asked regardless of size
+static int compute_one(bp_routing_t *routing, const char *dest_eid, uint64_t bundle_size, bp_route_t **routes,
+                       int *route_count) {
+    return routing->compute_route_sized ?
+           routing->compute_route_sized(dest_eid, bundle_size, routes, route_count, routing->context) :
+           routing->compute_route(dest_eid, routes, route_count, routing->context);
 }
 
 int bp_routing_register(bp_routing_t *routing) {
+    return bp_routing_register_h(routing, NULL);
+}
+
+int bp_routing_register_h(bp_routing_t *routing, bp_routing_handle_t *handle) {
     if (!validate_routing(routing) || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    pthread_mutex_lock(&g_bp_context.mutex);
-    
-    if (find_routing(routing->algorithm_name)) {
-        pthread_mutex_unlock(&g_bp_context.mutex);
-        return BP_ERROR_DUPLICATE;
-    }
-
-    int result = ensure_capacity((void***)&g_bp_context.routing.routing, 
-                               &g_bp_context.routing.capacity, 
-                               g_bp_context.routing.count, 
-                               sizeof(bp_routing_t*));
-    
-    if (result == BP_SUCCESS) {
-        g_bp_context.routing.routing[g_bp_context.routing.count++] = routing;
-    }
-    
-    pthread_mutex_unlock(&g_bp_context.mutex);
+    int result = bp_registry_add(&g_bp_context.routing, routing, handle);
+    if (result == BP_SUCCESS) bp_route_cache_invalidate(NULL);
     return result;
 }
 
@@ -49,42 +35,88 @@ int bp_routing_unregister(const char *algorithm_name) {
     if (!algorithm_name || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    pthread_mutex_lock(&g_bp_context.mutex);
+    int result = bp_registry_remove(&g_bp_context.routing, algorithm_name, NULL, NULL);
+    if (result == BP_SUCCESS) bp_route_cache_invalidate(NULL);
+    return result;
+}
+
+int bp_routing_unregister_h(bp_routing_handle_t handle) {
+    if (handle == BP_INVALID_HANDLE || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    int result = bp_registry_remove_handle(&g_bp_context.routing, handle, NULL);
+    if (result == BP_SUCCESS) bp_route_cache_invalidate(NULL);
+    return result;
+}
+
+int bp_routing_lookup(const char *algorithm_name, bp_routing_handle_t *handle) {
+    if (!algorithm_name || !handle || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    bp_rcu_read_lock();
+    bp_routing_t *routing = bp_registry_find(&g_bp_context.routing, bp_registry_read(&g_bp_context.routing), 
+                                             algorithm_name, handle);
+    bp_rcu_read_unlock();
     
-    for (int i = 0; i < g_bp_context.routing.count; i++) {
-        if (strcmp(g_bp_context.routing.routing[i]->algorithm_name, algorithm_name) == 0) {
-            memmove(&g_bp_context.routing.routing[i], 
-                   &g_bp_context.routing.routing[i + 1], 
-                   (g_bp_context.routing.count - i - 1) * sizeof(bp_routing_t*));
-            g_bp_context.routing.count--;
-            pthread_mutex_unlock(&g_bp_context.mutex);
-            return BP_SUCCESS;
-        }
+    return routing ? BP_SUCCESS : BP_ERROR_NOT_FOUND;
+}
+
+// Asks a single algorithm; the routes it returns are handed to the caller unchanged
+int bp_routing_compute_h(bp_routing_handle_t handle, const char *dest_eid, bp_route_t **routes, int *route_count) {
+    if (!dest_eid || !routes || !route_count || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    *routes = NULL;
+    *route_count = 0;
+
+    bp_rcu_read_lock();
+    bp_routing_t *routing = bp_registry_get(bp_registry_read(&g_bp_context.routing), handle);
+    if (!routing) {
+        bp_rcu_read_unlock();
+        return BP_ERROR_NOT_FOUND;
     }
+
+    int result = compute_one(routing, dest_eid, 0, routes, route_count);
+    bp_rcu_read_unlock();
     
-    pthread_mutex_unlock(&g_bp_context.mutex);
-    return BP_ERROR_NOT_FOUND;
+    return (result == 0) ? BP_SUCCESS : BP_ERROR_ROUTING;
 }
 
 int bp_routing_compute(const char *dest_eid, bp_route_t **routes, int *route_count) {
+    return bp_routing_compute_sized(dest_eid, 0, routes, route_count);
+}
+
+// Routes able to carry bundle_size bytes, or any route for 0. Unsized results are served from the
+// route cache while valid; sized ones depend on residual volumes and are always computed. The
+// caller owns the result either way.
+int bp_routing_compute_sized(const char *dest_eid, uint64_t bundle_size, bp_route_t **routes, int *route_count) {
     if (!dest_eid || !routes || !route_count || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    pthread_mutex_lock(&g_bp_context.mutex);
-    
     *routes = NULL;
     *route_count = 0;
 
-    for (int i = 0; i < g_bp_context.routing.count; i++) {
-        bp_routing_t *routing = g_bp_context.routing.routing[i];
+    int hit = bundle_size == 0 ? bp_route_cache_get(dest_eid, routes, route_count) : 0;
+    if (hit != 0) return hit > 0 ? BP_SUCCESS : hit;
+    uint64_t epoch = bp_route_cache_epoch();
+
+    bp_rcu_read_lock();
+    const bp_snapshot_t *snapshot = bp_registry_read(&g_bp_context.routing);
+    int complete = 1;
+
+    for (int i = 0; i < snapshot->count; i++) {
+        bp_routing_t *routing = snapshot->items[i];
         bp_route_t *alg_routes = NULL;
         int alg_count = 0;
         
-        if (routing->compute_route(dest_eid, &alg_routes, &alg_count, routing->context) == 0 && alg_count > 0) {
+        int alg_result = compute_one(routing, dest_eid, bundle_size, &alg_routes, &alg_count);
+        if (alg_result != 0) complete = 0;
+        if (alg_result == 0 && alg_count > 0) {
             if (*routes == NULL) {
                 *routes = malloc(alg_count * sizeof(bp_route_t));
                 if (!*routes) {
-                    pthread_mutex_unlock(&g_bp_context.mutex);
+                    bp_route_list_destroy(alg_routes, alg_count);
+                    bp_rcu_read_unlock();
                     return BP_ERROR_MEMORY;
                 }
                 memcpy(*routes, alg_routes, alg_count * sizeof(bp_route_t));
@@ -92,8 +124,11 @@ int bp_routing_compute(const char *dest_eid, bp_route_t **routes, int *route_cou
             } else {
                 bp_route_t *new_routes = realloc(*routes, (*route_count + alg_count) * sizeof(bp_route_t));
                 if (!new_routes) {
-                    free(*routes);
-                    pthread_mutex_unlock(&g_bp_context.mutex);
+                    bp_route_list_destroy(alg_routes, alg_count);
+                    bp_route_list_destroy(*routes, *route_count);
+                    *routes = NULL;
+                    *route_count = 0;
+                    bp_rcu_read_unlock();
                     return BP_ERROR_MEMORY;
                 }
                 *routes = new_routes;
@@ -101,26 +136,44 @@ int bp_routing_compute(const char *dest_eid, bp_route_t **routes, int *route_cou
                 *route_count += alg_count;
             }
         }
+        // The route strings now belong to the combined list; only the algorithm's array goes
+        free(alg_routes);
     }
 
-    pthread_mutex_unlock(&g_bp_context.mutex);
+    bp_rcu_read_unlock();
+
+    // An algorithm that failed might succeed next time, so a partial answer is not cached
+    if (complete && bundle_size == 0) bp_route_cache_put(dest_eid, *routes, *route_count, epoch);
     return BP_SUCCESS;
 }
 
+// The local node's contacts and ranges go into the shared contact plan for engines that read it
+static void record_local(bp_contact_plan_kind_t kind, const char *neighbor_eid, time_t start, time_t end,
+                         uint32_t value) {
+    uint64_t local_node, neighbor_node;
+    if (bp_contact_plan_node_of(NULL, &local_node) && bp_contact_plan_node_of(neighbor_eid, &neighbor_node)) {
+        bp_contact_plan_update(kind, local_node, neighbor_node, start, end, value, 0);
+    }
+}
+
 int bp_routing_update_contact(const char *neighbor_eid, time_t start, time_t end, uint32_t rate) {
     if (!neighbor_eid || start >= end || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    pthread_mutex_lock(&g_bp_context.mutex);
+    record_local(BP_CONTACT_PLAN_CONTACT, neighbor_eid, start, end, rate);
+
+    bp_rcu_read_lock();
+    const bp_snapshot_t *snapshot = bp_registry_read(&g_bp_context.routing);
     
-    for (int i = 0; i < g_bp_context.routing.count; i++) {
-        bp_routing_t *routing = g_bp_context.routing.routing[i];
+    for (int i = 0; i < snapshot->count; i++) {
+        bp_routing_t *routing = snapshot->items[i];
         if (routing->update_contact) {
             routing->update_contact(neighbor_eid, start, end, rate, routing->context);
         }
     }
 
-    pthread_mutex_unlock(&g_bp_context.mutex);
+    bp_rcu_read_unlock();
+    bp_route_cache_invalidate(neighbor_eid);
     return BP_SUCCESS;
 }
 
@@ -128,16 +181,20 @@ int bp_routing_update_range(const char *neighbor_eid, time_t start, time_t end,
     if (!neighbor_eid || start >= end || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    pthread_mutex_lock(&g_bp_context.mutex);
+    record_local(BP_CONTACT_PLAN_RANGE, neighbor_eid, start, end, owlt);
+
+    bp_rcu_read_lock();
+    const bp_snapshot_t *snapshot = bp_registry_read(&g_bp_context.routing);
     
-    for (int i = 0; i < g_bp_context.routing.count; i++) {
-        bp_routing_t *routing = g_bp_context.routing.routing[i];
+    for (int i = 0; i < snapshot->count; i++) {
+        bp_routing_t *routing = snapshot->items[i];
         if (routing->update_range) {
             routing->update_range(neighbor_eid, start, end, owlt, routing->context);
         }
     }
 
-    pthread_mutex_unlock(&g_bp_context.mutex);
+    bp_rcu_read_unlock();
+    bp_route_cache_invalidate(neighbor_eid);
     return BP_SUCCESS;
 }
 
@@ -160,7 +217,10 @@ int bp_routing_create_cgr(bp_routing_t **routing) {
     if (!routing) return BP_ERROR_INVALID_ARGS;
     
     *routing = create_routing_base("cgr");
-    return *routing ? BP_SUCCESS : BP_ERROR_MEMORY;
+    if (!*routing) return BP_ERROR_MEMORY;
+
+    bp_cgr_init(*routing);
+    return BP_SUCCESS;
 }
 
 int bp_routing_create_static(bp_routing_t **routing) {
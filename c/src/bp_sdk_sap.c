@@ -0,0 +1,364 @@
+#include "bp_sdk_internal.h"
+#include "../bpv7/include/bp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+extern bp_context_t g_bp_context;
+
+static int sap_cache_grow(void) {
+    int new_count = g_bp_context.saps.bucket_count == 0 ? 64 : g_bp_context.saps.bucket_count * 2;
+    bp_sap_entry_t **new_buckets = calloc(new_count, sizeof(bp_sap_entry_t*));
+    if (!new_buckets) return BP_ERROR_MEMORY;
+
+    for (int i = 0; i < g_bp_context.saps.bucket_count; i++) {
+        bp_sap_entry_t *entry = g_bp_context.saps.buckets[i];
+        while (entry) {
+            bp_sap_entry_t *next = entry->next;
+            int index = (int)(entry->hash & (uint64_t)(new_count - 1));
+            entry->next = new_buckets[index];
+            new_buckets[index] = entry;
+            entry = next;
+        }
+    }
+
+    free(g_bp_context.saps.buckets);
+    g_bp_context.saps.buckets = new_buckets;
+    g_bp_context.saps.bucket_count = new_count;
+    return BP_SUCCESS;
+}
+
+static bp_sap_entry_t *sap_cache_find(const char *eid, uint64_t hash, int source_only) {
+    if (g_bp_context.saps.bucket_count == 0) return NULL;
+
+    bp_sap_entry_t *entry = g_bp_context.saps.buckets[hash & (uint64_t)(g_bp_context.saps.bucket_count - 1)];
+    while (entry) {
+        if (entry->hash == hash && entry->source_only == source_only && strcmp(entry->eid, eid) == 0) return entry;
+        entry = entry->next;
+    }
+    return NULL;
+}
+
+static int sap_entry_init_sync(bp_sap_entry_t *entry) {
+    pthread_condattr_t attr;
+    if (pthread_condattr_init(&attr) != 0) return BP_ERROR_MEMORY;
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+
+    int result = pthread_cond_init(&entry->recv_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    if (result != 0) return BP_ERROR_MEMORY;
+
+    if (pthread_mutex_init(&entry->recv_lock, NULL) != 0) {
+        pthread_cond_destroy(&entry->recv_cond);
+        return BP_ERROR_MEMORY;
+    }
+
+    entry->event_fds[0] = entry->event_fds[1] = -1;
+    return BP_SUCCESS;
+}
+
+// The cache holds one reference to each entry it links; callers take another and bp_sap_cache_put() it
+static int sap_cache_get(const char *eid, int source_only, bp_sap_entry_t **entry) {
+    uint64_t hash = bp_hash_string(eid);
+
+    pthread_rwlock_rdlock(&g_bp_context.saps.lock);
+    bp_sap_entry_t *found = sap_cache_find(eid, hash, source_only);
+    if (found) bp_sap_cache_hold(found);
+    pthread_rwlock_unlock(&g_bp_context.saps.lock);
+
+    if (found) {
+        *entry = found;
+        return BP_SUCCESS;
+    }
+
+    pthread_rwlock_wrlock(&g_bp_context.saps.lock);
+
+    // Another thread may have opened the SAP while we waited for the write lock
+    found = sap_cache_find(eid, hash, source_only);
+    if (found) {
+        bp_sap_cache_hold(found);
+        pthread_rwlock_unlock(&g_bp_context.saps.lock);
+        *entry = found;
+        return BP_SUCCESS;
+    }
+
+    if (g_bp_context.saps.count >= g_bp_context.saps.bucket_count && sap_cache_grow() != BP_SUCCESS) {
+        pthread_rwlock_unlock(&g_bp_context.saps.lock);
+        return BP_ERROR_MEMORY;
+    }
+
+    bp_sap_entry_t *new_entry = calloc(1, sizeof(bp_sap_entry_t));
+    if (!new_entry) {
+        pthread_rwlock_unlock(&g_bp_context.saps.lock);
+        return BP_ERROR_MEMORY;
+    }
+
+    new_entry->eid = strdup(eid);
+    if (!new_entry->eid || sap_entry_init_sync(new_entry) != BP_SUCCESS) {
+        free(new_entry->eid);
+        free(new_entry);
+        pthread_rwlock_unlock(&g_bp_context.saps.lock);
+        return BP_ERROR_MEMORY;
+    }
+
+    // A source-only SAP can send but leaves the endpoint free for whichever application receives on it
+    int opened = source_only ? bp_open_source((char*)eid, &new_entry->sap, 0) : bp_open((char*)eid, &new_entry->sap);
+    if (opened < 0) {
+        pthread_cond_destroy(&new_entry->recv_cond);
+        pthread_mutex_destroy(&new_entry->recv_lock);
+        free(new_entry->eid);
+        free(new_entry);
+        pthread_rwlock_unlock(&g_bp_context.saps.lock);
+        return BP_ERROR_PROTOCOL;
+    }
+
+    new_entry->hash = hash;
+    new_entry->source_only = source_only;
+    new_entry->refs = 2;
+    new_entry->stats = bp_stats_entity(BP_STATS_ENDPOINT, eid);
+
+    int index = (int)(hash & (uint64_t)(g_bp_context.saps.bucket_count - 1));
+    new_entry->next = g_bp_context.saps.buckets[index];
+    g_bp_context.saps.buckets[index] = new_entry;
+    g_bp_context.saps.count++;
+
+    pthread_rwlock_unlock(&g_bp_context.saps.lock);
+    *entry = new_entry;
+    return BP_SUCCESS;
+}
+
+int bp_sap_cache_get(const char *eid, bp_sap_entry_t **entry) {
+    return sap_cache_get(eid, 0, entry);
+}
+
+int bp_sap_cache_get_source(const char *eid, bp_sap_entry_t **entry) {
+    return sap_cache_get(eid, 1, entry);
+}
+
+void bp_sap_cache_hold(bp_sap_entry_t *entry) {
+    __atomic_fetch_add(&entry->refs, 1, __ATOMIC_RELAXED);
+}
+
+static int open_event_fds(int fds[2]) {
+#ifdef __linux__
+    fds[0] = fds[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return fds[0] < 0 ? -1 : 0;
+#else
+    if (pipe(fds) < 0) return -1;
+    for (int i = 0; i < 2; i++) {
+        fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+        fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+    }
+    return 0;
+#endif
+}
+
+static void close_event_fds(int fds[2]) {
+    if (fds[0] >= 0) close(fds[0]);
+    if (fds[1] >= 0 && fds[1] != fds[0]) close(fds[1]);
+    fds[0] = fds[1] = -1;
+}
+
+static void signal_event_fd(int fd) {
+    uint64_t one = 1;
+#ifdef __linux__
+    ssize_t written = write(fd, &one, sizeof(one));
+#else
+    ssize_t written = write(fd, &one, 1);
+#endif
+    (void)written;
+}
+
+static void drain_event_fd(int fd) {
+    uint64_t value;
+    while (read(fd, &value, sizeof(value)) > 0) {}
+}
+
+// Pulls one delivery at a time out of ION so the pending state can be waited on at
+// millisecond resolution and surfaced through a pollable file descriptor
+static void *sap_watcher(void *arg) {
+    bp_sap_entry_t *entry = (bp_sap_entry_t*)arg;
+
+    pthread_mutex_lock(&entry->recv_lock);
+    while (!entry->stopping) {
+        while (entry->pending && !entry->stopping) {
+            pthread_cond_wait(&entry->recv_cond, &entry->recv_lock);
+        }
+        if (entry->stopping) break;
+        pthread_mutex_unlock(&entry->recv_lock);
+
+        BpDelivery delivery;
+        int result = bp_receive(entry->sap, &delivery, BP_BLOCKING);
+
+        pthread_mutex_lock(&entry->recv_lock);
+        if (result < 0 || delivery.result == BpEndpointStopped) {
+            entry->watch_error = BP_ERROR_PROTOCOL;
+            pthread_cond_broadcast(&entry->recv_cond);
+            signal_event_fd(entry->event_fds[1]);
+            break;
+        }
+
+        if (delivery.result != BpPayloadPresent) continue;
+
+        if (entry->stopping) {
+            bp_release_delivery(&delivery, 1);
+            break;
+        }
+
+        entry->delivery = delivery;
+        entry->pending = 1;
+        pthread_cond_broadcast(&entry->recv_cond);
+        signal_event_fd(entry->event_fds[1]);
+    }
+    pthread_mutex_unlock(&entry->recv_lock);
+    return NULL;
+}
+
+// Caller holds recv_lock
+static int sap_start_watcher(bp_sap_entry_t *entry) {
+    if (entry->stopping) return BP_ERROR_NOT_FOUND;
+    if (entry->watching) return BP_SUCCESS;
+
+    if (open_event_fds(entry->event_fds) < 0) return BP_ERROR_MEMORY;
+
+    if (pthread_create(&entry->watcher, NULL, sap_watcher, entry) != 0) {
+        close_event_fds(entry->event_fds);
+        return BP_ERROR_MEMORY;
+    }
+
+    entry->watching = 1;
+    return BP_SUCCESS;
+}
+
+int bp_sap_get_fd(bp_sap_entry_t *entry, int *fd) {
+    pthread_mutex_lock(&entry->recv_lock);
+    int result = sap_start_watcher(entry);
+    if (result == BP_SUCCESS) *fd = entry->event_fds[0];
+    pthread_mutex_unlock(&entry->recv_lock);
+    return result;
+}
+
+int bp_sap_take_delivery(bp_sap_entry_t *entry, BpDelivery *delivery, int timeout_ms) {
+    struct timespec deadline;
+    if (timeout_ms > 0) bp_deadline_after_ms(&deadline, timeout_ms);
+
+    pthread_mutex_lock(&entry->recv_lock);
+
+    int result = sap_start_watcher(entry);
+    while (result == BP_SUCCESS && !entry->pending && !entry->watch_error && !entry->stopping) {
+        if (timeout_ms == BP_SAP_NO_WAIT) {
+            result = BP_ERROR_TIMEOUT;
+        } else if (timeout_ms > 0) {
+            if (pthread_cond_timedwait(&entry->recv_cond, &entry->recv_lock, &deadline) == ETIMEDOUT) {
+                result = BP_ERROR_TIMEOUT;
+            }
+        } else {
+            pthread_cond_wait(&entry->recv_cond, &entry->recv_lock);
+        }
+    }
+
+    if (result == BP_SUCCESS && entry->pending) {
+        *delivery = entry->delivery;
+        entry->pending = 0;
+        drain_event_fd(entry->event_fds[0]);
+        pthread_cond_broadcast(&entry->recv_cond);
+    } else if (result == BP_SUCCESS) {
+        result = entry->watch_error ? entry->watch_error : BP_ERROR_NOT_FOUND;
+    }
+
+    pthread_mutex_unlock(&entry->recv_lock);
+    return result;
+}
+
+// Wakes every receiver waiting on the entry; none can restart the watcher afterwards
+static void sap_stop_watcher(bp_sap_entry_t *entry) {
+    pthread_mutex_lock(&entry->recv_lock);
+    entry->stopping = 1;
+    pthread_cond_broadcast(&entry->recv_cond);
+    if (!entry->watching) {
+        pthread_mutex_unlock(&entry->recv_lock);
+        return;
+    }
+    pthread_mutex_unlock(&entry->recv_lock);
+
+    bp_interrupt(entry->sap);
+    pthread_join(entry->watcher, NULL);
+
+    if (entry->pending) {
+        bp_release_delivery(&entry->delivery, 1);
+        entry->pending = 0;
+    }
+    close_event_fds(entry->event_fds);
+    entry->watching = 0;
+}
+
+static void sap_entry_free(bp_sap_entry_t *entry) {
+    sap_stop_watcher(entry);
+    bp_close(entry->sap);
+    pthread_cond_destroy(&entry->recv_cond);
+    pthread_mutex_destroy(&entry->recv_lock);
+    free(entry->eid);
+    free(entry);
+}
+
+void bp_sap_cache_put(bp_sap_entry_t *entry) {
+    if (__atomic_sub_fetch(&entry->refs, 1, __ATOMIC_ACQ_REL) == 0) sap_entry_free(entry);
+}
+
+// Drops both kinds of SAP for the EID so ION can hand the endpoint to another application;
+// the SAP closes once the last receive or send still using it returns
+void bp_sap_cache_evict(const char *eid) {
+    uint64_t hash = bp_hash_string(eid);
+    bp_sap_entry_t *evicted = NULL;
+
+    pthread_rwlock_wrlock(&g_bp_context.saps.lock);
+    if (g_bp_context.saps.bucket_count > 0) {
+        bp_sap_entry_t **link = &g_bp_context.saps.buckets[hash & (uint64_t)(g_bp_context.saps.bucket_count - 1)];
+        while (*link) {
+            bp_sap_entry_t *entry = *link;
+            if (entry->hash == hash && strcmp(entry->eid, eid) == 0) {
+                *link = entry->next;
+                entry->next = evicted;
+                evicted = entry;
+                g_bp_context.saps.count--;
+            } else {
+                link = &entry->next;
+            }
+        }
+    }
+    pthread_rwlock_unlock(&g_bp_context.saps.lock);
+
+    while (evicted) {
+        bp_sap_entry_t *next = evicted->next;
+        sap_stop_watcher(evicted);
+        bp_sap_cache_put(evicted);
+        evicted = next;
+    }
+}
+
+void bp_sap_cache_close_all(void) {
+    pthread_rwlock_wrlock(&g_bp_context.saps.lock);
+
+    for (int i = 0; i < g_bp_context.saps.bucket_count; i++) {
+        bp_sap_entry_t *entry = g_bp_context.saps.buckets[i];
+        while (entry) {
+            bp_sap_entry_t *next = entry->next;
+            sap_entry_free(entry);
+            entry = next;
+        }
+    }
+
+    free(g_bp_context.saps.buckets);
+    g_bp_context.saps.buckets = NULL;
+    g_bp_context.saps.bucket_count = 0;
+    g_bp_context.saps.count = 0;
+
+    pthread_rwlock_unlock(&g_bp_context.saps.lock);
+}
\ No newline at end of file
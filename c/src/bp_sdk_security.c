@@ -10,155 +10,112 @@
 
 extern bp_context_t g_bp_context;
 
-static bp_security_t *find_security(const char *name) {
-    if (!name) return NULL;
-    for (int i = 0; i < g_bp_context.security.count; i++) {
-        if (strcmp(g_bp_context.security.security[i]->security_name, name) == 0) {
-            return g_bp_context.security.security[i];
-        }
-    }
-    return NULL;
-}
-
 static int validate_security(bp_security_t *sec) {
     return sec && sec->security_name && (sec->encrypt || sec->decrypt || sec->sign || sec->verify);
 }
 
 int bp_security_register(bp_security_t *security) {
+    return bp_security_register_h(security, NULL);
+}
+
+int bp_security_register_h(bp_security_t *security, bp_security_handle_t *handle) {
     if (!validate_security(security) || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    pthread_mutex_lock(&g_bp_context.mutex);
-    
-    if (find_security(security->security_name)) {
-        pthread_mutex_unlock(&g_bp_context.mutex);
-        return BP_ERROR_DUPLICATE;
-    }
-
-    int result = ensure_capacity((void***)&g_bp_context.security.security, 
-                               &g_bp_context.security.capacity, 
-                               g_bp_context.security.count, 
-                               sizeof(bp_security_t*));
-    
-    if (result == BP_SUCCESS) {
-        g_bp_context.security.security[g_bp_context.security.count++] = security;
-    }
-    
-    pthread_mutex_unlock(&g_bp_context.mutex);
-    return result;
+    return bp_registry_add(&g_bp_context.security, security, handle);
 }
 
 int bp_security_unregister(const char *security_name) {
     if (!security_name || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    pthread_mutex_lock(&g_bp_context.mutex);
-    
-    for (int i = 0; i < g_bp_context.security.count; i++) {
-        if (strcmp(g_bp_context.security.security[i]->security_name, security_name) == 0) {
-            memmove(&g_bp_context.security.security[i], 
-                   &g_bp_context.security.security[i + 1], 
-                   (g_bp_context.security.count - i - 1) * sizeof(bp_security_t*));
-            g_bp_context.security.count--;
-            pthread_mutex_unlock(&g_bp_context.mutex);
-            return BP_SUCCESS;
-        }
-    }
-    
-    pthread_mutex_unlock(&g_bp_context.mutex);
-    return BP_ERROR_NOT_FOUND;
+    return bp_registry_remove(&g_bp_context.security, security_name, NULL, NULL);
 }
 
-int bp_security_encrypt(const void *plain, size_t plain_len, void **cipher, size_t *cipher_len) {
-    if (!plain || !cipher || !cipher_len || !g_bp_context.initialized) 
+int bp_security_unregister_h(bp_security_handle_t handle) {
+    if (handle == BP_INVALID_HANDLE || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    pthread_mutex_lock(&g_bp_context.mutex);
-    
-    if (g_bp_context.security.count == 0) {
-        pthread_mutex_unlock(&g_bp_context.mutex);
-        return BP_ERROR_NOT_FOUND;
-    }
+    return bp_registry_remove_handle(&g_bp_context.security, handle, NULL);
+}
 
-    bp_security_t *sec = g_bp_context.security.security[0];
-    if (!sec->encrypt) {
-        pthread_mutex_unlock(&g_bp_context.mutex);
-        return BP_ERROR_PROTOCOL;
-    }
+int bp_security_lookup(const char *security_name, bp_security_handle_t *handle) {
+    if (!security_name || !handle || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    int result = sec->encrypt(plain, plain_len, cipher, cipher_len, sec->context);
-    pthread_mutex_unlock(&g_bp_context.mutex);
+    bp_rcu_read_lock();
+    bp_security_t *sec = bp_registry_find(&g_bp_context.security, bp_registry_read(&g_bp_context.security), 
+                                          security_name, handle);
+    bp_rcu_read_unlock();
     
-    return (result == 0) ? BP_SUCCESS : BP_ERROR_SECURITY;
+    return sec ? BP_SUCCESS : BP_ERROR_NOT_FOUND;
 }
 
-int bp_security_decrypt(const void *cipher, size_t cipher_len, void **plain, size_t *plain_len) {
-    if (!cipher || !plain || !plain_len || !g_bp_context.initialized) 
-        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+// With BP_INVALID_HANDLE the first registered provider handles the operation
+static bp_security_t *resolve_security(bp_security_handle_t handle) {
+    const bp_snapshot_t *snapshot = bp_registry_read(&g_bp_context.security);
+    if (handle == BP_INVALID_HANDLE) return snapshot->count > 0 ? snapshot->items[0] : NULL;
+    return bp_registry_get(snapshot, handle);
+}
 
-    pthread_mutex_lock(&g_bp_context.mutex);
-    
-    if (g_bp_context.security.count == 0) {
-        pthread_mutex_unlock(&g_bp_context.mutex);
-        return BP_ERROR_NOT_FOUND;
-    }
+#define SECURITY_CALL(handle, op, ...) do { \
+    bp_rcu_read_lock(); \
+    bp_security_t *sec = resolve_security(handle); \
+    if (!sec) { \
+        bp_rcu_read_unlock(); \
+        return BP_ERROR_NOT_FOUND; \
+    } \
+    if (!sec->op) { \
+        bp_rcu_read_unlock(); \
+        return BP_ERROR_PROTOCOL; \
+    } \
+    int result = sec->op(__VA_ARGS__, sec->context); \
+    bp_rcu_read_unlock(); \
+    return (result == 0) ? BP_SUCCESS : BP_ERROR_SECURITY; \
+} while (0)
 
-    bp_security_t *sec = g_bp_context.security.security[0];
-    if (!sec->decrypt) {
-        pthread_mutex_unlock(&g_bp_context.mutex);
-        return BP_ERROR_PROTOCOL;
-    }
+int bp_security_encrypt(const void *plain, size_t plain_len, void **cipher, size_t *cipher_len) {
+    return bp_security_encrypt_h(BP_INVALID_HANDLE, plain, plain_len, cipher, cipher_len);
+}
 
-    int result = sec->decrypt(cipher, cipher_len, plain, plain_len, sec->context);
-    pthread_mutex_unlock(&g_bp_context.mutex);
-    
-    return (result == 0) ? BP_SUCCESS : BP_ERROR_SECURITY;
+int bp_security_decrypt(const void *cipher, size_t cipher_len, void **plain, size_t *plain_len) {
+    return bp_security_decrypt_h(BP_INVALID_HANDLE, cipher, cipher_len, plain, plain_len);
 }
 
 int bp_security_sign(const void *data, size_t data_len, void **signature, size_t *sig_len) {
-    if (!data || !signature || !sig_len || !g_bp_context.initialized) 
+    return bp_security_sign_h(BP_INVALID_HANDLE, data, data_len, signature, sig_len);
+}
+
+int bp_security_verify(const void *data, size_t data_len, const void *signature, size_t sig_len) {
+    return bp_security_verify_h(BP_INVALID_HANDLE, data, data_len, signature, sig_len);
+}
+
+int bp_security_encrypt_h(bp_security_handle_t handle, const void *plain, size_t plain_len, void **cipher, size_t *cipher_len) {
+    if (!plain || !cipher || !cipher_len || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    pthread_mutex_lock(&g_bp_context.mutex);
-    
-    if (g_bp_context.security.count == 0) {
-        pthread_mutex_unlock(&g_bp_context.mutex);
-        return BP_ERROR_NOT_FOUND;
-    }
+    SECURITY_CALL(handle, encrypt, plain, plain_len, cipher, cipher_len);
+}
 
-    bp_security_t *sec = g_bp_context.security.security[0];
-    if (!sec->sign) {
-        pthread_mutex_unlock(&g_bp_context.mutex);
-        return BP_ERROR_PROTOCOL;
-    }
+int bp_security_decrypt_h(bp_security_handle_t handle, const void *cipher, size_t cipher_len, void **plain, size_t *plain_len) {
+    if (!cipher || !plain || !plain_len || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    int result = sec->sign(data, data_len, signature, sig_len, sec->context);
-    pthread_mutex_unlock(&g_bp_context.mutex);
-    
-    return (result == 0) ? BP_SUCCESS : BP_ERROR_SECURITY;
+    SECURITY_CALL(handle, decrypt, cipher, cipher_len, plain, plain_len);
 }
 
-int bp_security_verify(const void *data, size_t data_len, const void *signature, size_t sig_len) {
-    if (!data || !signature || !g_bp_context.initialized) 
+int bp_security_sign_h(bp_security_handle_t handle, const void *data, size_t data_len, void **signature, size_t *sig_len) {
+    if (!data || !signature || !sig_len || !g_bp_context.initialized) 
         return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    pthread_mutex_lock(&g_bp_context.mutex);
-    
-    if (g_bp_context.security.count == 0) {
-        pthread_mutex_unlock(&g_bp_context.mutex);
-        return BP_ERROR_NOT_FOUND;
-    }
+    SECURITY_CALL(handle, sign, data, data_len, signature, sig_len);
+}
 
-    bp_security_t *sec = g_bp_context.security.security[0];
-    if (!sec->verify) {
-        pthread_mutex_unlock(&g_bp_context.mutex);
-        return BP_ERROR_PROTOCOL;
-    }
+int bp_security_verify_h(bp_security_handle_t handle, const void *data, size_t data_len, const void *signature, size_t sig_len) {
+    if (!data || !signature || !g_bp_context.initialized) 
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
 
-    int result = sec->verify(data, data_len, signature, sig_len, sec->context);
-    pthread_mutex_unlock(&g_bp_context.mutex);
-    
-    return (result == 0) ? BP_SUCCESS : BP_ERROR_SECURITY;
+    SECURITY_CALL(handle, verify, data, data_len, signature, sig_len);
 }
 
 static int aes_gcm_encrypt_impl(const void *plain, size_t plain_len, void **cipher, size_t *cipher_len, void *context) {
@@ -0,0 +1,544 @@
+#include "bp_sdk_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+// One block per thread, written only by its owner. seq is odd while an update is in
+// progress so readers can retry instead of seeing a half-applied update.
+typedef struct stats_block {
+    uint32_t seq;
+    int in_use;
+    uint64_t counters[BP_STAT_COUNT];
+    uint64_t histograms[BP_HISTOGRAM_COUNT][BP_HISTOGRAM_BUCKETS];
+    struct stats_block *next;
+} __attribute__((aligned(BP_CACHE_LINE))) stats_block_t;
+
+typedef struct {
+    uint64_t counters[BP_STAT_COUNT];
+    uint64_t histograms[BP_HISTOGRAM_COUNT][BP_HISTOGRAM_BUCKETS];
+} stats_totals_t;
+
+#define ENTITY_BUCKETS 64
+#define SERIAL_MAGIC "BPST"
+#define SERIAL_VERSION 1
+// An entry is an ID length and five counters, one byte each at least
+#define SERIAL_ENTRY_MIN 6
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_once_t once;
+    pthread_key_t key;
+    stats_block_t *blocks;
+    stats_totals_t retired;
+    stats_totals_t base;
+    bp_stats_entity_t *entities[BP_STATS_KIND_COUNT][ENTITY_BUCKETS];
+} g_stats = { .lock = PTHREAD_MUTEX_INITIALIZER, .once = PTHREAD_ONCE_INIT };
+
+static __thread stats_block_t *t_block;
+
+static void fold_block(stats_totals_t *totals, const stats_block_t *block) {
+    for (int i = 0; i < BP_STAT_COUNT; i++) totals->counters[i] += block->counters[i];
+    for (int h = 0; h < BP_HISTOGRAM_COUNT; h++) {
+        for (int b = 0; b < BP_HISTOGRAM_BUCKETS; b++) totals->histograms[h][b] += block->histograms[h][b];
+    }
+}
+
+// An exiting thread's counts move to the retired totals and its block is recycled
+static void stats_block_release(void *arg) {
+    stats_block_t *block = (stats_block_t*)arg;
+
+    pthread_mutex_lock(&g_stats.lock);
+    fold_block(&g_stats.retired, block);
+    memset(block->counters, 0, sizeof(block->counters));
+    memset(block->histograms, 0, sizeof(block->histograms));
+    block->in_use = 0;
+    pthread_mutex_unlock(&g_stats.lock);
+}
+
+static void stats_init_key(void) {
+    pthread_key_create(&g_stats.key, stats_block_release);
+}
+
+static stats_block_t *stats_block_acquire(void) {
+    pthread_once(&g_stats.once, stats_init_key);
+
+    pthread_mutex_lock(&g_stats.lock);
+    stats_block_t *block = g_stats.blocks;
+    while (block && block->in_use) block = block->next;
+
+    if (!block) {
+        if (posix_memalign((void**)&block, BP_CACHE_LINE, sizeof(stats_block_t)) != 0) {
+            pthread_mutex_unlock(&g_stats.lock);
+            return NULL;
+        }
+        memset(block, 0, sizeof(stats_block_t));
+        block->next = g_stats.blocks;
+        g_stats.blocks = block;
+    }
+    block->in_use = 1;
+    pthread_mutex_unlock(&g_stats.lock);
+
+    pthread_setspecific(g_stats.key, block);
+    return block;
+}
+
+static inline stats_block_t *thread_block(void) {
+    if (!t_block) t_block = stats_block_acquire();
+    return t_block;
+}
+
+static inline void write_begin(stats_block_t *block) {
+    __atomic_store_n(&block->seq, block->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void write_end(stats_block_t *block) {
+    __atomic_store_n(&block->seq, block->seq + 1, __ATOMIC_RELEASE);
+}
+
+static inline void bump(uint64_t *value, uint64_t n) {
+    __atomic_store_n(value, *value + n, __ATOMIC_RELAXED);
+}
+
+static inline int histogram_bucket(uint64_t value) {
+    return value == 0 ? 0 : 63 - __builtin_clzll(value);
+}
+
+void bp_stats_add(bp_stat_t stat, uint64_t n) {
+    stats_block_t *block = thread_block();
+    if (!block) return;
+
+    write_begin(block);
+    bump(&block->counters[stat], n);
+    write_end(block);
+}
+
+void bp_stats_observe(bp_histogram_id_t histogram, uint64_t value) {
+    stats_block_t *block = thread_block();
+    if (!block) return;
+
+    write_begin(block);
+    bump(&block->histograms[histogram][histogram_bucket(value)], 1);
+    write_end(block);
+}
+
+uint64_t bp_stats_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+// Lookups walk the bucket without locking; entities are only ever prepended, never removed
+bp_stats_entity_t *bp_stats_entity(bp_stats_kind_t kind, const char *name) {
+    if (!name) return NULL;
+
+    uint64_t hash = bp_hash_string(name);
+    bp_stats_entity_t **bucket = &g_stats.entities[kind][hash & (ENTITY_BUCKETS - 1)];
+
+    for (bp_stats_entity_t *e = __atomic_load_n(bucket, __ATOMIC_ACQUIRE); e; e = e->next) {
+        if (e->hash == hash && strcmp(e->name, name) == 0) return e;
+    }
+
+    pthread_mutex_lock(&g_stats.lock);
+    bp_stats_entity_t *entity = *bucket;
+    while (entity && !(entity->hash == hash && strcmp(entity->name, name) == 0)) entity = entity->next;
+
+    if (!entity && posix_memalign((void**)&entity, BP_CACHE_LINE, sizeof(bp_stats_entity_t)) == 0) {
+        memset(entity, 0, sizeof(bp_stats_entity_t));
+        entity->name = strdup(name);
+        if (!entity->name) {
+            free(entity);
+            entity = NULL;
+        } else {
+            entity->hash = hash;
+            entity->next = *bucket;
+            __atomic_store_n(bucket, entity, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&g_stats.lock);
+    return entity;
+}
+
+void bp_stats_entity_add(bp_stats_entity_t *entity, bp_entity_stat_t stat, uint64_t n) {
+    if (entity) __atomic_fetch_add(&entity->counters[stat], n, __ATOMIC_RELAXED);
+}
+
+static void read_block(const stats_block_t *block, stats_totals_t *copy) {
+    for (;;) {
+        uint32_t seq = __atomic_load_n(&block->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            sched_yield();
+            continue;
+        }
+
+        for (int i = 0; i < BP_STAT_COUNT; i++) {
+            copy->counters[i] = __atomic_load_n(&block->counters[i], __ATOMIC_RELAXED);
+        }
+        for (int h = 0; h < BP_HISTOGRAM_COUNT; h++) {
+            for (int b = 0; b < BP_HISTOGRAM_BUCKETS; b++) {
+                copy->histograms[h][b] = __atomic_load_n(&block->histograms[h][b], __ATOMIC_RELAXED);
+            }
+        }
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&block->seq, __ATOMIC_RELAXED) == seq) return;
+    }
+}
+
+// Caller holds g_stats.lock
+static void collect_totals(stats_totals_t *totals) {
+    *totals = g_stats.retired;
+
+    stats_totals_t copy;
+    for (stats_block_t *block = g_stats.blocks; block; block = block->next) {
+        if (!block->in_use) continue;
+        read_block(block, &copy);
+        for (int i = 0; i < BP_STAT_COUNT; i++) totals->counters[i] += copy.counters[i];
+        for (int h = 0; h < BP_HISTOGRAM_COUNT; h++) {
+            for (int b = 0; b < BP_HISTOGRAM_BUCKETS; b++) totals->histograms[h][b] += copy.histograms[h][b];
+        }
+    }
+}
+
+static int get_counter(bp_stat_t stat, uint64_t *count) {
+    if (!count || !g_bp_context.initialized)
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    stats_totals_t totals;
+    pthread_mutex_lock(&g_stats.lock);
+    collect_totals(&totals);
+    *count = totals.counters[stat] - g_stats.base.counters[stat];
+    pthread_mutex_unlock(&g_stats.lock);
+    return BP_SUCCESS;
+}
+
+int bp_stats_get_bundles_sent(uint64_t *count) {
+    return get_counter(BP_STAT_SENT, count);
+}
+
+int bp_stats_get_bundles_received(uint64_t *count) {
+    return get_counter(BP_STAT_RECEIVED, count);
+}
+
+int bp_stats_get_bundles_forwarded(uint64_t *count) {
+    return get_counter(BP_STAT_FORWARDED, count);
+}
+
+int bp_stats_get_bundles_delivered(uint64_t *count) {
+    return get_counter(BP_STAT_DELIVERED, count);
+}
+
+int bp_stats_get_bundles_deleted(uint64_t *count) {
+    return get_counter(BP_STAT_DELETED, count);
+}
+
+int bp_stats_get_bytes_sent(uint64_t *count) {
+    return get_counter(BP_STAT_BYTES_SENT, count);
+}
+
+int bp_stats_get_bytes_received(uint64_t *count) {
+    return get_counter(BP_STAT_BYTES_RECEIVED, count);
+}
+
+int bp_stats_get_histogram(bp_histogram_id_t histogram, uint64_t buckets[BP_HISTOGRAM_BUCKETS]) {
+    if ((int)histogram < 0 || (int)histogram >= BP_HISTOGRAM_COUNT || !buckets || !g_bp_context.initialized)
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    stats_totals_t totals;
+    pthread_mutex_lock(&g_stats.lock);
+    collect_totals(&totals);
+    for (int b = 0; b < BP_HISTOGRAM_BUCKETS; b++) {
+        buckets[b] = totals.histograms[histogram][b] - g_stats.base.histograms[histogram][b];
+    }
+    pthread_mutex_unlock(&g_stats.lock);
+    return BP_SUCCESS;
+}
+
+// Writers never see the reset: the current totals become the baseline that reads subtract
+int bp_stats_reset(void) {
+    if (!g_bp_context.initialized) return BP_ERROR_NOT_INITIALIZED;
+
+    pthread_mutex_lock(&g_stats.lock);
+    collect_totals(&g_stats.base);
+    for (int k = 0; k < BP_STATS_KIND_COUNT; k++) {
+        for (int b = 0; b < ENTITY_BUCKETS; b++) {
+            for (bp_stats_entity_t *e = g_stats.entities[k][b]; e; e = e->next) {
+                for (int i = 0; i < BP_ENTITY_STAT_COUNT; i++) {
+                    e->base[i] = __atomic_load_n(&e->counters[i], __ATOMIC_RELAXED);
+                }
+            }
+        }
+    }
+    pthread_mutex_unlock(&g_stats.lock);
+    return BP_SUCCESS;
+}
+
+static void free_entries(bp_stats_entry_t *entries, int count) {
+    if (!entries) return;
+    for (int i = 0; i < count; i++) free(entries[i].id);
+    free(entries);
+}
+
+// Caller holds g_stats.lock
+static int collect_entities(bp_stats_kind_t kind, bp_stats_entry_t **entries, int *count) {
+    int total = 0;
+    for (int b = 0; b < ENTITY_BUCKETS; b++) {
+        for (bp_stats_entity_t *e = g_stats.entities[kind][b]; e; e = e->next) total++;
+    }
+
+    *entries = NULL;
+    *count = 0;
+    if (total == 0) return BP_SUCCESS;
+
+    bp_stats_entry_t *out = calloc(total, sizeof(bp_stats_entry_t));
+    if (!out) return BP_ERROR_MEMORY;
+
+    int n = 0;
+    for (int b = 0; b < ENTITY_BUCKETS; b++) {
+        for (bp_stats_entity_t *e = g_stats.entities[kind][b]; e; e = e->next) {
+            uint64_t values[BP_ENTITY_STAT_COUNT];
+            for (int i = 0; i < BP_ENTITY_STAT_COUNT; i++) {
+                values[i] = __atomic_load_n(&e->counters[i], __ATOMIC_RELAXED) - e->base[i];
+            }
+
+            out[n].id = strdup(e->name);
+            if (!out[n].id) {
+                free_entries(out, n);
+                return BP_ERROR_MEMORY;
+            }
+            out[n].bundles_sent = values[BP_ENTITY_SENT];
+            out[n].bundles_received = values[BP_ENTITY_RECEIVED];
+            out[n].bytes_sent = values[BP_ENTITY_BYTES_SENT];
+            out[n].bytes_received = values[BP_ENTITY_BYTES_RECEIVED];
+            out[n].errors = values[BP_ENTITY_ERRORS];
+            n++;
+        }
+    }
+
+    *entries = out;
+    *count = n;
+    return BP_SUCCESS;
+}
+
+int bp_stats_snapshot(bp_stats_t *stats) {
+    if (!stats || !g_bp_context.initialized)
+        return !g_bp_context.initialized ? BP_ERROR_NOT_INITIALIZED : BP_ERROR_INVALID_ARGS;
+
+    memset(stats, 0, sizeof(bp_stats_t));
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    stats->timestamp_ms = (uint64_t)now.tv_sec * 1000ULL + (uint64_t)now.tv_nsec / 1000000ULL;
+
+    stats_totals_t totals;
+    pthread_mutex_lock(&g_stats.lock);
+    collect_totals(&totals);
+
+    uint64_t counters[BP_STAT_COUNT];
+    for (int i = 0; i < BP_STAT_COUNT; i++) counters[i] = totals.counters[i] - g_stats.base.counters[i];
+    stats->bundles_sent = counters[BP_STAT_SENT];
+    stats->bundles_received = counters[BP_STAT_RECEIVED];
+    stats->bundles_forwarded = counters[BP_STAT_FORWARDED];
+    stats->bundles_delivered = counters[BP_STAT_DELIVERED];
+    stats->bundles_deleted = counters[BP_STAT_DELETED];
+    stats->bytes_sent = counters[BP_STAT_BYTES_SENT];
+    stats->bytes_received = counters[BP_STAT_BYTES_RECEIVED];
+
+    for (int h = 0; h < BP_HISTOGRAM_COUNT; h++) {
+        for (int b = 0; b < BP_HISTOGRAM_BUCKETS; b++) {
+            stats->histograms[h][b] = totals.histograms[h][b] - g_stats.base.histograms[h][b];
+        }
+    }
+
+    int result = collect_entities(BP_STATS_ENDPOINT, &stats->endpoints, &stats->endpoint_count);
+    if (result == BP_SUCCESS) result = collect_entities(BP_STATS_CLA, &stats->clas, &stats->cla_count);
+    pthread_mutex_unlock(&g_stats.lock);
+
+    if (result != BP_SUCCESS) bp_stats_snapshot_free(stats);
+    return result;
+}
+
+int bp_stats_snapshot_free(bp_stats_t *stats) {
+    if (!stats) return BP_ERROR_INVALID_ARGS;
+
+    free_entries(stats->endpoints, stats->endpoint_count);
+    free_entries(stats->clas, stats->cla_count);
+    stats->endpoints = stats->clas = NULL;
+    stats->endpoint_count = stats->cla_count = 0;
+    return BP_SUCCESS;
+}
+
+// Serialized form: magic, version, then LEB128 varints. Histograms list only their non-empty
+// buckets and entries carry a length-prefixed id, so an idle node encodes in a few dozen bytes.
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    size_t pos;
+    int error;
+} cursor_t;
+
+static void put_bytes(cursor_t *c, const void *bytes, size_t n) {
+    if (c->data && c->pos + n <= c->len) memcpy(c->data + c->pos, bytes, n);
+    c->pos += n;
+}
+
+static void put_varint(cursor_t *c, uint64_t value) {
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        if (value) byte |= 0x80;
+        put_bytes(c, &byte, 1);
+    } while (value);
+}
+
+static void put_entries(cursor_t *c, const bp_stats_entry_t *entries, int count) {
+    put_varint(c, (uint64_t)count);
+    for (int i = 0; i < count; i++) {
+        size_t id_len = entries[i].id ? strlen(entries[i].id) : 0;
+        put_varint(c, id_len);
+        put_bytes(c, entries[i].id, id_len);
+        put_varint(c, entries[i].bundles_sent);
+        put_varint(c, entries[i].bundles_received);
+        put_varint(c, entries[i].bytes_sent);
+        put_varint(c, entries[i].bytes_received);
+        put_varint(c, entries[i].errors);
+    }
+}
+
+// *written is always set to the encoded size, so a NULL buffer can be used to size one
+int bp_stats_serialize(const bp_stats_t *stats, void *buffer, size_t len, size_t *written) {
+    if (!stats || !written || (!buffer && len > 0)) return BP_ERROR_INVALID_ARGS;
+
+    cursor_t c = { buffer, len, 0, 0 };
+    uint8_t version = SERIAL_VERSION;
+    put_bytes(&c, SERIAL_MAGIC, 4);
+    put_bytes(&c, &version, 1);
+
+    put_varint(&c, stats->timestamp_ms);
+    put_varint(&c, stats->bundles_sent);
+    put_varint(&c, stats->bundles_received);
+    put_varint(&c, stats->bundles_forwarded);
+    put_varint(&c, stats->bundles_delivered);
+    put_varint(&c, stats->bundles_deleted);
+    put_varint(&c, stats->bytes_sent);
+    put_varint(&c, stats->bytes_received);
+
+    for (int h = 0; h < BP_HISTOGRAM_COUNT; h++) {
+        uint8_t used = 0;
+        for (int b = 0; b < BP_HISTOGRAM_BUCKETS; b++) used += stats->histograms[h][b] != 0;
+        put_bytes(&c, &used, 1);
+        for (uint8_t b = 0; b < BP_HISTOGRAM_BUCKETS; b++) {
+            if (!stats->histograms[h][b]) continue;
+            put_bytes(&c, &b, 1);
+            put_varint(&c, stats->histograms[h][b]);
+        }
+    }
+
+    put_entries(&c, stats->endpoints, stats->endpoint_count);
+    put_entries(&c, stats->clas, stats->cla_count);
+
+    *written = c.pos;
+    return (!buffer || c.pos <= len) ? BP_SUCCESS : BP_ERROR_INVALID_ARGS;
+}
+
+static const uint8_t *get_bytes(cursor_t *c, size_t n) {
+    if (c->error || n > c->len - c->pos) {
+        c->error = 1;
+        return NULL;
+    }
+    const uint8_t *bytes = c->data + c->pos;
+    c->pos += n;
+    return bytes;
+}
+
+static uint64_t get_varint(cursor_t *c) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        const uint8_t *byte = get_bytes(c, 1);
+        if (!byte) return 0;
+        value |= (uint64_t)(*byte & 0x7F) << shift;
+        if (!(*byte & 0x80)) return value;
+    }
+    c->error = 1;
+    return 0;
+}
+
+static int get_entries(cursor_t *c, bp_stats_entry_t **entries, int *count) {
+    uint64_t n = get_varint(c);
+    if (c->error || n > (c->len - c->pos) / SERIAL_ENTRY_MIN || n > INT_MAX) return BP_ERROR_INVALID_ARGS;
+
+    *entries = NULL;
+    *count = 0;
+    if (n == 0) return BP_SUCCESS;
+
+    bp_stats_entry_t *out = calloc(n, sizeof(bp_stats_entry_t));
+    if (!out) return BP_ERROR_MEMORY;
+
+    for (uint64_t i = 0; i < n; i++) {
+        uint64_t id_len = get_varint(c);
+        const uint8_t *id = id_len <= c->len - c->pos ? get_bytes(c, id_len) : NULL;
+        out[i].id = id ? malloc(id_len + 1) : NULL;
+        if (!out[i].id) {
+            free_entries(out, (int)i);
+            return id ? BP_ERROR_MEMORY : BP_ERROR_INVALID_ARGS;
+        }
+        memcpy(out[i].id, id, id_len);
+        out[i].id[id_len] = '\0';
+
+        out[i].bundles_sent = get_varint(c);
+        out[i].bundles_received = get_varint(c);
+        out[i].bytes_sent = get_varint(c);
+        out[i].bytes_received = get_varint(c);
+        out[i].errors = get_varint(c);
+    }
+
+    if (c->error) {
+        free_entries(out, (int)n);
+        return BP_ERROR_INVALID_ARGS;
+    }
+
+    *entries = out;
+    *count = (int)n;
+    return BP_SUCCESS;
+}
+
+int bp_stats_deserialize(const void *buffer, size_t len, bp_stats_t *stats) {
+    if (!buffer || !stats) return BP_ERROR_INVALID_ARGS;
+
+    memset(stats, 0, sizeof(bp_stats_t));
+    cursor_t c = { (uint8_t*)buffer, len, 0, 0 };
+
+    const uint8_t *header = get_bytes(&c, 5);
+    if (!header || memcmp(header, SERIAL_MAGIC, 4) != 0 || header[4] != SERIAL_VERSION) return BP_ERROR_INVALID_ARGS;
+
+    stats->timestamp_ms = get_varint(&c);
+    stats->bundles_sent = get_varint(&c);
+    stats->bundles_received = get_varint(&c);
+    stats->bundles_forwarded = get_varint(&c);
+    stats->bundles_delivered = get_varint(&c);
+    stats->bundles_deleted = get_varint(&c);
+    stats->bytes_sent = get_varint(&c);
+    stats->bytes_received = get_varint(&c);
+
+    for (int h = 0; h < BP_HISTOGRAM_COUNT; h++) {
+        const uint8_t *used = get_bytes(&c, 1);
+        for (int i = 0; used && i < *used; i++) {
+            const uint8_t *bucket = get_bytes(&c, 1);
+            if (!bucket || *bucket >= BP_HISTOGRAM_BUCKETS) {
+                c.error = 1;
+                break;
+            }
+            stats->histograms[h][*bucket] = get_varint(&c);
+        }
+    }
+    if (c.error) return BP_ERROR_INVALID_ARGS;
+
+    int result = get_entries(&c, &stats->endpoints, &stats->endpoint_count);
+    if (result == BP_SUCCESS) result = get_entries(&c, &stats->clas, &stats->cla_count);
+    if (result != BP_SUCCESS) bp_stats_snapshot_free(stats);
+    return result;
+}
\ No newline at end of file
@@ -3,6 +3,15 @@
 #include <string.h>
 #include <assert.h>
 #include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
 #include "bp_sdk.h"
 
 #define TEST_ASSERT(condition, message) \
@@ -51,6 +60,16 @@ int test_error_handling() {
     return 1;
 }
 
+static int blocked_receive_result = -100;
+
+static void *receive_blocked(void *arg) {
+    bp_bundle_t *bundle = NULL;
+    int result = bp_receive((bp_endpoint_t*)arg, &bundle, 0);
+    if (bundle) bp_bundle_free(bundle);
+    __atomic_store_n(&blocked_receive_result, result, __ATOMIC_RELAXED);
+    return NULL;
+}
+
 int test_endpoint_management() {
     printf("\n=== Testing Endpoint Management ===\n");
     
@@ -67,8 +86,32 @@ int test_endpoint_management() {
     result = bp_endpoint_register(endpoint);
     TEST_ASSERT(result == BP_SUCCESS, "Endpoint registration");
     
+    // Unregistering closes the endpoint's SAP, waking a receive that is still waiting on it
+    int fd = -1;
+    result = bp_endpoint_get_fd(endpoint, &fd);
+    TEST_ASSERT(result == BP_SUCCESS && fd >= 0, "Endpoint descriptor");
+    pthread_t receiver;
+    pthread_create(&receiver, NULL, receive_blocked, endpoint);
+    usleep(100000);
+    
     result = bp_endpoint_unregister(endpoint);
     TEST_ASSERT(result == BP_SUCCESS, "Endpoint unregistration");
+    pthread_join(receiver, NULL);
+    TEST_ASSERT(blocked_receive_result != BP_SUCCESS && blocked_receive_result != -100, 
+                "Blocked receive returns on unregistration");
+    
+    // Sending from the EID leaves it free to receive on, and a new registration opens it afresh
+    result = bp_send("ipn:1.1", "ipn:1.1", "again", 5, BP_PRIORITY_STANDARD, BP_CUSTODY_NONE, 60, NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "Send from the unregistered EID");
+    result = bp_endpoint_register(endpoint);
+    TEST_ASSERT(result == BP_SUCCESS, "Endpoint re-registration");
+    bp_bundle_t *bundle = NULL;
+    result = bp_receive(endpoint, &bundle, 1000);
+    TEST_ASSERT(result == BP_SUCCESS && bundle && bundle->payload_len == 5, "Re-registered endpoint receives");
+    bp_bundle_free(bundle);
+    
+    result = bp_endpoint_unregister(endpoint);
+    TEST_ASSERT(result == BP_SUCCESS, "Endpoint unregistration after receive");
     
     result = bp_endpoint_destroy(endpoint);
     TEST_ASSERT(result == BP_SUCCESS, "Endpoint destruction");
@@ -77,6 +120,158 @@ int test_endpoint_management() {
     return 1;
 }
 
+static int dispatched = 0;
+static int self_unregister_result = -100;
+
+static int count_dispatch(bp_bundle_t *bundle, void *context) {
+    (void)context;
+    if (bundle->payload_len == 5 && memcmp(bundle->payload, "hello", 5) == 0) 
+        __atomic_fetch_add(&dispatched, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static int unregister_self(bp_bundle_t *bundle, void *context) {
+    (void)bundle;
+    __atomic_store_n(&self_unregister_result, bp_endpoint_unregister((bp_endpoint_t*)context), __ATOMIC_RELAXED);
+    return 0;
+}
+
+int test_dispatcher() {
+    printf("\n=== Testing Receive Dispatcher ===\n");
+    
+    int result = bp_init("ipn:1.1", NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "BP-SDK initialization for dispatcher test");
+    
+    bp_endpoint_t *counting, *leaving;
+    bp_endpoint_create("ipn:1.2", &counting);
+    bp_endpoint_create("ipn:1.3", &leaving);
+    counting->receive_callback = count_dispatch;
+    leaving->receive_callback = unregister_self;
+    leaving->context = leaving;
+    bp_endpoint_register(counting);
+    bp_endpoint_register(leaving);
+    
+    result = bp_dispatcher_start(2, 16);
+    TEST_ASSERT(result == BP_SUCCESS, "Dispatcher start");
+    
+    for (int i = 0; i < 3; i++) {
+        bp_send("ipn:1.1", "ipn:1.2", "hello", 5, BP_PRIORITY_STANDARD, BP_CUSTODY_NONE, 60, NULL);
+    }
+    for (int i = 0; i < 100 && __atomic_load_n(&dispatched, __ATOMIC_RELAXED) < 3; i++) usleep(10000);
+    TEST_ASSERT(dispatched == 3, "Callback receives every bundle");
+    
+    bp_send("ipn:1.1", "ipn:1.3", "bye", 3, BP_PRIORITY_STANDARD, BP_CUSTODY_NONE, 60, NULL);
+    for (int i = 0; i < 100 && __atomic_load_n(&self_unregister_result, __ATOMIC_RELAXED) == -100; i++) usleep(10000);
+    TEST_ASSERT(self_unregister_result == BP_SUCCESS, "Callback unregisters its own endpoint");
+    
+    __atomic_store_n(&self_unregister_result, -100, __ATOMIC_RELAXED);
+    bp_send("ipn:1.1", "ipn:1.3", "bye", 3, BP_PRIORITY_STANDARD, BP_CUSTODY_NONE, 60, NULL);
+    usleep(100000);
+    TEST_ASSERT(self_unregister_result == -100, "Nothing delivered after unregistering");
+    
+    result = bp_dispatcher_stop();
+    TEST_ASSERT(result == BP_SUCCESS, "Dispatcher stop");
+    
+    bp_endpoint_unregister(counting);
+    bp_endpoint_destroy(counting);
+    bp_endpoint_destroy(leaving);
+    bp_shutdown();
+    return 1;
+}
+
+int test_async_send() {
+    printf("\n=== Testing Async Send ===\n");
+    
+    int result = bp_init("ipn:1.1", NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "BP-SDK initialization for async test");
+    
+    bp_endpoint_t *endpoint;
+    bp_endpoint_create("ipn:1.5", &endpoint);
+    bp_endpoint_register(endpoint);
+    
+    result = bp_async_start(4);
+    TEST_ASSERT(result == BP_SUCCESS, "Async start");
+    
+    bp_send_req_t req = {
+        .source_eid = "ipn:1.1",
+        .dest_eid = "ipn:1.5",
+        .payload = "async",
+        .payload_len = 5,
+        .priority = BP_PRIORITY_STANDARD,
+        .custody = BP_CUSTODY_NONE,
+        .ttl = 60
+    };
+    int accepted = 0;
+    for (int i = 0; i < 4; i++) {
+        if (bp_send_async(&req, 100 + i) == BP_SUCCESS) accepted++;
+    }
+    TEST_ASSERT(accepted == 4, "Submissions accepted");
+    
+    result = bp_send_async(&req, 999);
+    TEST_ASSERT(result == BP_ERROR_TIMEOUT, "Full ring reported");
+    
+    bp_completion_t completions[4];
+    uint64_t seen = 0;
+    int reaped = 0, failed = 0;
+    while (reaped < 4) {
+        int count = 0;
+        if (bp_poll_completions(completions, 4, &count, 1000) != BP_SUCCESS) break;
+        for (int i = 0; i < count; i++) {
+            if (completions[i].user_data >= 100 && completions[i].user_data < 104) seen |= 1u << (completions[i].user_data - 100);
+            if (completions[i].result != BP_SUCCESS) failed++;
+        }
+        reaped += count;
+    }
+    TEST_ASSERT(reaped == 4 && seen == 0xf && failed == 0, "Every submission completed with its user data");
+    
+    int count = 0;
+    result = bp_poll_completions(completions, 4, &count, 0);
+    TEST_ASSERT(result == BP_ERROR_TIMEOUT && count == 0, "Nothing left to reap");
+    
+    // Stopping with submissions still queued sends them before the submitter exits
+    accepted = 0;
+    for (int i = 0; i < 4; i++) {
+        if (bp_send_async(&req, 200 + i) == BP_SUCCESS) accepted++;
+    }
+    result = bp_async_stop();
+    TEST_ASSERT(accepted == 4 && result == BP_SUCCESS, "Stop with pending submissions");
+    
+    int received = 0;
+    bp_bundle_t *bundle;
+    while (received < 8 && bp_receive(endpoint, &bundle, 1000) == BP_SUCCESS) {
+        bp_bundle_free(bundle);
+        received++;
+    }
+    TEST_ASSERT(received == 8, "Pending submissions sent before stop");
+    
+    result = bp_send_async(&req, 300);
+    TEST_ASSERT(result == BP_ERROR_NOT_INITIALIZED, "Submission after stop rejected");
+    
+    // Completions of the bundles sent while stopping are still handed out, and only then is polling refused
+    result = bp_async_start(2);
+    TEST_ASSERT(result == BP_ERROR_DUPLICATE, "Restart refused while completions are unreaped");
+    seen = 0;
+    result = bp_poll_completions(completions, 4, &count, 0);
+    for (int i = 0; i < count; i++) {
+        if (completions[i].user_data >= 200 && completions[i].user_data < 204 && completions[i].result == BP_SUCCESS) 
+            seen |= 1u << (completions[i].user_data - 200);
+    }
+    TEST_ASSERT(result == BP_SUCCESS && count == 4 && seen == 0xf, "Completions reaped after stop");
+    result = bp_poll_completions(completions, 4, &count, 0);
+    TEST_ASSERT(result == BP_ERROR_NOT_INITIALIZED, "Polling after stop rejected");
+    
+    result = bp_async_start(2);
+    TEST_ASSERT(result == BP_SUCCESS, "Async restart");
+    bp_send_async(&req, 400);
+    bp_send_async(&req, 401);
+    
+    bp_endpoint_unregister(endpoint);
+    bp_endpoint_destroy(endpoint);
+    result = bp_shutdown();
+    TEST_ASSERT(result == BP_SUCCESS, "Shutdown with submissions pending");
+    return 1;
+}
+
 int test_cla_management() {
     printf("\n=== Testing CLA Management ===\n");
     
@@ -89,6 +284,8 @@ int test_cla_management() {
     TEST_ASSERT(cla != NULL, "CLA not NULL");
     TEST_ASSERT(cla->protocol_name != NULL, "CLA protocol name set");
     TEST_ASSERT(strcmp(cla->protocol_name, "udp") == 0, "CLA protocol name correct");
+    TEST_ASSERT(cla->data_rate == 0, "Built-in CLA unpaced by default");
+    TEST_ASSERT(cla->context == NULL, "Built-in CLA leaves context to the caller");
     
     result = bp_cla_register(cla);
     TEST_ASSERT(result == BP_SUCCESS, "CLA registration");
@@ -115,6 +312,571 @@ int test_cla_management() {
     return 1;
 }
 
+int test_cla_handles() {
+    printf("\n=== Testing CLA Handles ===\n");
+    
+    int result = bp_init("ipn:1.1", NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "BP-SDK initialization for CLA handle test");
+    
+    bp_cla_t *cla;
+    result = bp_cla_create_udp("127.0.0.1", 4556, &cla);
+    TEST_ASSERT(result == BP_SUCCESS, "UDP CLA creation");
+    
+    bp_cla_handle_t handle = BP_INVALID_HANDLE;
+    result = bp_cla_register_h(cla, &handle);
+    TEST_ASSERT(result == BP_SUCCESS, "CLA registration with handle");
+    TEST_ASSERT(handle != BP_INVALID_HANDLE, "CLA handle assigned");
+    
+    bp_cla_handle_t found = BP_INVALID_HANDLE;
+    result = bp_cla_lookup("udp", &found);
+    TEST_ASSERT(result == BP_SUCCESS && found == handle, "CLA lookup by name returns handle");
+    
+    result = bp_cla_unregister_h(handle);
+    TEST_ASSERT(result == BP_SUCCESS, "CLA unregistration by handle");
+    
+    result = bp_cla_send_h(handle, "127.0.0.1:4556", "test", 4);
+    TEST_ASSERT(result == BP_ERROR_NOT_FOUND, "Stale CLA handle rejected");
+    
+    bp_cla_handle_t reused = BP_INVALID_HANDLE;
+    result = bp_cla_register_h(cla, &reused);
+    TEST_ASSERT(result == BP_SUCCESS && reused != handle, "Re-registration gets a new handle");
+    
+    bp_cla_unregister_h(reused);
+    bp_cla_destroy(cla);
+    bp_shutdown();
+    return 1;
+}
+
+static int queued_sends = 0;
+
+static int counting_send(const void *data, size_t len, const char *dest, void *context) {
+    (void)data; (void)dest; (void)context;
+    __atomic_fetch_add(&queued_sends, 1, __ATOMIC_RELAXED);
+    return len > 0 ? 0 : -1;
+}
+
+static int ignore_receive(void *data, size_t len, char *source, void *context) {
+    (void)data; (void)len; (void)source; (void)context;
+    return 0;
+}
+
+int test_cla_queue() {
+    printf("\n=== Testing CLA Outbound Queue ===\n");
+    
+    int result = bp_init("ipn:1.1", NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "BP-SDK initialization for CLA queue test");
+    
+    bp_cla_t cla;
+    memset(&cla, 0, sizeof(cla));
+    cla.protocol_name = "counting";
+    cla.send_callback = counting_send;
+    cla.receive_callback = ignore_receive;
+    cla.queue_depth = 100;
+    cla.queue_policy = BP_CLA_QUEUE_BLOCK;
+    result = bp_cla_register(&cla);
+    TEST_ASSERT(result == BP_SUCCESS, "Queued CLA registration");
+    
+    for (int i = 0; i < 1000; i++) {
+        result = bp_cla_send("counting", "127.0.0.1:4556", "test", 4);
+        if (result != BP_SUCCESS) break;
+    }
+    TEST_ASSERT(result == BP_SUCCESS, "Blocking queue accepts every send");
+    
+    bp_cla_queue_stats_t stats;
+    result = bp_cla_queue_stats("counting", &stats);
+    TEST_ASSERT(result == BP_SUCCESS, "Queue stats retrieval");
+    TEST_ASSERT(stats.capacity == 128, "Queue depth rounded up to a power of two");
+    TEST_ASSERT(stats.enqueued == 1000 && stats.dropped == 0, "Queue counts enqueued bundles");
+    TEST_ASSERT(stats.high_watermark <= stats.capacity, "High watermark within capacity");
+    
+    result = bp_cla_unregister("counting");
+    TEST_ASSERT(result == BP_SUCCESS, "Queued CLA unregistration");
+    TEST_ASSERT(queued_sends == 1000, "Unregistration drains the queue");
+    
+    bp_shutdown();
+    return 1;
+}
+
+static char coalesced[64];
+
+static int capture_send(const void *data, size_t len, const char *dest, void *context) {
+    (void)dest; (void)context;
+    if (len >= sizeof(coalesced)) return -1;
+    memcpy(coalesced, data, len);
+    coalesced[len] = '\0';
+    return 0;
+}
+
+int test_cla_sendv() {
+    printf("\n=== Testing CLA Scatter-Gather Send ===\n");
+    
+    int result = bp_init("ipn:1.1", NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "BP-SDK initialization for sendv test");
+    
+    bp_cla_t cla;
+    memset(&cla, 0, sizeof(cla));
+    cla.protocol_name = "capture";
+    cla.send_callback = capture_send;
+    cla.receive_callback = ignore_receive;
+    result = bp_cla_register(&cla);
+    TEST_ASSERT(result == BP_SUCCESS, "CLA without iov callback registration");
+    
+    struct iovec iov[2] = {
+        { .iov_base = "header:", .iov_len = 7 },
+        { .iov_base = "payload", .iov_len = 7 }
+    };
+    result = bp_cla_sendv("capture", "127.0.0.1:4556", iov, 2);
+    TEST_ASSERT(result == BP_SUCCESS, "Vectored send");
+    TEST_ASSERT(strcmp(coalesced, "header:payload") == 0, "Vector coalesced for send_callback");
+    
+    result = bp_cla_sendv("capture", "127.0.0.1:4556", iov, 0);
+    TEST_ASSERT(result == BP_ERROR_INVALID_ARGS, "Empty vector rejected");
+    
+    bp_cla_unregister("capture");
+    bp_shutdown();
+    return 1;
+}
+
+static double elapsed_since(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void *send_paced(void *arg) {
+    char payload[1000];
+    memset(payload, 'p', sizeof(payload));
+    for (int i = 0; i < 4; i++) bp_cla_send((const char*)arg, "127.0.0.1:4556", payload, sizeof(payload));
+    return NULL;
+}
+
+static int unregister_from_send = -100;
+
+static int unregistering_send(const void *data, size_t len, const char *dest, void *context) {
+    (void)data; (void)len; (void)dest; (void)context;
+    unregister_from_send = bp_cla_unregister("selfish");
+    return 0;
+}
+
+int test_cla_pacing() {
+    printf("\n=== Testing CLA Rate Pacing ===\n");
+    
+    int result = bp_init("ipn:1.1", NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "BP-SDK initialization for pacing test");
+    
+    bp_cla_t cla;
+    memset(&cla, 0, sizeof(cla));
+    cla.protocol_name = "paced";
+    cla.send_callback = counting_send;
+    cla.max_payload_size = 1000;
+    cla.data_rate = 100000;
+    result = bp_cla_register(&cla);
+    TEST_ASSERT(result == BP_SUCCESS, "Paced CLA registration");
+    
+    char payload[1000];
+    memset(payload, 'p', sizeof(payload));
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < 30; i++) bp_cla_send("paced", "127.0.0.1:4556", payload, sizeof(payload));
+    double paced = elapsed_since(&start);
+    TEST_ASSERT(paced > 0.2 && paced < 1.0, "30 KB at 100 KB/s held to the configured rate");
+    
+    result = bp_cla_set_rate("paced", 0);
+    TEST_ASSERT(result == BP_SUCCESS && cla.data_rate == 0, "Rate changed without re-registering");
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < 30; i++) bp_cla_send("paced", "127.0.0.1:4556", payload, sizeof(payload));
+    TEST_ASSERT(elapsed_since(&start) < 0.1, "Rate of 0 leaves the CLA unpaced");
+    
+    result = bp_cla_set_burst("paced", (bp_priority_t)7, 1000);
+    TEST_ASSERT(result == BP_ERROR_INVALID_ARGS, "Unknown priority rejected");
+    result = bp_cla_set_burst("paced", BP_PRIORITY_EXPEDITED, 4000);
+    TEST_ASSERT(result == BP_SUCCESS, "Per-priority burst configured");
+    
+    // A sender waiting on the pacer holds no RCU read section, so registry writers are not held up
+    bp_cla_set_rate("paced", 5000);
+    pthread_t sender;
+    pthread_create(&sender, NULL, send_paced, "paced");
+    usleep(250000);
+    bp_cla_t other;
+    memset(&other, 0, sizeof(other));
+    other.protocol_name = "other";
+    other.send_callback = counting_send;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    result = bp_cla_register(&other);
+    TEST_ASSERT(result == BP_SUCCESS && elapsed_since(&start) < 0.1, "Registration not held up by a paced send");
+    bp_cla_unregister("other");
+    pthread_join(sender, NULL);
+    
+    bp_cla_t selfish;
+    memset(&selfish, 0, sizeof(selfish));
+    selfish.protocol_name = "selfish";
+    selfish.send_callback = unregistering_send;
+    bp_cla_register(&selfish);
+    bp_cla_send("selfish", "127.0.0.1:4556", "x", 1);
+    TEST_ASSERT(unregister_from_send == BP_ERROR_PROTOCOL, "Unregistering from inside a send callback refused");
+    TEST_ASSERT(bp_cla_unregister("selfish") == BP_SUCCESS, "Unregistered once the send returned");
+    
+    bp_cla_unregister("paced");
+    bp_shutdown();
+    return 1;
+}
+
+static char fragments[64][100];
+static size_t fragment_lens[64];
+static int fragment_count = 0;
+static char reassembled[4000];
+static size_t reassembled_len = 0;
+
+static int capture_fragment(const void *data, size_t len, const char *dest, void *context) {
+    (void)dest; (void)context;
+    if (fragment_count >= 64 || len > sizeof(fragments[0])) return -1;
+    memcpy(fragments[fragment_count], data, len);
+    fragment_lens[fragment_count++] = len;
+    return 0;
+}
+
+static int capture_bundle(void *data, size_t len, char *source, void *context) {
+    (void)source; (void)context;
+    if (len > sizeof(reassembled)) return -1;
+    memcpy(reassembled, data, len);
+    reassembled_len = len;
+    return 0;
+}
+
+int test_cla_fragmentation() {
+    printf("\n=== Testing CLA Fragmentation ===\n");
+    
+    int result = bp_init("ipn:1.1", NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "BP-SDK initialization for fragmentation test");
+    
+    bp_cla_t cla;
+    memset(&cla, 0, sizeof(cla));
+    cla.protocol_name = "small";
+    cla.send_callback = capture_fragment;
+    cla.receive_callback = capture_bundle;
+    cla.max_payload_size = 100;
+    cla.flags = BP_CLA_FRAGMENT;
+    result = bp_cla_register(&cla);
+    TEST_ASSERT(result == BP_SUCCESS, "Small-MTU CLA registration");
+    
+    char bundle[3000];
+    for (size_t i = 0; i < sizeof(bundle); i++) bundle[i] = (char)(i * 31);
+    result = bp_cla_send("small", "127.0.0.1:4556", bundle, sizeof(bundle));
+    TEST_ASSERT(result == BP_SUCCESS, "Oversized bundle sent as fragments");
+    TEST_ASSERT(fragment_count > 1, "Bundle split to fit max_payload_size");
+    
+    // Fed back last to first, with one fragment duplicated
+    for (int i = fragment_count - 1; i >= 0; i--) {
+        bp_cla_handle_bundle_receive(&cla, fragments[i], fragment_lens[i], "127.0.0.1:4557");
+        if (i == fragment_count / 2) bp_cla_handle_bundle_receive(&cla, fragments[i], fragment_lens[i], "127.0.0.1:4557");
+    }
+    TEST_ASSERT(reassembled_len == sizeof(bundle) && memcmp(reassembled, bundle, sizeof(bundle)) == 0,
+                "Out-of-order fragments reassembled");
+    
+    bp_cla_reassembly_stats_t stats;
+    result = bp_cla_reassembly_stats(&stats);
+    TEST_ASSERT(result == BP_SUCCESS && stats.pending == 0 && stats.completed >= 1, "Reassembly table drained");
+    
+    // Without the flags, payloads that happen to start like a fragment or a probe are delivered as they are
+    bp_cla_t plain = cla;
+    plain.protocol_name = "plain";
+    plain.flags = 0;
+    const uint8_t magics[2][4] = { { 0xBF, 'F', 'R', 'G' }, { 0xBF, 'P', 'R', 'B' } };
+    for (int m = 0; m < 2; m++) {
+        char lookalike[64];
+        memset(lookalike, 'Q', sizeof(lookalike));
+        memcpy(lookalike, magics[m], 4);
+        reassembled_len = 0;
+        result = bp_cla_handle_bundle_receive(&plain, lookalike, sizeof(lookalike), "127.0.0.1:4557");
+        TEST_ASSERT(result == BP_SUCCESS && reassembled_len == sizeof(lookalike) &&
+                    memcmp(reassembled, lookalike, sizeof(lookalike)) == 0,
+                    m == 0 ? "Fragment-like payload reaches receive_callback" : "Probe-like payload reaches receive_callback");
+    }
+    
+    bp_cla_unregister("small");
+    bp_shutdown();
+    return 1;
+}
+
+#define TCP_LARGE_BUNDLE (5 * 1024 * 1024)
+
+static int tcp_received = 0;
+static int tcp_large_received = 0;
+
+static int count_tcp_receive(void *data, size_t len, char *source, void *context) {
+    (void)source;
+    if (context != &tcp_received) return 0;
+    if (len == 4 && memcmp(data, "tcp!", 4) == 0) __atomic_fetch_add(&tcp_received, 1, __ATOMIC_RELAXED);
+    if (len == TCP_LARGE_BUNDLE && ((char*)data)[0] == 'L' && ((char*)data)[len - 1] == 'L') 
+        __atomic_fetch_add(&tcp_large_received, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+int test_tcp_cla() {
+    printf("\n=== Testing TCP CLA ===\n");
+    
+    int result = bp_init("ipn:1.1", NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "BP-SDK initialization for TCP CLA test");
+    
+    bp_cla_tcp_config_t config = { .loop_threads = 2, .connections_per_peer = 2, .nodelay = 1, .cork = 0 };
+    bp_cla_t *sender, *receiver;
+    result = bp_cla_create_tcp_ex("127.0.0.1", 4556, &config, &sender);
+    TEST_ASSERT(result == BP_SUCCESS, "TCP sender creation");
+    result = bp_cla_create_tcp("127.0.0.1", 4557, &receiver);
+    TEST_ASSERT(result == BP_SUCCESS, "TCP receiver creation");
+    
+    // The receiver is never registered, so it is started once its callback and context are in place
+    receiver->receive_callback = count_tcp_receive;
+    receiver->context = &tcp_received;
+    result = bp_cla_start(receiver);
+    TEST_ASSERT(result == BP_SUCCESS, "TCP receiver started");
+    
+    result = bp_cla_register(sender);
+    TEST_ASSERT(result == BP_SUCCESS, "TCP CLA registration");
+    
+    for (int i = 0; i < 100; i++) {
+        result = bp_cla_send("tcp", "127.0.0.1:4557", "tcp!", 4);
+        if (result != BP_SUCCESS) break;
+    }
+    TEST_ASSERT(result == BP_SUCCESS, "TCP sends queued");
+    
+    // A bundle larger than the old pending limit, with small ones queued right behind it
+    char *large = malloc(TCP_LARGE_BUNDLE);
+    memset(large, 'L', TCP_LARGE_BUNDLE);
+    result = bp_cla_send("tcp", "127.0.0.1:4557", large, TCP_LARGE_BUNDLE);
+    for (int i = 0; i < 10 && result == BP_SUCCESS; i++) {
+        result = bp_cla_send("tcp", "127.0.0.1:4557", "tcp!", 4);
+    }
+    free(large);
+    TEST_ASSERT(result == BP_SUCCESS, "Large TCP bundle queued ahead of small ones");
+    
+    bp_cla_unregister("tcp");
+    for (int i = 0; i < 200 && __atomic_load_n(&tcp_received, __ATOMIC_RELAXED) < 110; i++) usleep(10000);
+    TEST_ASSERT(tcp_received == 110, "Every framed bundle received with the caller's context");
+    TEST_ASSERT(tcp_large_received == 1, "Large bundle received whole");
+    
+    bp_cla_destroy(sender);
+    bp_cla_destroy(receiver);
+    bp_shutdown();
+    return 1;
+}
+
+static int shm_received = 0;
+
+static int count_shm_receive(void *data, size_t len, char *source, void *context) {
+    if (len == 4 && memcmp(data, "shm!", 4) == 0 && strcmp(source, "test-sender") == 0 && context == &shm_received) 
+        __atomic_fetch_add(&shm_received, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+// The ring header as bp_sdk_cla_shm.c lays it out, so a test can play a misbehaving sender
+typedef struct {
+    uint64_t head __attribute__((aligned(64)));
+    uint32_t producer_waiting;
+    uint64_t tail __attribute__((aligned(64)));
+    uint32_t consumer_waiting;
+    uint32_t size __attribute__((aligned(64)));
+} forged_ring_t;
+
+#define FORGED_DATA_OFFSET 192
+#define FORGED_RING_SIZE 4096
+
+typedef struct {
+    int conn_fd;
+    int data_fd;
+    forged_ring_t *ring;
+} forged_peer_t;
+
+// Connects to the receiver's rendezvous as "test-sender" and hands over a ring holding one bundle
+static int forge_peer(const char *dest, int sealed, forged_peer_t *peer) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    int path_len = snprintf(addr.sun_path + 1, sizeof(addr.sun_path) - 1, "bp-shm-%s", dest);
+    socklen_t addr_len = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + 1 + path_len);
+
+    size_t map_len = FORGED_DATA_OFFSET + FORGED_RING_SIZE;
+    int memfd = memfd_create("forged", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memfd < 0 || ftruncate(memfd, map_len) != 0) return -1;
+    if (sealed && fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) != 0) return -1;
+    peer->ring = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (peer->ring == MAP_FAILED) return -1;
+
+    char *data = (char*)peer->ring + FORGED_DATA_OFFSET;
+    *(uint32_t*)data = 4;
+    memcpy(data + 8, "shm!", 4);
+    peer->ring->size = FORGED_RING_SIZE;
+    peer->ring->head = 16;
+
+    int fds[3] = { memfd, eventfd(0, EFD_CLOEXEC), eventfd(0, EFD_CLOEXEC) };
+    peer->data_fd = fds[1];
+    peer->conn_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (connect(peer->conn_fd, (struct sockaddr*)&addr, addr_len) != 0) return -1;
+
+    char control[CMSG_SPACE(sizeof(fds))];
+    memset(control, 0, sizeof(control));
+    struct iovec iov = { .iov_base = "test-sender", .iov_len = 11 };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+    int sent = sendmsg(peer->conn_fd, &msg, 0) > 0;
+    close(memfd);
+    close(fds[2]);
+
+    uint64_t one = 1;
+    if (write(peer->data_fd, &one, sizeof(one)) < 0) {}
+    return sent ? 0 : -1;
+}
+
+static void forged_peer_close(forged_peer_t *peer) {
+    munmap(peer->ring, FORGED_DATA_OFFSET + FORGED_RING_SIZE);
+    close(peer->conn_fd);
+    close(peer->data_fd);
+}
+
+static int hung_up(int fd) {
+    struct pollfd hup = { .fd = fd, .events = POLLRDHUP };
+    return poll(&hup, 1, 1000) > 0 && (hup.revents & (POLLRDHUP | POLLHUP));
+}
+
+int test_shm_cla() {
+    printf("\n=== Testing Shared-Memory CLA ===\n");
+    
+    int result = bp_init("ipn:1.1", NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "BP-SDK initialization for shared-memory CLA test");
+    
+    bp_cla_t *sender, *receiver;
+    result = bp_cla_create_shm("test-sender", &sender);
+    TEST_ASSERT(result == BP_SUCCESS, "Shared-memory sender creation");
+    result = bp_cla_create_shm("test-receiver", &receiver);
+    TEST_ASSERT(result == BP_SUCCESS, "Shared-memory receiver creation");
+    receiver->receive_callback = count_shm_receive;
+    receiver->context = &shm_received;
+    result = bp_cla_start(receiver);
+    TEST_ASSERT(result == BP_SUCCESS, "Shared-memory receiver started");
+    
+    bp_cla_t *duplicate;
+    result = bp_cla_create_shm("test-receiver", &duplicate);
+    TEST_ASSERT(result != BP_SUCCESS, "Duplicate shared-memory name rejected");
+    
+    result = bp_cla_register(sender);
+    TEST_ASSERT(result == BP_SUCCESS, "Shared-memory CLA registration");
+    
+    for (int i = 0; i < 1000; i++) {
+        result = bp_cla_send("shm", "test-receiver", "shm!", 4);
+        if (result != BP_SUCCESS) break;
+    }
+    TEST_ASSERT(result == BP_SUCCESS, "Shared-memory sends queued");
+    
+    bp_cla_unregister("shm");
+    for (int i = 0; i < 100 && __atomic_load_n(&shm_received, __ATOMIC_RELAXED) < 1000; i++) usleep(10000);
+    TEST_ASSERT(shm_received == 1000, "Every bundle received through the ring");
+    
+    forged_peer_t forged;
+    TEST_ASSERT(forge_peer("test-receiver", 0, &forged) == 0, "Unsealed ring handed over");
+    TEST_ASSERT(hung_up(forged.conn_fd), "Unsealed ring refused");
+    forged_peer_close(&forged);
+    
+    TEST_ASSERT(forge_peer("test-receiver", 1, &forged) == 0, "Sealed ring handed over");
+    for (int i = 0; i < 100 && __atomic_load_n(&shm_received, __ATOMIC_RELAXED) < 1001; i++) usleep(10000);
+    TEST_ASSERT(shm_received == 1001, "Bundle received from a sealed ring");
+    
+    // Growing size would send the receiver past its mapping; a head too far ahead of the tail is corrupt
+    __atomic_store_n(&forged.ring->size, 1u << 30, __ATOMIC_RELAXED);
+    __atomic_store_n(&forged.ring->tail, (uint64_t)1 << 29, __ATOMIC_RELAXED);
+    __atomic_store_n(&forged.ring->head, (uint64_t)1 << 30, __ATOMIC_RELEASE);
+    uint64_t one = 1;
+    if (write(forged.data_fd, &one, sizeof(one)) < 0) {}
+    TEST_ASSERT(hung_up(forged.conn_fd), "Corrupted ring dropped");
+    TEST_ASSERT(shm_received == 1001, "Nothing delivered from the corrupted ring");
+    forged_peer_close(&forged);
+    
+    bp_cla_destroy(sender);
+    bp_cla_destroy(receiver);
+    bp_shutdown();
+    return 1;
+}
+
+static int bond_sends[2];
+
+static int bond_member_send(const void *data, size_t len, const char *dest, void *context) {
+    (void)data; (void)len; (void)dest;
+    __atomic_fetch_add(&bond_sends[(intptr_t)context], 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+// The sender threads hold paced bundles after dequeuing them, so wait on what was actually sent
+static void wait_for_bond_sends(int expected) {
+    for (int i = 0; i < 2000; i++) {
+        if (__atomic_load_n(&bond_sends[0], __ATOMIC_RELAXED) + __atomic_load_n(&bond_sends[1], __ATOMIC_RELAXED) >= expected) return;
+        usleep(1000);
+    }
+}
+
+int test_cla_bonding() {
+    printf("\n=== Testing CLA Bonding ===\n");
+    
+    int result = bp_init("ipn:1.1", NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "BP-SDK initialization for bonding test");
+    
+    bp_cla_t slow, fast;
+    memset(&slow, 0, sizeof(slow));
+    slow.protocol_name = "slow";
+    slow.send_callback = bond_member_send;
+    slow.context = (void*)(intptr_t)0;
+    slow.max_payload_size = 1000;
+    slow.data_rate = 100000;
+    slow.queue_depth = 100;
+    slow.queue_policy = BP_CLA_QUEUE_BLOCK;
+    fast = slow;
+    fast.protocol_name = "fast";
+    fast.context = (void*)(intptr_t)1;
+    fast.data_rate = 300000;
+    TEST_ASSERT(bp_cla_register(&slow) == BP_SUCCESS && bp_cla_register(&fast) == BP_SUCCESS,
+                "Bond member CLA registration");
+    
+    result = bp_cla_bond_send("ipn:2.0", "x", 1);
+    TEST_ASSERT(result == BP_ERROR_NOT_FOUND, "Send to unknown bond rejected");
+    result = bp_cla_bond_add("ipn:2.0", "slow", "127.0.0.1:4556");
+    TEST_ASSERT(result == BP_SUCCESS, "First bond member added");
+    result = bp_cla_bond_add("ipn:2.0", "fast", "127.0.0.1:4557");
+    TEST_ASSERT(result == BP_SUCCESS, "Second bond member added");
+    
+    char payload[1000];
+    memset(payload, 'b', sizeof(payload));
+    for (int i = 0; i < 80; i++) bp_cla_bond_send("ipn:2.0", payload, sizeof(payload));
+    wait_for_bond_sends(80);
+    TEST_ASSERT(bond_sends[0] + bond_sends[1] == 80, "Every bonded bundle sent");
+    TEST_ASSERT(bond_sends[1] >= 2 * bond_sends[0] && bond_sends[1] <= 4 * bond_sends[0],
+                "Bundles split in proportion to data_rate");
+    
+    bp_cla_unregister("fast");
+    memset(bond_sends, 0, sizeof(bond_sends));
+    for (int i = 0; i < 10; i++) bp_cla_bond_send("ipn:2.0", payload, sizeof(payload));
+    wait_for_bond_sends(10);
+    TEST_ASSERT(bond_sends[0] == 10, "Unregistered member skipped in favor of the other link");
+    
+    result = bp_cla_bond_remove("ipn:2.0", "slow");
+    TEST_ASSERT(result == BP_SUCCESS, "Bond member removed");
+    result = bp_cla_bond_send("ipn:2.0", payload, sizeof(payload));
+    TEST_ASSERT(result == BP_ERROR_NOT_FOUND, "Send fails once no registered member is left");
+    result = bp_cla_bond_remove("ipn:2.0", "fast");
+    TEST_ASSERT(result == BP_SUCCESS && bp_cla_bond_send("ipn:2.0", "x", 1) == BP_ERROR_NOT_FOUND,
+                "Removing the last member removes the bond");
+    
+    bp_cla_unregister("slow");
+    bp_shutdown();
+    return 1;
+}
+
 int test_routing_management() {
     printf("\n=== Testing Routing Management ===\n");
     
@@ -141,6 +903,348 @@ int test_routing_management() {
     return 1;
 }
 
+static int route_computations = 0;
+
+// One route per destination, through ipn:3 except for destinations on node 4
+static int counting_compute(const char *dest_eid, bp_route_t **routes, int *route_count, void *context) {
+    (void)context;
+    route_computations++;
+    bp_route_t *route;
+    const char *next_hop = strncmp(dest_eid, "ipn:4.", 6) == 0 ? "ipn:4.0" : "ipn:3.0";
+    if (bp_route_create(dest_eid, next_hop, 10, 1.0f, time(NULL) + 3600, &route) != BP_SUCCESS) return -1;
+    *routes = route;
+    *route_count = 1;
+    return 0;
+}
+
+static int compute_and_free(const char *dest_eid) {
+    bp_route_t *routes = NULL;
+    int count = 0;
+    int result = bp_routing_compute(dest_eid, &routes, &count);
+    int ok = result == BP_SUCCESS && count == 1 && strcmp(routes[0].dest_eid, dest_eid) == 0;
+    if (count > 0) bp_route_list_destroy(routes, count);
+    return ok;
+}
+
+static int unregister_in_callback = -100;
+static int lookups_running = 0;
+
+static int unregistering_compute(const char *dest_eid, bp_route_t **routes, int *route_count, void *context) {
+    (void)dest_eid;
+    (void)routes;
+    (void)route_count;
+    (void)context;
+    unregister_in_callback = bp_routing_unregister("unregistering");
+    return -1;
+}
+
+static void *lookup_loop(void *arg) {
+    (void)arg;
+    bp_routing_handle_t handle;
+    while (__atomic_load_n(&lookups_running, __ATOMIC_RELAXED)) bp_routing_lookup("churn", &handle);
+    return NULL;
+}
+
+int test_registry_updates() {
+    printf("\n=== Testing Registry Updates ===\n");
+    
+    int result = bp_init("ipn:1.1", NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "BP-SDK initialization for registry test");
+    
+    bp_routing_t unregistering = { .algorithm_name = (char*)"unregistering", .compute_route = unregistering_compute };
+    result = bp_routing_register(&unregistering);
+    TEST_ASSERT(result == BP_SUCCESS, "Self-unregistering algorithm registration");
+    
+    bp_route_t *routes = NULL;
+    int count = 0;
+    bp_routing_compute("ipn:9.1", &routes, &count);
+    TEST_ASSERT(unregister_in_callback == BP_ERROR_PROTOCOL, "Unregistering from a routing callback refused");
+    
+    result = bp_routing_unregister("unregistering");
+    TEST_ASSERT(result == BP_SUCCESS, "Unregistering outside the callback");
+    
+    // Every registration waits out the readers on the other threads
+    pthread_t readers[4];
+    __atomic_store_n(&lookups_running, 1, __ATOMIC_RELAXED);
+    for (int i = 0; i < 4; i++) pthread_create(&readers[i], NULL, lookup_loop, NULL);
+    
+    bp_routing_t churn = { .algorithm_name = (char*)"churn", .compute_route = counting_compute };
+    int churned = 0;
+    for (; churned < 200; churned++) {
+        if (bp_routing_register(&churn) != BP_SUCCESS || bp_routing_unregister("churn") != BP_SUCCESS) break;
+    }
+    
+    __atomic_store_n(&lookups_running, 0, __ATOMIC_RELAXED);
+    for (int i = 0; i < 4; i++) pthread_join(readers[i], NULL);
+    TEST_ASSERT(churned == 200, "Registrations while readers run");
+    
+    bp_shutdown();
+    return 1;
+}
+
+int test_route_cache() {
+    printf("\n=== Testing Route Cache ===\n");
+    
+    int result = bp_init("ipn:1.1", NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "BP-SDK initialization for route cache test");
+    
+    bp_routing_t routing;
+    memset(&routing, 0, sizeof(routing));
+    routing.algorithm_name = "counting";
+    routing.compute_route = counting_compute;
+    result = bp_routing_register(&routing);
+    TEST_ASSERT(result == BP_SUCCESS, "Counting algorithm registration");
+    
+    route_computations = 0;
+    int ok = 1;
+    for (int i = 0; i < 100; i++) ok &= compute_and_free("ipn:5.1");
+    ok &= compute_and_free("ipn:4.1");
+    TEST_ASSERT(ok, "Routes returned from cache match computed routes");
+    TEST_ASSERT(route_computations == 2, "Algorithm asked once per destination");
+    
+    bp_routing_cache_stats_t stats;
+    bp_routing_cache_stats(&stats);
+    TEST_ASSERT(stats.hits == 99 && stats.misses == 2 && stats.entries == 2, "Hits and misses counted");
+    
+    bp_routing_update_contact("ipn:4.0", time(NULL), time(NULL) + 60, 1000);
+    compute_and_free("ipn:5.1");
+    compute_and_free("ipn:4.1");
+    TEST_ASSERT(route_computations == 3, "Only routes through the updated neighbor recomputed");
+    
+    bp_routing_update_range("ipn:3.0", time(NULL), time(NULL) + 60, 1);
+    compute_and_free("ipn:5.1");
+    TEST_ASSERT(route_computations == 4, "Range update invalidates its neighbor's routes");
+    
+    bp_routing_cache_stats(&stats);
+    TEST_ASSERT(stats.invalidations == 2, "Invalidations counted");
+    
+    bp_routing_unregister("counting");
+    bp_routing_cache_stats(&stats);
+    TEST_ASSERT(stats.entries == 0, "Unregistering an algorithm empties the cache");
+    
+    bp_shutdown();
+    return 1;
+}
+
+int test_contact_plan() {
+    printf("\n=== Testing Contact Plan ===\n");
+    
+    int result = bp_init("ipn:1.1", NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "BP-SDK initialization for contact plan test");
+    
+    // A long contact overlapping two short ones, plus a contact to another neighbor
+    time_t now = time(NULL);
+    bp_contact_plan_add_contact(NULL, "ipn:2.0", now, now + 1000, 100);
+    bp_contact_plan_add_contact(NULL, "ipn:2.0", now + 100, now + 200, 200);
+    bp_contact_plan_add_contact(NULL, "ipn:2.0", now + 300, now + 400, 300);
+    bp_contact_plan_add_contact(NULL, "ipn:3.0", now + 150, now + 250, 400);
+    for (int i = 0; i < 1000; i++) {
+        bp_contact_plan_add_contact("ipn:2.0", "ipn:3.0", now + i * 10, now + i * 10 + 5, 1000);
+    }
+    
+    bp_contact_info_t *contacts = NULL;
+    int count = 0;
+    result = bp_contact_plan_query(NULL, "ipn:2.0", now + 250, now + 350, &contacts, &count);
+    TEST_ASSERT(result == BP_SUCCESS && count == 2, "Window query finds overlapping contacts only");
+    TEST_ASSERT(contacts[0].rate == 100 && contacts[1].rate == 300, "Window query ordered by start");
+    free(contacts);
+    
+    result = bp_contact_plan_query("ipn:2.0", "ipn:3.0", now + 2000, now + 2100, &contacts, &count);
+    TEST_ASSERT(result == BP_SUCCESS && count == 10, "Window query on a long contact list");
+    free(contacts);
+    
+    bp_contact_info_t next;
+    result = bp_contact_plan_next(NULL, "ipn:3.0", now, &next);
+    TEST_ASSERT(result == BP_SUCCESS && next.start == now + 150, "Next contact found");
+    result = bp_contact_plan_next("ipn:2.0", "ipn:3.0", now + 4246, &next);
+    TEST_ASSERT(result == BP_SUCCESS && next.start == now + 4250, "Next contact after a gap");
+    result = bp_contact_plan_next(NULL, "ipn:3.0", now + 250, &next);
+    TEST_ASSERT(result == BP_ERROR_NOT_FOUND, "No contact after the last one ends");
+    
+    result = bp_routing_update_contact("ipn:4.0", now + 10, now + 20, 500);
+    TEST_ASSERT(result == BP_SUCCESS && bp_contact_plan_next(NULL, "ipn:4.0", now, &next) == BP_SUCCESS,
+                "Routing updates recorded in the plan");
+    bp_routing_update_contact("ipn:4.0", now + 10, now + 20, 0);
+    TEST_ASSERT(bp_contact_plan_next(NULL, "ipn:4.0", now, &next) == BP_ERROR_NOT_FOUND,
+                "A rate of 0 removes the contact");
+    
+    bp_shutdown();
+    return 1;
+}
+
+int test_cgr_routing() {
+    printf("\n=== Testing Contact Graph Routing ===\n");
+    
+    int result = bp_init("ipn:1.1", NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "BP-SDK initialization for CGR test");
+    
+    bp_routing_t *routing = NULL;
+    result = bp_routing_create_cgr(&routing);
+    TEST_ASSERT(result == BP_SUCCESS && routing != NULL, "CGR routing creation");
+    result = bp_routing_register(routing);
+    TEST_ASSERT(result == BP_SUCCESS, "CGR routing registration");
+    
+    // 1 -> 2 -> 4 arrives at +15 after the 2-4 light time; 1 -> 3 -> 4 waits until +30
+    time_t now = time(NULL);
+    bp_contact_plan_add_contact("ipn:1.0", "ipn:2.0", now, now + 100, 1000);
+    bp_contact_plan_add_contact("ipn:2.0", "ipn:4.0", now + 10, now + 100, 1000);
+    bp_contact_plan_add_range("ipn:2.0", "ipn:4.0", now, now + 100, 5);
+    bp_contact_plan_add_contact("ipn:1.0", "ipn:3.0", now, now + 200, 1000);
+    bp_contact_plan_add_contact("ipn:3.0", "ipn:4.0", now + 30, now + 200, 1000);
+    
+    bp_route_t *routes = NULL;
+    int route_count = 0;
+    result = bp_routing_compute("ipn:4.1", &routes, &route_count);
+    TEST_ASSERT(result == BP_SUCCESS && route_count == 2, "Route through each neighbor found");
+    TEST_ASSERT(strcmp(routes[0].next_hop, "ipn:2.0") == 0 && routes[0].cost + 1 >= 15 && routes[0].cost <= 15,
+                "Earliest arrival first, including light time");
+    TEST_ASSERT(routes[0].valid_until == now + 100, "Route valid until its first contact ends");
+    TEST_ASSERT(strcmp(routes[1].next_hop, "ipn:3.0") == 0 && routes[1].cost <= 30, "Slower route second");
+    bp_route_list_destroy(routes, route_count);
+    
+    // 2 -> 4 holds 90000 bytes over its 90 seconds, 3 -> 4 holds 170000
+    result = bp_routing_compute_sized("ipn:4.1", 95000, &routes, &route_count);
+    TEST_ASSERT(result == BP_SUCCESS && route_count == 1 && strcmp(routes[0].next_hop, "ipn:3.0") == 0,
+                "Contact too small for the bundle skipped");
+    bp_route_list_destroy(routes, route_count);
+    result = bp_routing_compute_sized("ipn:4.1", 500000, &routes, &route_count);
+    TEST_ASSERT(result == BP_SUCCESS && route_count == 0, "No route for a bundle larger than any contact");
+    
+    result = bp_contact_plan_consume("ipn:2.0", now, 100000);
+    TEST_ASSERT(result == BP_SUCCESS, "Residual volume booked");
+    result = bp_routing_compute("ipn:4.1", &routes, &route_count);
+    TEST_ASSERT(result == BP_SUCCESS && route_count == 1 && strcmp(routes[0].next_hop, "ipn:3.0") == 0,
+                "Exhausted contact no longer routed over");
+    bp_route_list_destroy(routes, route_count);
+    
+    bp_routing_update_contact("ipn:5.0", now, now + 60, 1000);
+    result = bp_routing_compute("ipn:5.1", &routes, &route_count);
+    TEST_ASSERT(result == BP_SUCCESS && route_count == 1 && strcmp(routes[0].next_hop, "ipn:5.0") == 0,
+                "Local contacts taken from bp_routing_update_contact()");
+    bp_route_list_destroy(routes, route_count);
+    
+    result = bp_routing_compute("ipn:9.1", &routes, &route_count);
+    TEST_ASSERT(result == BP_SUCCESS && route_count == 0, "Unreachable destination has no routes");
+    
+    bp_routing_unregister("cgr");
+    bp_routing_destroy(routing);
+    bp_shutdown();
+    return 1;
+}
+
+typedef struct {
+    bp_cla_t cla;
+    int delay_us;
+    int dropping;
+} loopback_link_t;
+
+// Hands every bundle straight back to the same CLA's receive path, as a peer's answer would arrive
+static int loopback_send(const void *data, size_t len, const char *dest, void *context) {
+    (void)dest;
+    loopback_link_t *link = context;
+    if (__atomic_load_n(&link->dropping, __ATOMIC_RELAXED)) return 0;
+    if (link->delay_us > 0) usleep(link->delay_us);
+    bp_cla_handle_bundle_receive(&link->cla, data, len, "peer");
+    return 0;
+}
+
+static int wait_for_selection(const char *expected) {
+    for (int i = 0; i < 100; i++) {
+        char *protocol_name = NULL, *dest_addr = NULL;
+        int match = bp_cla_select("ipn:3.0", &protocol_name, &dest_addr) == BP_SUCCESS &&
+                    strcmp(protocol_name, expected) == 0;
+        free(protocol_name);
+        free(dest_addr);
+        if (match) return 1;
+        usleep(10000);
+    }
+    return 0;
+}
+
+static char answered_to[64];
+
+static int capture_answer(const void *data, size_t len, const char *dest, void *context) {
+    (void)data; (void)len; (void)context;
+    snprintf(answered_to, sizeof(answered_to), "%s", dest);
+    return 0;
+}
+
+// A lead probe as a peer's prober would send it, asking for the answer at reply_to
+static size_t build_probe(uint8_t *packet, const char *reply_to) {
+    size_t reply_len = strlen(reply_to);
+    memset(packet, 0, 20);
+    memcpy(packet, "\xBFPRBQ", 5);
+    packet[7] = (uint8_t)reply_len;
+    packet[11] = 1;
+    memcpy(packet + 20, reply_to, reply_len);
+    return 20 + reply_len;
+}
+
+int test_cla_probing() {
+    printf("\n=== Testing CLA Path Probing ===\n");
+    
+    int result = bp_init("ipn:1.1", NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "BP-SDK initialization for probing test");
+    
+    loopback_link_t quick, laggy;
+    memset(&quick, 0, sizeof(quick));
+    memset(&laggy, 0, sizeof(laggy));
+    quick.cla.protocol_name = "quick";
+    quick.cla.send_callback = loopback_send;
+    quick.cla.context = &quick;
+    quick.cla.flags = BP_CLA_PROBE;
+    laggy.cla = quick.cla;
+    laggy.cla.protocol_name = "laggy";
+    laggy.cla.context = &laggy;
+    laggy.delay_us = 5000;
+    TEST_ASSERT(bp_cla_register(&quick.cla) == BP_SUCCESS && bp_cla_register(&laggy.cla) == BP_SUCCESS,
+                "Loopback CLA registration");
+    TEST_ASSERT(bp_cla_bond_add("ipn:3.0", "quick", "peer") == BP_SUCCESS &&
+                bp_cla_bond_add("ipn:3.0", "laggy", "peer") == BP_SUCCESS, "Paths added to neighbor");
+    
+    char *protocol_name = NULL, *dest_addr = NULL;
+    result = bp_cla_select("ipn:3.0", &protocol_name, &dest_addr);
+    TEST_ASSERT(result == BP_ERROR_NOT_FOUND, "No live path before probing");
+    
+    result = bp_cla_probe_start(20);
+    TEST_ASSERT(result == BP_SUCCESS, "Prober started");
+    TEST_ASSERT(bp_cla_probe_start(20) == BP_ERROR_DUPLICATE, "Second prober rejected");
+    TEST_ASSERT(wait_for_selection("quick"), "Lower-RTT path selected");
+    
+    bp_cla_path_stats_t stats;
+    result = bp_cla_path_stats("ipn:3.0", "laggy", &stats);
+    TEST_ASSERT(result == BP_SUCCESS && stats.live && stats.rtt_us >= 5000, "Delayed path's RTT measured");
+    
+    __atomic_store_n(&quick.dropping, 1, __ATOMIC_RELAXED);
+    TEST_ASSERT(wait_for_selection("laggy"), "Selection moves off a path that stops answering");
+    result = bp_cla_path_stats("ipn:3.0", "quick", &stats);
+    TEST_ASSERT(result == BP_SUCCESS && !stats.live && stats.loss > 0.3 && stats.probes_lost >= 3,
+                "Silent path marked dead with its loss");
+    
+    TEST_ASSERT(bp_cla_probe_stop() == BP_SUCCESS, "Prober stopped");
+    
+    bp_cla_t answering;
+    memset(&answering, 0, sizeof(answering));
+    answering.protocol_name = "answering";
+    answering.send_callback = capture_answer;
+    answering.flags = BP_CLA_PROBE;
+    uint8_t probe[64];
+    size_t probe_len = build_probe(probe, "192.0.2.1:9");
+    bp_cla_handle_bundle_receive(&answering, probe, probe_len, "10.0.0.2:4556");
+    TEST_ASSERT(strcmp(answered_to, "10.0.0.2:4556") == 0, "Probe from a stranger answered to its source");
+    
+    bp_cla_bond_add("ipn:4.0", "answering", "10.0.0.3:4556");
+    probe_len = build_probe(probe, "10.0.0.3:4556");
+    bp_cla_handle_bundle_receive(&answering, probe, probe_len, "10.0.0.3:40000");
+    TEST_ASSERT(strcmp(answered_to, "10.0.0.3:4556") == 0, "Probe answered to the bonded peer it names");
+    bp_cla_bond_remove("ipn:4.0", "answering");
+    
+    bp_cla_unregister("quick");
+    bp_cla_unregister("laggy");
+    bp_shutdown();
+    return 1;
+}
+
 int test_route_creation() {
     printf("\n=== Testing Route Creation ===\n");
     
@@ -162,6 +1266,180 @@ int test_route_creation() {
     return 1;
 }
 
+int test_statistics() {
+    printf("\n=== Testing Statistics ===\n");
+    
+    int result = bp_init("ipn:1.1", NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "BP-SDK initialization for statistics test");
+    
+    result = bp_stats_reset();
+    TEST_ASSERT(result == BP_SUCCESS, "Statistics reset");
+    
+    uint64_t count = 1;
+    result = bp_stats_get_bundles_sent(&count);
+    TEST_ASSERT(result == BP_SUCCESS && count == 0, "Sent counter is zero after reset");
+    
+    uint64_t buckets[BP_HISTOGRAM_BUCKETS];
+    result = bp_stats_get_histogram(BP_HISTOGRAM_SEND_LATENCY, buckets);
+    TEST_ASSERT(result == BP_SUCCESS, "Send latency histogram retrieval");
+    
+    result = bp_stats_get_histogram(BP_HISTOGRAM_COUNT, buckets);
+    TEST_ASSERT(result == BP_ERROR_INVALID_ARGS, "Unknown histogram rejected");
+    
+    bp_shutdown();
+    return 1;
+}
+
+static bp_bundle_t *received_elsewhere = NULL;
+
+static void *free_and_receive(void *arg) {
+    bp_endpoint_t *endpoint = arg;
+    bp_bundle_free(received_elsewhere);
+    bp_receive(endpoint, &received_elsewhere, 1000);
+    return NULL;
+}
+
+static int send_to_pool_test(size_t len) {
+    static char payload[4096];
+    memset(payload, 'p', sizeof(payload));
+    return bp_send("ipn:1.1", "ipn:1.4", payload, len, BP_PRIORITY_STANDARD, BP_CUSTODY_NONE, 60, NULL);
+}
+
+int test_bundle_pool() {
+    printf("\n=== Testing Bundle Pool ===\n");
+    
+    int result = bp_init("ipn:1.1", NULL);
+    TEST_ASSERT(result == BP_SUCCESS, "BP-SDK initialization for bundle pool test");
+    
+    bp_endpoint_t *endpoint;
+    bp_endpoint_create("ipn:1.4", &endpoint);
+    bp_endpoint_register(endpoint);
+    
+    uint64_t hits, misses, oversize, hits_before, misses_before, oversize_before;
+    bp_bundle_pool_stats(&hits_before, &misses_before, &oversize_before);
+    
+    // Holding more bundles than the thread cache keeps forces fresh blocks
+    bp_bundle_t *held[200];
+    int count = 0;
+    for (; count < 200; count++) {
+        if (send_to_pool_test(100) != BP_SUCCESS || bp_receive(endpoint, &held[count], 1000) != BP_SUCCESS) break;
+    }
+    TEST_ASSERT(count == 200, "Small bundles received");
+    TEST_ASSERT(((uintptr_t)held[0]->payload & 15) == 0, "Payload aligned after the source EID");
+    TEST_ASSERT(held[0]->payload_len == 100 && ((char*)held[0]->payload)[99] == 'p', "Payload intact");
+    bp_bundle_pool_stats(&hits, &misses, &oversize);
+    TEST_ASSERT(misses > misses_before, "Pool misses counted");
+    TEST_ASSERT(hits + misses == hits_before + misses_before + 200, "Every small bundle came from the pool");
+    
+    void *recycled = held[count - 1];
+    for (int i = 0; i < count; i++) bp_bundle_free(held[i]);
+    bp_bundle_t *bundle;
+    send_to_pool_test(100);
+    bp_receive(endpoint, &bundle, 1000);
+    bp_bundle_pool_stats(&hits_before, &misses_before, NULL);
+    TEST_ASSERT(hits_before == hits + 1 && (void*)bundle == recycled, "Freed block reused");
+    
+    send_to_pool_test(4096);
+    bp_bundle_t *large;
+    result = bp_receive(endpoint, &large, 1000);
+    bp_bundle_pool_stats(&hits, &misses, &oversize);
+    TEST_ASSERT(result == BP_SUCCESS && oversize == oversize_before + 1, "Oversize payload counted");
+    TEST_ASSERT(large->payload_len == 4096 && ((char*)large->payload)[4095] == 'p', "Oversize payload intact");
+    bp_bundle_free(large);
+    
+    // A block freed on another thread lands in that thread's cache and is reused there
+    received_elsewhere = bundle;
+    send_to_pool_test(100);
+    pthread_t thread;
+    pthread_create(&thread, NULL, free_and_receive, endpoint);
+    pthread_join(thread, NULL);
+    TEST_ASSERT((void*)received_elsewhere == (void*)bundle, "Block freed on another thread reused there");
+    bp_bundle_free(received_elsewhere);
+    
+    // Bundles built by the caller, without zeroing, are still freed field by field
+    bundle = malloc(sizeof(bp_bundle_t));
+    memset(bundle, 0xa5, sizeof(bp_bundle_t));
+    bundle->eid = NULL;
+    bundle->source_eid = strdup("ipn:2.1");
+    bundle->dest_eid = strdup("ipn:3.1");
+    bundle->report_to_eid = NULL;
+    bundle->payload = malloc(100);
+    result = bp_bundle_free(bundle);
+    TEST_ASSERT(result == BP_SUCCESS, "Caller-built bundle freed");
+    
+    bp_endpoint_unregister(endpoint);
+    bp_endpoint_destroy(endpoint);
+    bp_shutdown();
+    return 1;
+}
+
+int test_stats_serialization() {
+    printf("\n=== Testing Statistics Serialization ===\n");
+    
+    bp_stats_entry_t endpoints[2] = {
+        { .id = "ipn:1.1", .bundles_sent = 7, .bytes_sent = 700 },
+        { .id = "ipn:1.2", .bundles_received = 300, .bytes_received = 1ULL << 40, .errors = 2 }
+    };
+    bp_stats_entry_t clas[1] = { { .id = "udp", .bundles_sent = 5 } };
+    bp_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.timestamp_ms = 1700000000000ULL;
+    stats.bundles_sent = 12;
+    stats.bytes_received = UINT64_MAX;
+    stats.histograms[BP_HISTOGRAM_PAYLOAD_SIZE][10] = 3;
+    stats.histograms[BP_HISTOGRAM_SEND_LATENCY][63] = 1;
+    stats.endpoints = endpoints;
+    stats.endpoint_count = 2;
+    stats.clas = clas;
+    stats.cla_count = 1;
+    
+    size_t size = 0;
+    int result = bp_stats_serialize(&stats, NULL, 0, &size);
+    TEST_ASSERT(result == BP_SUCCESS && size > 0, "Serialized size computed");
+    
+    unsigned char buffer[512];
+    size_t written = 0;
+    result = bp_stats_serialize(&stats, buffer, sizeof(buffer), &written);
+    TEST_ASSERT(result == BP_SUCCESS && written == size, "Statistics serialized");
+    
+    bp_stats_t decoded;
+    result = bp_stats_deserialize(buffer, written, &decoded);
+    TEST_ASSERT(result == BP_SUCCESS, "Statistics deserialized");
+    TEST_ASSERT(decoded.timestamp_ms == stats.timestamp_ms && decoded.bundles_sent == 12 && 
+                decoded.bytes_received == UINT64_MAX, "Counters survive the round trip");
+    TEST_ASSERT(memcmp(decoded.histograms, stats.histograms, sizeof(stats.histograms)) == 0, 
+                "Histograms survive the round trip");
+    TEST_ASSERT(decoded.endpoint_count == 2 && strcmp(decoded.endpoints[1].id, "ipn:1.2") == 0 && 
+                decoded.endpoints[1].bytes_received == 1ULL << 40 && decoded.endpoints[1].errors == 2, 
+                "Endpoint entries survive the round trip");
+    TEST_ASSERT(decoded.cla_count == 1 && strcmp(decoded.clas[0].id, "udp") == 0, "CLA entries survive the round trip");
+    bp_stats_snapshot_free(&decoded);
+    
+    int truncated_ok = 1;
+    for (size_t len = 0; len < written; len++) {
+        if (bp_stats_deserialize(buffer, len, &decoded) != BP_ERROR_INVALID_ARGS) truncated_ok = 0;
+    }
+    TEST_ASSERT(truncated_ok, "Every truncation rejected");
+    
+    // Header and counters, then an entry count far beyond what the input could hold
+    unsigned char huge_count[64] = { 'B', 'P', 'S', 'T', 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 
+                                     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f };
+    result = bp_stats_deserialize(huge_count, 25, &decoded);
+    TEST_ASSERT(result == BP_ERROR_INVALID_ARGS, "Oversized entry count rejected");
+    
+    // One entry whose ID length runs past the end of the input
+    unsigned char huge_id[64] = { 'B', 'P', 'S', 'T', 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 
+                                  1, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01, 0, 0, 0, 0, 0 };
+    result = bp_stats_deserialize(huge_id, 32, &decoded);
+    TEST_ASSERT(result == BP_ERROR_INVALID_ARGS, "Oversized ID length rejected");
+    
+    buffer[4] = 99;
+    result = bp_stats_deserialize(buffer, written, &decoded);
+    TEST_ASSERT(result == BP_ERROR_INVALID_ARGS, "Unknown version rejected");
+    
+    return 1;
+}
+
 int test_memory_management() {
     printf("\n=== Testing Memory Management ===\n");
     
@@ -190,9 +1468,27 @@ int run_all_tests() {
     total++; if (test_initialization()) passed++;
     total++; if (test_error_handling()) passed++;
     total++; if (test_endpoint_management()) passed++;
+    total++; if (test_dispatcher()) passed++;
+    total++; if (test_async_send()) passed++;
     total++; if (test_cla_management()) passed++;
+    total++; if (test_cla_handles()) passed++;
+    total++; if (test_cla_queue()) passed++;
+    total++; if (test_cla_sendv()) passed++;
+    total++; if (test_cla_pacing()) passed++;
+    total++; if (test_cla_fragmentation()) passed++;
+    total++; if (test_tcp_cla()) passed++;
+    total++; if (test_shm_cla()) passed++;
+    total++; if (test_cla_bonding()) passed++;
+    total++; if (test_cla_probing()) passed++;
     total++; if (test_routing_management()) passed++;
+    total++; if (test_registry_updates()) passed++;
+    total++; if (test_route_cache()) passed++;
+    total++; if (test_contact_plan()) passed++;
+    total++; if (test_cgr_routing()) passed++;
     total++; if (test_route_creation()) passed++;
+    total++; if (test_statistics()) passed++;
+    total++; if (test_stats_serialization()) passed++;
+    total++; if (test_bundle_pool()) passed++;
     total++; if (test_memory_management()) passed++;
     
     printf("\n=== Test Results ===\n");